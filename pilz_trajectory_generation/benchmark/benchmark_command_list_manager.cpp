@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include <pilz_industrial_motion_testutils/xml_testdata_loader.h>
+#include <pilz_industrial_motion_testutils/sequence.h>
+
+#include "pilz_trajectory_generation/command_list_manager.h"
+
+#include "allocation_counter.h"
+#include "benchmark_utils.h"
+
+// parameters from parameter server
+const std::string PARAM_TEST_DATA_FILE_NAME("testdata_file_name");
+const std::string PARAM_SEQUENCE_NAME("sequence_name");
+const std::string PARAM_REPETITIONS("repetitions");
+const std::string PARAM_SEQUENCE_LENGTHS("sequence_lengths");
+
+using namespace pilz_trajectory_generation;
+using namespace pilz_industrial_motion_testutils;
+using namespace pilz_benchmark;
+
+/**
+ * @brief Measures CommandListManager::solve() over the length of the sequence, with and without blending
+ *
+ * The sequences are created by repeating a sequence of the test data (mixed PTP, LIN and CIRC commands) until the
+ * requested length is reached. Without blending all blend radii are set to zero.
+ */
+class CommandListManagerBenchmark
+{
+public:
+  bool init();
+  std::vector<BenchmarkResult> run();
+  std::map<std::string, std::string> getContext() const;
+
+private:
+  pilz_msgs::MotionSequenceRequest createRequest(std::size_t length, bool blending) const;
+
+  BenchmarkResult measure(std::size_t length, bool blending);
+
+  /**
+   * @brief Solves the request once and returns the peak of the heap memory allocated by the solve in kB
+   *
+   * Counts the blocks which the solving thread allocates and frees, so it includes the transient memory of the
+   * planning and the blending, not only the memory held by the result.
+   */
+  double measureHeapPeakKb(const pilz_msgs::MotionSequenceRequest& req);
+
+private:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_;
+  planning_scene::PlanningSceneConstPtr scene_;
+  std::unique_ptr<CommandListManager> manager_;
+  pilz_msgs::MotionSequenceRequest base_request_;
+
+  std::string test_data_file_name_, sequence_name_ {"ComplexSequence"};
+  int repetitions_ {5};
+  std::vector<int> sequence_lengths_ {1, 10, 50, 100, 250, 500};
+};
+
+bool CommandListManagerBenchmark::init()
+{
+  if(!ph_.getParam(PARAM_TEST_DATA_FILE_NAME, test_data_file_name_))
+  {
+    ROS_ERROR_STREAM("The parameter " << PARAM_TEST_DATA_FILE_NAME << " is required.");
+    return false;
+  }
+  ph_.param(PARAM_SEQUENCE_NAME, sequence_name_, sequence_name_);
+  ph_.param(PARAM_REPETITIONS, repetitions_, repetitions_);
+  ph_.param(PARAM_SEQUENCE_LENGTHS, sequence_lengths_, sequence_lengths_);
+
+  robot_model_ = robot_model_loader::RobotModelLoader("robot_description").getModel();
+  if(!robot_model_)
+  {
+    ROS_ERROR("Failed to load the robot model.");
+    return false;
+  }
+
+  XmlTestdataLoader data_loader(test_data_file_name_, robot_model_);
+  base_request_ = data_loader.getSequence(sequence_name_).toRequest();
+  if(base_request_.items.empty())
+  {
+    ROS_ERROR_STREAM("The sequence " << sequence_name_ << " is empty.");
+    return false;
+  }
+
+  scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+  manager_.reset(new CommandListManager(ph_, robot_model_));
+  return true;
+}
+
+std::map<std::string, std::string> CommandListManagerBenchmark::getContext() const
+{
+  return {{"testdata_file_name", test_data_file_name_},
+          {"sequence_name", sequence_name_},
+          {"repetitions", std::to_string(repetitions_)}};
+}
+
+pilz_msgs::MotionSequenceRequest CommandListManagerBenchmark::createRequest(std::size_t length, bool blending) const
+{
+  pilz_msgs::MotionSequenceRequest req;
+  for(std::size_t i = 0; i < length; ++i)
+  {
+    pilz_msgs::MotionSequenceItem item {base_request_.items.at(i % base_request_.items.size())};
+
+    // only the first command is allowed to have a start state
+    if(i > 0)
+    {
+      item.req.start_state = moveit_msgs::RobotState();
+    }
+    if(!blending)
+    {
+      item.blend_radius = 0.;
+    }
+    req.items.push_back(item);
+  }
+
+  if(!req.items.empty())
+  {
+    req.items.back().blend_radius = 0.;
+  }
+  return req;
+}
+
+double CommandListManagerBenchmark::measureHeapPeakKb(const pilz_msgs::MotionSequenceRequest& req)
+{
+  // separate from the timed repetitions, the counting slows down every allocation
+  planning_interface::MotionPlanResponse res;
+  testutils::AllocationCounter counter;
+  manager_->solve(scene_, req, res);
+  counter.stop();
+  return static_cast<double>(counter.getPeakBytes()) / 1024.;
+}
+
+BenchmarkResult CommandListManagerBenchmark::measure(std::size_t length, bool blending)
+{
+  BenchmarkResult result;
+  std::stringstream name;
+  name << "CommandListManager/" << sequence_name_ << "/length:" << length << "/blending:" << blending;
+  result.name = name.str();
+
+  const pilz_msgs::MotionSequenceRequest req {createRequest(length, blending)};
+
+  pilz::StageTimes stage_times;
+  std::size_t points {0};
+  for(int i = 0; i < repetitions_; ++i)
+  {
+    planning_interface::MotionPlanResponse res;
+    pilz::StageTimes repetition_times;
+    const StopWatch stop_watch;
+    const bool success {manager_->solve(scene_, req, res, &repetition_times)};
+    const double latency_ms {stop_watch.elapsedMs()};
+
+    if(!success)
+    {
+      ROS_WARN_STREAM(result.name << " failed with error code " << res.error_code_.val);
+      ++result.failures;
+      continue;
+    }
+    result.latencies_ms.push_back(latency_ms);
+    points = res.trajectory_->getWayPointCount();
+    for(std::size_t stage = 0; stage < repetition_times.getStages().size(); ++stage)
+    {
+      stage_times.add(repetition_times.getStages().at(stage), repetition_times.getDurations().at(stage));
+    }
+  }
+
+  // mean duration of the stages over the successful repetitions
+  const double successful_repetitions {static_cast<double>(std::max<std::size_t>(result.latencies_ms.size(), 1))};
+  for(const auto& stage : {STAGE_VALIDATION, STAGE_PLANNING, STAGE_RADIUS_VALIDATION, STAGE_BLENDING, STAGE_MERGING})
+  {
+    result.counters[stage + "_ms"] = stage_times.get(stage) * 1000. / successful_repetitions;
+  }
+  result.counters["points"] = points;
+  result.counters["heap_peak_kb"] = measureHeapPeakKb(req);
+  return result;
+}
+
+std::vector<BenchmarkResult> CommandListManagerBenchmark::run()
+{
+  // untimed solve to exclude the lazy initialization of the planner and the IK solver
+  planning_interface::MotionPlanResponse warm_up_res;
+  manager_->solve(scene_, createRequest(base_request_.items.size(), true), warm_up_res);
+
+  std::vector<BenchmarkResult> results;
+  for(const bool blending : {false, true})
+  {
+    for(const int length : sequence_lengths_)
+    {
+      results.push_back(measure(static_cast<std::size_t>(length), blending));
+    }
+  }
+  return results;
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "benchmark_command_list_manager");
+
+  // the planner logs every command, which would distort the measurement
+  if(ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Warn))
+  {
+    ros::console::notifyLoggerLevelsChanged();
+  }
+
+  CommandListManagerBenchmark benchmark;
+  if(!benchmark.init())
+  {
+    return 1;
+  }
+  return writeResults(benchmark.getContext(), benchmark.run()) ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <moveit/kinematic_constraints/utils.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/robot_state/robot_state.h>
+#include <eigen_conversions/eigen_msg.h>
+
+#include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/trajectory_generator_circ.h"
+#include "pilz_trajectory_generation/trajectory_generator_lin.h"
+#include "pilz_trajectory_generation/trajectory_generator_ptp.h"
+
+#include "benchmark_utils.h"
+
+// parameters from parameter server
+const std::string PARAM_ROBOT_NAME("robot");
+const std::string PARAM_PLANNING_GROUP_NAME("planning_group");
+const std::string PARAM_TARGET_LINK_NAME("target_link");
+const std::string PARAM_START_JOINT_POSITIONS("start_joint_positions");
+const std::string PARAM_REPETITIONS("repetitions");
+const std::string PARAM_JOINT_DISTANCES("joint_distances");
+const std::string PARAM_CARTESIAN_DISTANCES("cartesian_distances");
+const std::string PARAM_SCALING_FACTORS("scaling_factors");
+const std::string PARAM_SAMPLING_TIMES("sampling_times");
+
+const std::string PARAM_NAMESPACE_LIMITS("robot_description_planning");
+
+using namespace pilz;
+using namespace pilz_benchmark;
+
+/**
+ * @brief Measures the latency of TrajectoryGenerator::generate() for the PTP, LIN and CIRC generators
+ *
+ * The motions start at a fixed joint configuration. PTP moves every joint by the joint distance,
+ * LIN moves the target link downwards by the cartesian distance and CIRC moves on a half circle
+ * with the cartesian distance as diameter. Every combination of distance, scaling factor and sampling time
+ * is planned "repetitions" times after one untimed warm up call.
+ */
+class TrajectoryGeneratorBenchmark
+{
+public:
+  bool init();
+  std::vector<BenchmarkResult> run();
+  std::map<std::string, std::string> getContext() const;
+
+private:
+  planning_interface::MotionPlanRequest createRequest(const std::string& planner_id,
+                                                      double scaling_factor) const;
+  planning_interface::MotionPlanRequest createPTPRequest(double distance, double scaling_factor) const;
+  planning_interface::MotionPlanRequest createLINRequest(double distance, double scaling_factor) const;
+  planning_interface::MotionPlanRequest createCIRCRequest(double distance, double scaling_factor) const;
+
+  BenchmarkResult measure(const std::string& name,
+                          TrajectoryGenerator& generator,
+                          const planning_interface::MotionPlanRequest& req,
+                          double sampling_time) const;
+
+  static std::string formatName(const std::string& planner_id, const std::string& robot,
+                                double distance, double scaling_factor, double sampling_time);
+
+private:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_;
+  LimitsContainer limits_;
+  robot_state::RobotStatePtr start_state_;
+  Eigen::Isometry3d start_pose_;
+
+  std::string robot_, planning_group_, target_link_;
+  int repetitions_ {20};
+  std::vector<double> joint_distances_ {0.1, 0.5, 1.0};
+  std::vector<double> cartesian_distances_ {0.05, 0.1, 0.2};
+  std::vector<double> scaling_factors_ {0.1, 0.5, 1.0};
+  std::vector<double> sampling_times_ {0.008, 0.004, 0.001};
+};
+
+bool TrajectoryGeneratorBenchmark::init()
+{
+  if(!ph_.getParam(PARAM_PLANNING_GROUP_NAME, planning_group_) || !ph_.getParam(PARAM_TARGET_LINK_NAME, target_link_))
+  {
+    ROS_ERROR_STREAM("The parameters " << PARAM_PLANNING_GROUP_NAME << " and " << PARAM_TARGET_LINK_NAME
+                     << " are required.");
+    return false;
+  }
+  ph_.param(PARAM_ROBOT_NAME, robot_, std::string("robot"));
+  ph_.param(PARAM_REPETITIONS, repetitions_, repetitions_);
+  ph_.param(PARAM_JOINT_DISTANCES, joint_distances_, joint_distances_);
+  ph_.param(PARAM_CARTESIAN_DISTANCES, cartesian_distances_, cartesian_distances_);
+  ph_.param(PARAM_SCALING_FACTORS, scaling_factors_, scaling_factors_);
+  ph_.param(PARAM_SAMPLING_TIMES, sampling_times_, sampling_times_);
+
+  robot_model_ = robot_model_loader::RobotModelLoader("robot_description").getModel();
+  if(!robot_model_ || !robot_model_->hasJointModelGroup(planning_group_) || !robot_model_->hasLinkModel(target_link_))
+  {
+    ROS_ERROR_STREAM("Failed to load a robot model with group " << planning_group_ << " and link " << target_link_);
+    return false;
+  }
+
+  ros::NodeHandle limits_nh(PARAM_NAMESPACE_LIMITS);
+  JointLimitsContainer joint_limits {
+    JointLimitsAggregator::getAggregatedLimits(limits_nh, robot_model_->getActiveJointModels())};
+  CartesianLimit cartesian_limit {CartesianLimitsAggregator::getAggregatedLimits(limits_nh)};
+  limits_.setJointLimits(joint_limits);
+  limits_.setCartesianLimits(cartesian_limit);
+
+  const robot_model::JointModelGroup* group {robot_model_->getJointModelGroup(planning_group_)};
+  start_state_.reset(new robot_state::RobotState(robot_model_));
+  start_state_->setToDefaultValues();
+
+  std::vector<double> start_joint_positions;
+  if(ph_.getParam(PARAM_START_JOINT_POSITIONS, start_joint_positions))
+  {
+    if(start_joint_positions.size() != group->getActiveJointModels().size())
+    {
+      ROS_ERROR_STREAM("The parameter " << PARAM_START_JOINT_POSITIONS << " needs one value per active joint of "
+                       << planning_group_);
+      return false;
+    }
+    start_state_->setJointGroupPositions(group, start_joint_positions);
+  }
+  start_state_->update();
+  start_pose_ = start_state_->getFrameTransform(target_link_);
+  return true;
+}
+
+std::map<std::string, std::string> TrajectoryGeneratorBenchmark::getContext() const
+{
+  return {{"robot", robot_},
+          {"planning_group", planning_group_},
+          {"target_link", target_link_},
+          {"repetitions", std::to_string(repetitions_)}};
+}
+
+planning_interface::MotionPlanRequest TrajectoryGeneratorBenchmark::createRequest(const std::string& planner_id,
+                                                                                  double scaling_factor) const
+{
+  planning_interface::MotionPlanRequest req;
+  req.planner_id = planner_id;
+  req.group_name = planning_group_;
+  req.max_velocity_scaling_factor = scaling_factor;
+  req.max_acceleration_scaling_factor = scaling_factor;
+  moveit::core::robotStateToRobotStateMsg(*start_state_, req.start_state, false);
+  return req;
+}
+
+planning_interface::MotionPlanRequest TrajectoryGeneratorBenchmark::createPTPRequest(double distance,
+                                                                                     double scaling_factor) const
+{
+  planning_interface::MotionPlanRequest req {createRequest("PTP", scaling_factor)};
+
+  const robot_model::JointModelGroup* group {robot_model_->getJointModelGroup(planning_group_)};
+  robot_state::RobotState goal_state(*start_state_);
+  std::vector<double> goal_positions;
+  goal_state.copyJointGroupPositions(group, goal_positions);
+  for(auto& position : goal_positions)
+  {
+    position += distance;
+  }
+  goal_state.setJointGroupPositions(group, goal_positions);
+  goal_state.enforceBounds(group);
+
+  req.goal_constraints.push_back(kinematic_constraints::constructGoalConstraints(goal_state, group));
+  return req;
+}
+
+planning_interface::MotionPlanRequest TrajectoryGeneratorBenchmark::createLINRequest(double distance,
+                                                                                     double scaling_factor) const
+{
+  planning_interface::MotionPlanRequest req {createRequest("LIN", scaling_factor)};
+
+  geometry_msgs::PoseStamped goal_pose;
+  goal_pose.header.frame_id = robot_model_->getModelFrame();
+  tf::poseEigenToMsg(start_pose_, goal_pose.pose);
+  goal_pose.pose.position.z -= distance;
+
+  req.goal_constraints.push_back(kinematic_constraints::constructGoalConstraints(target_link_, goal_pose));
+  return req;
+}
+
+planning_interface::MotionPlanRequest TrajectoryGeneratorBenchmark::createCIRCRequest(double distance,
+                                                                                      double scaling_factor) const
+{
+  planning_interface::MotionPlanRequest req {createLINRequest(distance, scaling_factor)};
+  req.planner_id = "CIRC";
+
+  // the interim point lies on the half circle with the start and the goal on its diameter
+  geometry_msgs::Point interim;
+  interim.x = start_pose_.translation().x();
+  interim.y = start_pose_.translation().y() + distance / 2.;
+  interim.z = start_pose_.translation().z() - distance / 2.;
+
+  moveit_msgs::PositionConstraint interim_constraint;
+  interim_constraint.header.frame_id = robot_model_->getModelFrame();
+  interim_constraint.link_name = target_link_;
+  geometry_msgs::Pose interim_pose;
+  interim_pose.position = interim;
+  interim_pose.orientation.w = 1.;
+  interim_constraint.constraint_region.primitive_poses.push_back(interim_pose);
+
+  req.path_constraints.name = "interim";
+  req.path_constraints.position_constraints.push_back(interim_constraint);
+  return req;
+}
+
+BenchmarkResult TrajectoryGeneratorBenchmark::measure(const std::string& name,
+                                                      TrajectoryGenerator& generator,
+                                                      const planning_interface::MotionPlanRequest& req,
+                                                      double sampling_time) const
+{
+  BenchmarkResult result;
+  result.name = name;
+
+  // untimed call to exclude the lazy initialization of the IK solver
+  planning_interface::MotionPlanResponse warm_up_res;
+  generator.generate(req, warm_up_res, sampling_time);
+
+  std::size_t points {0};
+  for(int i = 0; i < repetitions_; ++i)
+  {
+    planning_interface::MotionPlanResponse res;
+    const StopWatch stop_watch;
+    const bool success {generator.generate(req, res, sampling_time)};
+    const double latency_ms {stop_watch.elapsedMs()};
+
+    if(!success)
+    {
+      ++result.failures;
+      continue;
+    }
+    result.latencies_ms.push_back(latency_ms);
+    points = res.trajectory_->getWayPointCount();
+  }
+
+  const double mean_latency_ms {mean(result.latencies_ms)};
+  result.counters["points"] = points;
+  result.counters["points_per_second"] = mean_latency_ms > 0. ? points / (mean_latency_ms / 1000.) : 0.;
+  return result;
+}
+
+std::string TrajectoryGeneratorBenchmark::formatName(const std::string& planner_id, const std::string& robot,
+                                                     double distance, double scaling_factor, double sampling_time)
+{
+  std::stringstream ss;
+  ss << planner_id << "/" << robot << "/distance:" << distance << "/scaling:" << scaling_factor
+     << "/sampling_time:" << sampling_time;
+  return ss.str();
+}
+
+std::vector<BenchmarkResult> TrajectoryGeneratorBenchmark::run()
+{
+  TrajectoryGeneratorPTP ptp(robot_model_, limits_);
+  TrajectoryGeneratorLIN lin(robot_model_, limits_);
+  TrajectoryGeneratorCIRC circ(robot_model_, limits_);
+
+  std::vector<BenchmarkResult> results;
+  for(const double scaling_factor : scaling_factors_)
+  {
+    for(const double sampling_time : sampling_times_)
+    {
+      for(const double distance : joint_distances_)
+      {
+        results.push_back(measure(formatName("PTP", robot_, distance, scaling_factor, sampling_time),
+                                  ptp, createPTPRequest(distance, scaling_factor), sampling_time));
+      }
+      for(const double distance : cartesian_distances_)
+      {
+        results.push_back(measure(formatName("LIN", robot_, distance, scaling_factor, sampling_time),
+                                  lin, createLINRequest(distance, scaling_factor), sampling_time));
+        results.push_back(measure(formatName("CIRC", robot_, distance, scaling_factor, sampling_time),
+                                  circ, createCIRCRequest(distance, scaling_factor), sampling_time));
+      }
+    }
+  }
+  return results;
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "benchmark_trajectory_generators");
+
+  // the generators log every plan, which would distort the measurement
+  if(ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Warn))
+  {
+    ros::console::notifyLoggerLevelsChanged();
+  }
+
+  TrajectoryGeneratorBenchmark benchmark;
+  if(!benchmark.init())
+  {
+    return 1;
+  }
+  return writeResults(benchmark.getContext(), benchmark.run()) ? 0 : 1;
+}
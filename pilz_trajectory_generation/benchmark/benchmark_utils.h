@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+namespace pilz_benchmark
+{
+
+/**
+ * @brief Measurements of one benchmark case
+ */
+struct BenchmarkResult
+{
+  //! Unique name of the case, e.g. "PTP/prbt/distance:0.5/scaling:1/sampling_time:0.008"
+  std::string name;
+
+  //! Latency of each successful repetition in milliseconds
+  std::vector<double> latencies_ms;
+
+  //! Number of failed repetitions
+  std::size_t failures {0};
+
+  //! Additional values of the case, e.g. the number of trajectory points
+  std::map<std::string, double> counters;
+};
+
+/**
+ * @brief Monotonic stop watch measuring in milliseconds
+ */
+class StopWatch
+{
+public:
+  StopWatch() : start_(std::chrono::steady_clock::now()) {}
+
+  double elapsedMs() const
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+inline double mean(const std::vector<double>& values)
+{
+  return values.empty() ? 0. : std::accumulate(values.begin(), values.end(), 0.) / values.size();
+}
+
+inline double median(std::vector<double> values)
+{
+  if(values.empty())
+  {
+    return 0.;
+  }
+  std::sort(values.begin(), values.end());
+  const std::size_t mid {values.size() / 2};
+  return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.;
+}
+
+/**
+ * @brief Writes the results in a format similar to the JSON output of Google Benchmark
+ * @param context: description of the run, e.g. the robot model
+ */
+inline void writeJson(std::ostream& os,
+                      const std::map<std::string, std::string>& context,
+                      const std::vector<BenchmarkResult>& results)
+{
+  os << "{\n  \"context\": {";
+  std::string separator {"\n"};
+  for(const auto& entry : context)
+  {
+    os << separator << "    \"" << entry.first << "\": \"" << entry.second << "\"";
+    separator = ",\n";
+  }
+  os << "\n  },\n  \"benchmarks\": [";
+
+  separator = "\n";
+  for(const auto& result : results)
+  {
+    const auto minmax {std::minmax_element(result.latencies_ms.begin(), result.latencies_ms.end())};
+    os << separator << "    {\n"
+       << "      \"name\": \"" << result.name << "\",\n"
+       << "      \"iterations\": " << result.latencies_ms.size() << ",\n"
+       << "      \"failures\": " << result.failures << ",\n"
+       << "      \"time_unit\": \"ms\",\n"
+       << "      \"real_time_mean\": " << mean(result.latencies_ms) << ",\n"
+       << "      \"real_time_median\": " << median(result.latencies_ms) << ",\n"
+       << "      \"real_time_min\": " << (result.latencies_ms.empty() ? 0. : *minmax.first) << ",\n"
+       << "      \"real_time_max\": " << (result.latencies_ms.empty() ? 0. : *minmax.second);
+    for(const auto& counter : result.counters)
+    {
+      os << ",\n      \"" << counter.first << "\": " << counter.second;
+    }
+    os << "\n    }";
+    separator = ",\n";
+  }
+  os << "\n  ]\n}\n";
+}
+
+/**
+ * @brief Writes the results to the file given by the private parameter "output_file", or to stdout if it is not set
+ */
+inline bool writeResults(const std::map<std::string, std::string>& context,
+                         const std::vector<BenchmarkResult>& results)
+{
+  std::string output_file;
+  if(!ros::NodeHandle("~").getParam("output_file", output_file) || output_file.empty())
+  {
+    writeJson(std::cout, context, results);
+    return true;
+  }
+
+  std::ofstream file(output_file);
+  if(!file)
+  {
+    ROS_ERROR_STREAM("Failed to open " << output_file);
+    return false;
+  }
+  writeJson(file, context, results);
+  ROS_INFO_STREAM("Benchmark results written to " << output_file);
+  return true;
+}
+
+}
+
+#endif // BENCHMARK_UTILS_H
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include "pilz_msgs/MotionSequenceRecord.h"
+#include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/sequence_recorder.h"
+
+#include "benchmark_utils.h"
+
+// parameters from parameter server
+// not "record_file", that parameter would make the CommandListManager of the replay record again
+const std::string PARAM_REPLAY_FILE("replay_file");
+const std::string PARAM_REPETITIONS("repetitions");
+
+using namespace pilz_trajectory_generation;
+using namespace pilz_benchmark;
+
+/**
+ * @brief Replays the sequences recorded by the sequence capabilities (see SequenceRecorder) with CommandListManager.
+ *
+ * Each record is planned again in its recorded planning scene. The latency is reported together with the recorded
+ * latency, differences of the result (error code, number of points, duration, joint positions) are reported as
+ * counters and logged as warning.
+ */
+class SequenceReplay
+{
+public:
+  bool init();
+  std::vector<BenchmarkResult> run();
+  std::map<std::string, std::string> getContext() const;
+
+private:
+  BenchmarkResult replay(std::size_t index, const pilz_msgs::MotionSequenceRecord& record);
+
+  /**
+   * @brief Adds the differences between the recorded and the replayed result to the counters
+   * @return true if the results are equal within the tolerance
+   */
+  bool compare(const moveit_msgs::MotionPlanResponse& recorded,
+               const planning_interface::MotionPlanResponse& replayed,
+               std::map<std::string, double>& counters) const;
+
+private:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_;
+  std::unique_ptr<CommandListManager> manager_;
+
+  std::string replay_file_;
+  int repetitions_ {1};
+
+  /// Number of records whose replayed result differs from the recorded one
+  std::size_t differing_results_ {0};
+};
+
+/// Tolerance of the joint positions and the duration when comparing the results
+static constexpr double RESULT_TOLERANCE {1e-6};
+
+bool SequenceReplay::init()
+{
+  if(!ph_.getParam(PARAM_REPLAY_FILE, replay_file_))
+  {
+    ROS_ERROR_STREAM("The parameter " << PARAM_REPLAY_FILE << " is required.");
+    return false;
+  }
+  ph_.param(PARAM_REPETITIONS, repetitions_, repetitions_);
+
+  robot_model_ = robot_model_loader::RobotModelLoader("robot_description").getModel();
+  if(!robot_model_)
+  {
+    ROS_ERROR("Failed to load the robot model.");
+    return false;
+  }
+
+  manager_.reset(new CommandListManager(ph_, robot_model_));
+  return true;
+}
+
+std::map<std::string, std::string> SequenceReplay::getContext() const
+{
+  return {{"replay_file", replay_file_},
+          {"repetitions", std::to_string(repetitions_)},
+          {"differing_results", std::to_string(differing_results_)}};
+}
+
+std::vector<BenchmarkResult> SequenceReplay::run()
+{
+  std::vector<BenchmarkResult> results;
+
+  rosbag::Bag bag(replay_file_, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(SEQUENCE_RECORD_TOPIC_NAME));
+  std::size_t index {0};
+  for(const rosbag::MessageInstance& message : view)
+  {
+    const pilz_msgs::MotionSequenceRecord::ConstPtr record {message.instantiate<pilz_msgs::MotionSequenceRecord>()};
+    if(record)
+    {
+      results.push_back(replay(index++, *record));
+    }
+  }
+
+  ROS_INFO_STREAM("Replayed " << index << " record(s), " << differing_results_ << " with a different result.");
+  return results;
+}
+
+BenchmarkResult SequenceReplay::replay(std::size_t index, const pilz_msgs::MotionSequenceRecord& record)
+{
+  BenchmarkResult result;
+  std::stringstream name;
+  name << "Replay/record:" << index << "/items:" << record.request.items.size();
+  result.name = name.str();
+
+  // the recorded scene contains the full state of the robot and the world
+  const planning_scene::PlanningScenePtr scene {std::make_shared<planning_scene::PlanningScene>(robot_model_)};
+  scene->setPlanningSceneMsg(record.planning_scene);
+
+  bool equal {true};
+  for(int i = 0; i < repetitions_; ++i)
+  {
+    planning_interface::MotionPlanResponse res;
+    const StopWatch stop_watch;
+    const bool success {manager_->solve(scene, record.request, res)};
+    const double latency_ms {stop_watch.elapsedMs()};
+
+    if(success)
+    {
+      result.latencies_ms.push_back(latency_ms);
+    }
+    else
+    {
+      ++result.failures;
+    }
+
+    // the result is deterministic, comparing the first repetition suffices
+    if(i == 0)
+    {
+      equal = compare(record.response, res, result.counters);
+    }
+  }
+  result.counters["recorded_latency_ms"] = record.response.planning_time * 1000.;
+
+  if(!equal)
+  {
+    ++differing_results_;
+    ROS_WARN_STREAM(result.name << ": the replayed result differs from the recorded one (error code "
+                    << record.response.error_code.val << " -> " << result.counters["replayed_error_code"]
+                    << ", points " << record.response.trajectory.joint_trajectory.points.size() << " -> "
+                    << result.counters["replayed_points"] << ").");
+  }
+  return result;
+}
+
+bool SequenceReplay::compare(const moveit_msgs::MotionPlanResponse& recorded,
+                             const planning_interface::MotionPlanResponse& replayed,
+                             std::map<std::string, double>& counters) const
+{
+  moveit_msgs::MotionPlanResponse replayed_msg;
+  replayed.getMessage(replayed_msg);
+
+  const auto& recorded_points {recorded.trajectory.joint_trajectory.points};
+  const auto& replayed_points {replayed_msg.trajectory.joint_trajectory.points};
+
+  counters["recorded_error_code"] = recorded.error_code.val;
+  counters["replayed_error_code"] = replayed_msg.error_code.val;
+  counters["recorded_points"] = recorded_points.size();
+  counters["replayed_points"] = replayed_points.size();
+
+  const double recorded_duration {recorded_points.empty() ? 0. : recorded_points.back().time_from_start.toSec()};
+  const double replayed_duration {replayed_points.empty() ? 0. : replayed_points.back().time_from_start.toSec()};
+  counters["duration_diff_s"] = replayed_duration - recorded_duration;
+
+  // the joint positions can only be compared point by point if the number of points is equal
+  double max_position_diff {0.};
+  if(recorded_points.size() == replayed_points.size())
+  {
+    for(std::size_t i = 0; i < recorded_points.size(); ++i)
+    {
+      const auto& recorded_positions {recorded_points[i].positions};
+      const auto& replayed_positions {replayed_points[i].positions};
+      for(std::size_t j = 0; j < std::min(recorded_positions.size(), replayed_positions.size()); ++j)
+      {
+        max_position_diff = std::max(max_position_diff, std::fabs(recorded_positions[j] - replayed_positions[j]));
+      }
+    }
+  }
+  counters["max_position_diff_rad"] = max_position_diff;
+
+  return recorded.error_code.val == replayed_msg.error_code.val
+      && recorded_points.size() == replayed_points.size()
+      && std::fabs(counters["duration_diff_s"]) <= RESULT_TOLERANCE
+      && max_position_diff <= RESULT_TOLERANCE;
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "replay_sequence_records");
+
+  // the planner logs every command, which would distort the measurement
+  if(ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Warn))
+  {
+    ros::console::notifyLoggerLevelsChanged();
+  }
+
+  SequenceReplay replay;
+  if(!replay.init())
+  {
+    return 1;
+  }
+
+  std::vector<BenchmarkResult> results;
+  try
+  {
+    results = replay.run();
+  }
+  catch(const rosbag::BagException& ex)
+  {
+    ROS_ERROR_STREAM("Failed to read the record file: " << ex.what());
+    return 1;
+  }
+  return writeResults(replay.getContext(), results) ? 0 : 1;
+}
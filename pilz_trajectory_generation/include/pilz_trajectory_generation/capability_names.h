@@ -24,6 +24,14 @@ namespace pilz_trajectory_generation
 {
 
 static const std::string SEQUENCE_SERVICE_NAME = "plan_sequence_path";
+static const std::string RELOAD_LIMITS_TOPIC_NAME = "reload_limits";
+static const std::string DUMP_TRACE_TOPIC_NAME = "dump_planning_trace";
+static const std::string SPLINE_OUTPUT_TOLERANCE_PARAM_NAME = "spline_output_tolerance";
+/// The only planner configuration from which the spline output tolerance is taken
+static const std::string SPLINE_OUTPUT_CONFIGURATION_NAME = "spline_output";
+/// Sampling time in seconds which the planner reports in the configuration SPLINE_OUTPUT_CONFIGURATION_NAME,
+/// 0 if its trajectories are not uniformly sampled
+static const std::string SAMPLING_TIME_PARAM_NAME = "sampling_time";
 
 }
 
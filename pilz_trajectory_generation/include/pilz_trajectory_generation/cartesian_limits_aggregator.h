@@ -18,6 +18,9 @@
 #ifndef CARTESIAN_LIMITS_AGGREGATOR_H
 #define CARTESIAN_LIMITS_AGGREGATOR_H
 
+#include <ros/ros.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
 #include "pilz_trajectory_generation/cartesian_limit.h"
 
 namespace pilz {
@@ -40,10 +43,18 @@ class CartesianLimitsAggregator
      * - "max_rot_vel", the maximum rotational velocity [rad/s]
      * - "max_rot_acc", the maximum rotational acceleration [rad/s^2]
      * - "max_rot_dec", the maximum rotational deceleration (<= 0)[rad/s^2]
+     * @note All parameters of the namespace are fetched with a single request to the parameter server.
      * @param nh node handle to access the parameters
      * @return the obtained cartesian limits
      */
     static CartesianLimit getAggregatedLimits(const ros::NodeHandle& nh);
+
+    /**
+     * @brief Same as above, using the already fetched parameters of the namespace, see getParamNamespace().
+     * @param params the parameters of the namespace
+     * @return the obtained cartesian limits
+     */
+    static CartesianLimit getAggregatedLimits(XmlRpc::XmlRpcValue params);
 };
 
 }
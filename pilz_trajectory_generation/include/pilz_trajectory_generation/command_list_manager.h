@@ -17,15 +17,33 @@
 #ifndef COMMAND_LIST_MANAGER_H
 #define COMMAND_LIST_MANAGER_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit_msgs/MotionPlanResponse.h>
+#include <std_msgs/Empty.h>
 
 #include "pilz_msgs/MotionSequenceRequest.h"
+#include "pilz_trajectory_generation/resource_usage.h"
+#include "pilz_trajectory_generation/sequence_recorder.h"
+#include "pilz_trajectory_generation/stage_times.h"
 #include "pilz_trajectory_generation/trajectory_blender.h"
+#include "pilz_trajectory_generation/trajectory_decimator.h"
 #include <pilz_trajectory_generation/trajectory_appender.h>
 
 namespace pilz_trajectory_generation {
 
+// Stages reported by CommandListManager::solve()
+static const std::string STAGE_VALIDATION = "validation";
+static const std::string STAGE_PLANNING = "planning";
+static const std::string STAGE_RADIUS_VALIDATION = "radius_validation";
+static const std::string STAGE_BLENDING = "blending";
+static const std::string STAGE_MERGING = "merging";
+static const std::string STAGE_DECIMATION = "decimation";
+
 /**
  * @brief The CommandListManager class
  * This class can create a smooth trajectory from a given list of motion commands.
@@ -52,13 +70,119 @@ public:
    *        - The blending radius of the last request is 0
    *        - Only the first request has a start state
    * @param[out] res The resulting trajectory
+   * @param[out] stage_times Optional, the durations of the stages (see STAGE_*) are added if given
+   * @param[out] resource_usage Optional, the CPU time of the planning is added if given (see pilz::ResourceMeter),
+   * the heap peak of the process during the planning only if the parameter "measure_heap_peak" is true
+   * @param[out] decimation Optional, set to the number of waypoints before and after the decimation if given
    * @return True if the generation was successful, false otherwise
+   *
+   * If tracing is enabled (see pilz::TraceRecorder), the recorded spans are written to the trace file every
+   * "trace_dump_interval" solves.
+   * If the parameter "record_file" is set, the request, the planning scene and the result are recorded
+   * (see SequenceRecorder).
+   * If the parameter "decimation_tolerance" is > 0, the waypoints which the interpolation of the controller
+   * ("decimation_interpolation", "cubic" or "quintic") reconstructs within the tolerance are removed from the result
+   * (see pilz::TrajectoryDecimator).
    */
   bool solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
              const pilz_msgs::MotionSequenceRequest& req_list,
-             planning_interface::MotionPlanResponse &res);
+             planning_interface::MotionPlanResponse &res,
+             pilz::StageTimes* stage_times = nullptr,
+             pilz::ResourceUsage* resource_usage = nullptr,
+             pilz::DecimationStatistics* decimation = nullptr);
+
+  /**
+   * @brief Reads the limits used for blending again from the parameter server.
+   *
+   * The new limits are validated against the bounds of the robot model. On failure the previous limits are kept.
+   * Sequences which are already being solved finish with the previous limits.
+   * Triggered by a message on the topic RELOAD_LIMITS_TOPIC_NAME.
+   * @return true if the new limits were applied, false otherwise
+   */
+  bool reloadLimits();
+
+  /**
+   * @brief Terminates the running solve() or, if none is running, the next one
+   *
+   * The planning of the current command and the blending stop at the next trajectory sample, solve() fails
+   * with moveit_msgs::MoveItErrorCodes::PREEMPTED. The request is withdrawn once a solve() completes.
+   * Can be called from another thread.
+   */
+  void terminate();
+
+  /**
+   * @brief Withdraws a terminate() which did not abort a solve(), e.g. one which arrived after the planning of a goal
+   */
+  void resetTermination();
 
 private:
+  /**
+   * @brief Creates a blender using the limits from the parameter server
+   * @throw pilz::AggregationException if the limits violate the bounds given in the robot model
+   */
+  std::shared_ptr<pilz::TrajectoryBlender> createBlender() const;
+
+  void reloadLimitsCallback(const std_msgs::Empty::ConstPtr& msg);
+
+  /**
+   * @brief Reads the trace parameters and enables the recording of planning spans if requested
+   */
+  void setupTracing();
+
+  /**
+   * @brief Opens the record file if the parameter "record_file" is set
+   */
+  void setupRecording();
+
+  /**
+   * @brief Disables the spline output of the planner of the sequences, the blending needs sampled trajectories
+   */
+  void disableSplineOutput();
+
+  /**
+   * @brief Reads the sampling time which the planner of the sequences reports in its configurations
+   *
+   * The time is not used if the planning pipeline has request adapters, they may change the timing of the
+   * trajectories. See pilz::CommandPlanner::setPlannerConfigurations().
+   */
+  void readPlannerSamplingTime();
+
+  /**
+   * @brief Creates the decimator if the parameter "decimation_tolerance" is > 0
+   */
+  void setupDecimation();
+
+  /**
+   * @brief Removes the reconstructible waypoints of the result if the decimation is enabled
+   */
+  void decimateTrajectory(robot_trajectory::RobotTrajectory& trajectory,
+                          pilz::StageStopWatch& stop_watch,
+                          pilz::DecimationStatistics* decimation) const;
+
+  /**
+   * @brief Hands the request, the planning scene and the result to the recorder
+   */
+  void recordSequence(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                      const pilz_msgs::MotionSequenceRequest& req_list,
+                      const planning_interface::MotionPlanResponse& res,
+                      double planning_time);
+
+  /**
+   * @brief Writes the recorded planning spans to the trace file, triggered by a message on DUMP_TRACE_TOPIC_NAME
+   */
+  void dumpTraceCallback(const std_msgs::Empty::ConstPtr& msg);
+
+  /**
+   * @brief Implements solve(), the trace span of solve() has to be closed before the trace is written
+   * @param resource_meter samples the heap peak at the end of each stage
+   */
+  bool solveSequence(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                     const pilz_msgs::MotionSequenceRequest& req_list,
+                     planning_interface::MotionPlanResponse &res,
+                     pilz::StageTimes* stage_times,
+                     pilz::ResourceMeter& resource_meter,
+                     pilz::DecimationStatistics* decimation);
+
   /**
    * @brief Validate if the request list fullfills the conditions noted
    *        under pilz_trajectory_generation::CommandListManager::solve
@@ -86,6 +210,7 @@ private:
    * @param req_list The motion plan request list
    * @param res The response used to set the error code on validation error
    * @param motion_plan_responses Essentially constains the generated trajectories
+   * @param sampling_times Sampling time of each trajectory which is blended, 0 if unknown or not blended
    * @param radii List of blending radii
    * @return True if trajectories for all request could be generated
    */
@@ -93,6 +218,7 @@ private:
                      const pilz_msgs::MotionSequenceRequest &req_list,
                      planning_interface::MotionPlanResponse &res,
                      std::vector<planning_interface::MotionPlanResponse>& motion_plan_responses,
+                     std::vector<double>& sampling_times,
                      std::vector<double>& radii);
 
   /**
@@ -103,16 +229,20 @@ private:
    * Two given consecutive trajectories are simply put behind one another (if blend radii == 0).
    *
    * @param motion_plan_responses Contains the generated trajectories
+   * @param sampling_times Sampling times of the generated trajectories, passed on to the blender
    * @param radii List of blending radii
    * @param result_trajectory The final trajectory created from the given trajectories
    * @param res The response used to set the error code on validation error
+   * @param stop_watch Measures the blending and the merging
    *
    * @return True if trajectory generation succeeded, false otherwise. On false the res will contain the error code.
    */
   bool generateTrajectory(const std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+                          const std::vector<double> &sampling_times,
                           const std::vector<double> &radii,
                           robot_trajectory::RobotTrajectoryPtr& result_trajectory,
-                          planning_interface::MotionPlanResponse &res);
+                          planning_interface::MotionPlanResponse &res,
+                          pilz::StageStopWatch& stop_watch);
 
   /**
    * @brief The the name of the to frame (link) of the given group
@@ -127,11 +257,47 @@ private:
   /// Robot model
   moveit::core::RobotModelConstPtr model_;
 
+  /// Planning pipeline used to solve the single requests, created once to keep the planner (and its contexts) alive
+  planning_pipeline::PlanningPipelinePtr planning_pipeline_;
+
+  /// Sampling time reported by the planner, 0 if unknown, then the trajectories are checked before blending
+  double planner_sampling_time_ {0.};
+
   /// TrajectoryAppender
   TrajectoryAppender appender_;
 
-  /// TrajectoryBlender
-  std::unique_ptr<pilz::TrajectoryBlender> blender_;
+  /// TrajectoryBlender, only accessed via std::atomic_load/std::atomic_store to allow swapping it while solving
+  std::shared_ptr<pilz::TrajectoryBlender> blender_;
+
+  /// Triggers reloadLimits()
+  ros::Subscriber reload_limits_subscriber_;
+
+  /// Reading the heap in use locks all malloc arenas, so the heap peak is only measured on request
+  bool measure_heap_peak_ {false};
+
+  /// Triggers writing the recorded planning spans
+  ros::Subscriber dump_trace_subscriber_;
+
+  /// File the recorded planning spans are written to
+  std::string trace_file_;
+
+  /// The recorded planning spans are written every trace_dump_interval_ solves, never if 0
+  std::size_t trace_dump_interval_ {0};
+
+  /// Number of solves since the trace was written the last time
+  std::atomic<std::size_t> solves_since_dump_ {0};
+
+  /// Records the planned sequences, only set if recording is enabled
+  std::shared_ptr<SequenceRecorder> recorder_;
+
+  /// Decimates the planned sequences, only set if the decimation is enabled
+  std::unique_ptr<const pilz::TrajectoryDecimator> decimator_;
+
+  /// Serializes concurrent limit reloads
+  std::mutex reload_mutex_;
+
+  /// Set by terminate(), reset when a solve() completes or by resetTermination()
+  std::atomic_bool terminated_ {false};
 };
 
 }
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IK_STATISTICS_H
+#define IK_STATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <ostream>
+
+namespace pilz
+{
+
+/**
+ * @brief Cost of the inverse kinematics computed by computePoseIK(), summed up over all calls it is passed to
+ *
+ * The validity callback is invoked for every solution found by the IK solver, so validity_checks is the number of
+ * attempts of the solver which lead to a solution. The time of the validity callback (self collision check) is part
+ * of ik_seconds.
+ */
+struct IKStatistics
+{
+  /// Reasons of a failed computePoseIK()
+  enum Failure
+  {
+    INVALID_GROUP = 0,
+    NO_IK_SOLVER,
+    INVALID_FRAME,
+    NO_SOLUTION,
+    FAILURE_COUNT
+  };
+
+  /// Calls of computePoseIK()
+  std::size_t calls {0};
+  /// Calls of RobotState::setFromIK()
+  std::size_t solver_calls {0};
+  /// Invocations of the validity callback
+  std::size_t validity_checks {0};
+  /// Solutions rejected by the validity callback
+  std::size_t rejected_solutions {0};
+  /// Time in RobotState::setFromIK() in seconds, including the validity callback
+  double ik_seconds {0.};
+  /// Time in the validity callback in seconds
+  double validity_seconds {0.};
+  /// Longest single call of RobotState::setFromIK() in seconds, a call without solution takes the full IK timeout
+  double max_solver_call_seconds {0.};
+  /// Failed calls of computePoseIK() per reason
+  std::array<std::size_t, FAILURE_COUNT> failures {{}};
+
+  /**
+   * @return time of the IK solver without the validity callback in seconds
+   */
+  double getSolverSeconds() const
+  {
+    return ik_seconds - validity_seconds;
+  }
+
+  std::size_t getFailureCount() const
+  {
+    return std::accumulate(failures.begin(), failures.end(), std::size_t {0});
+  }
+
+  /**
+   * @brief Adds the statistics of other calls, e.g. of another trajectory
+   */
+  void add(const IKStatistics& other)
+  {
+    calls += other.calls;
+    solver_calls += other.solver_calls;
+    validity_checks += other.validity_checks;
+    rejected_solutions += other.rejected_solutions;
+    ik_seconds += other.ik_seconds;
+    validity_seconds += other.validity_seconds;
+    max_solver_call_seconds = std::max(max_solver_call_seconds, other.max_solver_call_seconds);
+    for(std::size_t i = 0; i < failures.size(); ++i)
+    {
+      failures[i] += other.failures[i];
+    }
+  }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const IKStatistics& statistics)
+{
+  os << "IK calls: " << statistics.calls
+     << ", solver calls: " << statistics.solver_calls
+     << ", validity checks: " << statistics.validity_checks
+     << " (" << statistics.rejected_solutions << " rejected)"
+     << ", solver time: " << statistics.getSolverSeconds() << "s"
+     << ", validity time: " << statistics.validity_seconds << "s"
+     << ", slowest solver call: " << statistics.max_solver_call_seconds << "s"
+     << ", failures (group/solver/frame/solution): " << statistics.failures[IKStatistics::INVALID_GROUP]
+     << "/" << statistics.failures[IKStatistics::NO_IK_SOLVER]
+     << "/" << statistics.failures[IKStatistics::INVALID_FRAME]
+     << "/" << statistics.failures[IKStatistics::NO_SOLUTION];
+  return os;
+}
+
+}
+
+#endif // IK_STATISTICS_H
@@ -20,8 +20,10 @@
 
 #include "pilz_extensions/joint_limits_extension.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
+#include "pilz_trajectory_generation/joint_limits_provider.h"
 
 #include <ros/ros.h>
+#include <xmlrpcpp/XmlRpcValue.h>
 
 #include <moveit/planning_interface/planning_interface.h>
 #include <moveit/planning_interface/planning_response.h>
@@ -50,6 +52,7 @@ class JointLimitsAggregator
    *   4. If max_deceleration is unset, it will be set to: max_deceleration = - max_acceleration.
    * @note The acceleration/deceleration can only be set via the parameter server since they are not supported
    * in the urdf so far.
+   * @note All parameters of the namespace are fetched with a single request to the parameter server.
    * @param nh Node handle in whose namespace the joint limit parameters are expected.
    * @param joint_models The joint models
    * @return Container containing the limits
@@ -57,6 +60,39 @@ class JointLimitsAggregator
     static JointLimitsContainer getAggregatedLimits(const ros::NodeHandle& nh,
                                            const std::vector<const moveit::core::JointModel*>& joint_models);
 
+  /**
+   * @brief Same as above, using the already fetched parameters of the namespace, see getParamNamespace().
+   * @param params The parameters of the namespace
+   * @param joint_models The joint models
+   * @return Container containing the limits
+   */
+    static JointLimitsContainer getAggregatedLimits(XmlRpc::XmlRpcValue params,
+                                           const std::vector<const moveit::core::JointModel*>& joint_models);
+
+  /**
+   * @brief Reads the payload model from the parameter server and creates a provider scaling the acceleration limits
+   * with the attached payload.
+   *
+   * The parameters are expected in the namespace "payload" of the given node handle:
+   *   - max_mass: payload the aggregated limits are valid for
+   *   - object_masses: map from attached object id to its mass (optional)
+   *   - joint_limits/<joint_name>/max_acceleration, max_deceleration: limits without payload (optional)
+   *
+   * The limits without payload must not be stricter than the aggregated limits.
+   * @param nh Node handle in whose namespace the payload parameters are expected.
+   * @param limits The aggregated limits, valid for the maximal payload
+   * @return The provider, nullptr if no payload model is configured
+   * @throw AggregationException if the payload model is invalid
+   */
+    static JointLimitsProviderConstPtr getPayloadLimitsProvider(const ros::NodeHandle& nh,
+                                                                const JointLimitsContainer& limits);
+
+  /**
+   * @brief Same as above, using the already fetched parameters of the namespace, see getParamNamespace().
+   */
+    static JointLimitsProviderConstPtr getPayloadLimitsProvider(XmlRpc::XmlRpcValue params,
+                                                                const JointLimitsContainer& limits);
+
   protected:
     /**
      * @brief Update the position limits with the ones from the joint_model.
@@ -85,7 +85,14 @@ public:
    * @return joint limit
    * @throws std::out_of_range if a joint limit with this name does not exist
    */
-  pilz_extensions::JointLimit getLimit(const std::string& joint_name) const;
+  const pilz_extensions::JointLimit& getLimit(const std::string& joint_name) const;
+
+  /**
+   * @brief findLimit get the limit for the given joint name with a single lookup
+   * @param joint_name
+   * @return pointer to the joint limit, nullptr if a joint limit with this name does not exist
+   */
+  const pilz_extensions::JointLimit* findLimit(const std::string& joint_name) const;
 
   /**
    * @brief ConstIterator to the underlying data structure
@@ -101,9 +108,9 @@ public:
   std::map<std::string, pilz_extensions::JointLimit>::const_iterator end() const;
 
   /**
-   * @brief verify position limit of single joint
+   * @brief verify velocity limit of single joint
    * @param joint_name
-   * @param joint_position
+   * @param joint_velocity
    * @return
    */
   bool verifyVelocityLimit(const std::string& joint_name,
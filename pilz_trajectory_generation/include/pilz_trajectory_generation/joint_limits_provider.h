@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOINT_LIMITS_PROVIDER_H
+#define JOINT_LIMITS_PROVIDER_H
+
+#include <memory>
+
+#include <moveit/robot_state/robot_state.h>
+
+#include "pilz_trajectory_generation/joint_limits_container.h"
+
+namespace pilz
+{
+
+/**
+ * @brief Interface for classes adapting the static joint limits to the current state of the robot,
+ * e.g. to the attached payload.
+ */
+class JointLimitsProvider
+{
+public:
+  virtual ~JointLimitsProvider() = default;
+
+  /**
+   * @brief Returns the joint limits to plan with in the given robot state
+   * @param limits the static limits, valid for every state of the robot
+   * @param state the robot state including the attached bodies
+   * @return joint limits which must not be weaker than the physical capability of the robot in the given state
+   */
+  virtual JointLimitsContainer getLimits(const JointLimitsContainer& limits,
+                                         const robot_state::RobotState& state) const = 0;
+};
+
+typedef std::shared_ptr<const JointLimitsProvider> JointLimitsProviderConstPtr;
+
+}
+
+#endif // JOINT_LIMITS_PROVIDER_H
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOINT_LIMITS_TABLE_H
+#define JOINT_LIMITS_TABLE_H
+
+#include <cmath>
+#include <vector>
+
+#include <moveit/robot_model/robot_model.h>
+
+#include "pilz_trajectory_generation/joint_limits_container.h"
+
+namespace pilz
+{
+/**
+ * @brief Immutable lookup table of joint limits addressed by the variable index of the robot model.
+ *
+ * Each bound is stored in its own array. Missing limits are stored as infinite bounds,
+ * so that the verification functions do not need to check the has_..._limits flags.
+ * Decelerations are stored as positive magnitudes.
+ */
+class JointLimitsTable
+{
+public:
+  JointLimitsTable() = default;
+
+  /**
+   * @brief Build the table for all variables of the robot model
+   * @param robot_model kinematic model of the robot, defines the variable indices
+   * @param joint_limits limits by joint name, limits of joints which are not part of the model are ignored
+   */
+  JointLimitsTable(const robot_model::RobotModelConstPtr& robot_model,
+                   const JointLimitsContainer& joint_limits);
+
+  /**
+   * @brief Number of variables in the table
+   */
+  std::size_t size() const
+  {
+    return max_velocity_.size();
+  }
+
+  bool verifyPosition(std::size_t index, double position) const
+  {
+    return position >= min_position_[index] && position <= max_position_[index];
+  }
+
+  bool verifyVelocity(std::size_t index, double velocity) const
+  {
+    return std::fabs(velocity) <= max_velocity_[index];
+  }
+
+  bool verifyAcceleration(std::size_t index, double acceleration) const
+  {
+    return std::fabs(acceleration) <= max_acceleration_[index];
+  }
+
+  bool verifyDeceleration(std::size_t index, double deceleration) const
+  {
+    return std::fabs(deceleration) <= max_deceleration_[index];
+  }
+
+  double getMinPosition(std::size_t index) const
+  {
+    return min_position_[index];
+  }
+
+  double getMaxPosition(std::size_t index) const
+  {
+    return max_position_[index];
+  }
+
+  double getMaxVelocity(std::size_t index) const
+  {
+    return max_velocity_[index];
+  }
+
+  double getMaxAcceleration(std::size_t index) const
+  {
+    return max_acceleration_[index];
+  }
+
+  /**
+   * @brief Returns the magnitude of the deceleration limit
+   */
+  double getMaxDeceleration(std::size_t index) const
+  {
+    return max_deceleration_[index];
+  }
+
+private:
+  std::vector<double> min_position_;
+  std::vector<double> max_position_;
+  std::vector<double> max_velocity_;
+  std::vector<double> max_acceleration_;
+  std::vector<double> max_deceleration_;
+};
+
+}
+
+#endif // JOINT_LIMITS_TABLE_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOINT_TRAJECTORY_COLUMNS_H
+#define JOINT_TRAJECTORY_COLUMNS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Joint trajectory of the joints of one planning group, stored column-wise
+ *
+ * Holds one column with the time from start and one column per joint for the positions, velocities and
+ * accelerations. Compared to a trajectory_msgs::JointTrajectory no vectors are allocated per point and compared to a
+ * robot_trajectory::RobotTrajectory only the joints of the group are stored.
+ *
+ * The generators sample into this container and convert it once into a robot_trajectory::RobotTrajectory by
+ * toRobotTrajectory().
+ */
+class JointTrajectoryColumns
+{
+public:
+  JointTrajectoryColumns() = default;
+  explicit JointTrajectoryColumns(const std::vector<std::string>& joint_names);
+
+  /**
+   * @brief Sets the joints of the trajectory, all points are removed
+   */
+  void setJointNames(const std::vector<std::string>& joint_names);
+
+  const std::vector<std::string>& getJointNames() const
+  {
+    return joint_names_;
+  }
+
+  std::size_t getJointCount() const
+  {
+    return joint_names_.size();
+  }
+
+  /**
+   * @return number of points
+   */
+  std::size_t size() const
+  {
+    return time_from_start_.size();
+  }
+
+  bool empty() const
+  {
+    return time_from_start_.empty();
+  }
+
+  /**
+   * @brief Reserves the memory of all columns for the given number of points
+   */
+  void reserve(std::size_t point_count);
+
+  /**
+   * @brief Removes all points, the joints are kept
+   */
+  void clear();
+
+  /**
+   * @brief Adds a point at the end of the trajectory
+   * @param positions, velocities, accelerations: one value per joint in the order of getJointNames()
+   */
+  void addPoint(double time_from_start,
+                const std::vector<double>& positions,
+                const std::vector<double>& velocities,
+                const std::vector<double>& accelerations);
+
+  /**
+   * @brief Sets the velocities and accelerations of the last point to zero
+   */
+  void setLastPointAtRest();
+
+  /**
+   * @brief Removes all points except the given ones, the kept points are moved to the front in place
+   * @param points: indices of the kept points in increasing order
+   */
+  void keepPoints(const std::vector<std::size_t>& points);
+
+  double getTimeFromStart(std::size_t point) const
+  {
+    return time_from_start_[point];
+  }
+
+  double getPosition(std::size_t joint, std::size_t point) const
+  {
+    return positions_[joint][point];
+  }
+
+  double getVelocity(std::size_t joint, std::size_t point) const
+  {
+    return velocities_[joint][point];
+  }
+
+  double getAcceleration(std::size_t joint, std::size_t point) const
+  {
+    return accelerations_[joint][point];
+  }
+
+  /**
+   * @brief Converts a joint trajectory message, missing velocities and accelerations are set to zero
+   */
+  void fromMsg(const trajectory_msgs::JointTrajectory& joint_trajectory);
+
+  void toMsg(trajectory_msgs::JointTrajectory& joint_trajectory) const;
+
+  /**
+   * @brief Converts the trajectory into a robot trajectory, equal to RobotTrajectory::setRobotTrajectoryMsg()
+   *
+   * Every waypoint is a copy of the reference state with the joints of this trajectory set. The variable indices of
+   * the joints are looked up once for all points.
+   * @param reference_state: state of the joints not contained in this trajectory
+   * @param trajectory: output, existing waypoints are removed
+   */
+  void toRobotTrajectory(const robot_state::RobotState& reference_state,
+                         robot_trajectory::RobotTrajectory& trajectory) const;
+
+  /**
+   * @return memory held by the points in bytes
+   */
+  std::size_t getMemoryBytes() const;
+
+private:
+  std::vector<std::string> joint_names_;
+  std::vector<double> time_from_start_;
+  /// One column per joint
+  std::vector<std::vector<double> > positions_;
+  std::vector<std::vector<double> > velocities_;
+  std::vector<std::vector<double> > accelerations_;
+};
+
+}
+
+#endif // JOINT_TRAJECTORY_COLUMNS_H
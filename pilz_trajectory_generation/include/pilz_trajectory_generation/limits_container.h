@@ -21,6 +21,7 @@
 #include <math.h>
 #include "pilz_trajectory_generation/cartesian_limit.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
+#include "pilz_trajectory_generation/joint_limits_provider.h"
 
 namespace pilz {
 
@@ -69,6 +70,22 @@ class LimitsContainer
      */
     const CartesianLimit& getCartesianLimits() const;
 
+    /**
+     * @brief Return if this LimitsContainer has a provider adapting the joint limits to the robot state
+     */
+    bool hasJointLimitsProvider() const;
+
+    /**
+     * @brief Set the provider adapting the joint limits to the robot state, e.g. to the attached payload
+     * @param joint_limits_provider provider, nullptr to plan with the static joint limits only
+     */
+    void setJointLimitsProvider(const JointLimitsProviderConstPtr& joint_limits_provider);
+
+    /**
+     * @brief Return the provider adapting the joint limits to the robot state
+     */
+    const JointLimitsProviderConstPtr& getJointLimitsProvider() const;
+
   private:
     /// Flag if joint limits where set
     bool has_joint_limits_;
@@ -82,6 +99,9 @@ class LimitsContainer
     /// The cartesian limits
     CartesianLimit cartesian_limit_;
 
+    /// Adapts the joint limits to the robot state, shared between all copies of the container
+    JointLimitsProviderConstPtr joint_limits_provider_;
+
 
 
 };
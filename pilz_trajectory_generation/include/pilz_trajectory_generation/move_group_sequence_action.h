@@ -25,6 +25,10 @@
 
 #include <pilz_msgs/MoveGroupSequenceAction.h>
 
+#include "pilz_trajectory_generation/resource_usage.h"
+#include "pilz_trajectory_generation/stage_times.h"
+#include "pilz_trajectory_generation/trajectory_decimator.h"
+
 namespace pilz_trajectory_generation
 {
 
@@ -52,7 +56,17 @@ private:
   void preemptMoveCallback();
   void setMoveState(move_group::MoveGroupState state);
   bool planUsingSequenceManager(const pilz_msgs::MotionSequenceRequest &req,
-                                 plan_execution::ExecutableMotionPlan& plan);
+                                plan_execution::ExecutableMotionPlan& plan,
+                                pilz::StageTimes* stage_times,
+                                pilz::ResourceUsage* resource_usage,
+                                pilz::DecimationStatistics* decimation);
+  static void setProcessingTimes(const pilz::StageTimes& stage_times, pilz_msgs::MoveGroupSequenceResult& action_res);
+  /**
+   * @brief Sets the CPU time, the peak heap memory of the planning and the memory held by the planned trajectory
+   */
+  static void setResourceUsage(const pilz::ResourceUsage& resource_usage,
+                               const robot_trajectory::RobotTrajectoryConstPtr& trajectory,
+                               pilz_msgs::MoveGroupSequenceResult& action_res);
 private:
   std::unique_ptr<actionlib::SimpleActionServer<pilz_msgs::MoveGroupSequenceAction> > move_action_server_;
   pilz_msgs::MoveGroupSequenceFeedback move_feedback_;
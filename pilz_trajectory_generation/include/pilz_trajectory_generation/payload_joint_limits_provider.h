@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAYLOAD_JOINT_LIMITS_PROVIDER_H
+#define PAYLOAD_JOINT_LIMITS_PROVIDER_H
+
+#include <map>
+#include <string>
+
+#include "pilz_trajectory_generation/joint_limits_provider.h"
+
+namespace pilz
+{
+
+/**
+ * @brief Unloaded acceleration limits of a single joint
+ */
+struct UnloadedJointLimit
+{
+  bool has_acceleration_limits {false};
+  double max_acceleration {0.};
+  bool has_deceleration_limits {false};
+  double max_deceleration {0.};
+};
+
+/**
+ * @brief Scales the acceleration and deceleration limits with the mass of the attached payload.
+ *
+ * The static limits are valid for the maximal payload. For each joint with an unloaded limit the
+ * limit is interpolated linearly between the unloaded limit (no payload) and the static limit (maximal payload).
+ * The mass of an attached body is looked up by its id, bodies of unknown mass are considered to have the
+ * maximal payload.
+ */
+class PayloadJointLimitsProvider : public JointLimitsProvider
+{
+public:
+  /**
+   * @param max_payload_mass mass the static limits are valid for, must be positive
+   * @param object_masses mass of the attachable objects by object id
+   * @param unloaded_limits acceleration limits without payload by joint name
+   */
+  PayloadJointLimitsProvider(double max_payload_mass,
+                             const std::map<std::string, double>& object_masses,
+                             const std::map<std::string, UnloadedJointLimit>& unloaded_limits);
+
+  JointLimitsContainer getLimits(const JointLimitsContainer& limits,
+                                 const robot_state::RobotState& state) const override;
+
+  /**
+   * @brief Returns the mass of all bodies attached to the robot, at most the maximal payload mass
+   */
+  double getPayloadMass(const robot_state::RobotState& state) const;
+
+private:
+  const double max_payload_mass_;
+  const std::map<std::string, double> object_masses_;
+  const std::map<std::string, UnloadedJointLimit> unloaded_limits_;
+};
+
+}
+
+#endif // PAYLOAD_JOINT_LIMITS_PROVIDER_H
@@ -18,7 +18,12 @@
 #ifndef PILZ_COMMAND_PLANNER_H
 #define PILZ_COMMAND_PLANNER_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <ros/ros.h>
+#include <std_msgs/Empty.h>
 
 #include "pilz_trajectory_generation/planning_context_loader.h"
 #include "pilz_extensions/joint_limits_extension.h"
@@ -83,6 +88,31 @@ public:
    */
   virtual bool canServiceRequest(const planning_interface::MotionPlanRequest& req) const override;
 
+  /**
+   * @brief Terminates all running solve() calls of the contexts handed out by this planner
+   *
+   * The running solve() calls stop at the next trajectory sample and fail with moveit_msgs::MoveItErrorCodes::PREEMPTED.
+   */
+  virtual void terminate() const override;
+
+  /**
+   * @brief Stores the planner configurations, the spline output tolerance is taken from them if given
+   *
+   * The key pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME of the configuration
+   * pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME sets the tolerance of the spline output, see
+   * setSplineTolerance(), the key is ignored in other configurations. Used by the sequence capability to plan sampled
+   * trajectories and by the set_planner_params service of the move_group.
+   * The stored configuration pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME always reports the sampling
+   * time of the planned trajectories under pilz_trajectory_generation::SAMPLING_TIME_PARAM_NAME.
+   */
+  virtual void setPlannerConfigurations(const planning_interface::PlannerConfigurationMap& pcs) override;
+
+  /**
+   * @brief Sets the tolerance of the spline output of all loaders, see TrajectoryGenerator::setSplineTolerance()
+   * @param tolerance: 0 for uniformly sampled trajectories
+   */
+  void setSplineTolerance(double tolerance);
+
   /**
    * @brief Register a PlanningContextLoader to be used by the CommandPlanner
    * @param planning_context_loader
@@ -90,6 +120,36 @@ public:
    */
   void registerContextLoader(pilz::PlanningContextLoaderPtr planning_context_loader);
 
+  /**
+   * @brief Reads the joint and cartesian limits again from the parameter server and hands them to all loaders.
+   *
+   * The new limits are validated against the bounds of the robot model. On failure the previous limits are kept.
+   * Contexts which are already in use finish planning with the limits they were created with.
+   * Triggered by a message on the topic pilz_trajectory_generation::RELOAD_LIMITS_TOPIC_NAME.
+   * @return true if the new limits were applied, false otherwise
+   */
+  bool reloadLimits();
+
+  /**
+   * @brief Returns the current limits, a snapshot which is not changed by a later reloadLimits()
+   */
+  std::shared_ptr<const pilz::LimitsContainer> getLimits() const;
+
+private:
+  /**
+   * @brief Aggregates the limits of the active joints and the cartesian limits from the parameter server
+   * @throw AggregationException if the limits violate the bounds given in the robot model
+   */
+  pilz::LimitsContainer aggregateLimits() const;
+
+  void reloadLimitsCallback(const std_msgs::Empty::ConstPtr& msg);
+
+  /**
+   * @brief Reports the sampling time of the planned trajectories in the planner configurations, 0 with spline output
+   * @param spline_tolerance: tolerance of the spline output the reported sampling time belongs to
+   */
+  void reportSamplingTime(double spline_tolerance);
+
 private:
 
   /// Plugin loader
@@ -104,11 +164,21 @@ private:
   /// Namespace where the parameters are stored, obtained at initialize
   std::string namespace_;
 
-  /// aggregated limits of the active joints
-  pilz::JointLimitsContainer aggregated_limit_active_joints_;
+  /// Keeps the shared scene of the self collision checks alive, see getSelfCollisionScene()
+  planning_scene::PlanningSceneConstPtr self_collision_scene_;
+
+  /// Aggregated joint limits of the active joints and cartesian limits, only accessed via
+  /// std::atomic_load/std::atomic_store since reloadLimits() replaces them while planning
+  std::shared_ptr<const pilz::LimitsContainer> limits_;
+
+  /// Triggers reloadLimits()
+  ros::Subscriber reload_limits_subscriber_;
+
+  /// Serializes concurrent limit reloads
+  std::mutex reload_mutex_;
 
-  /// cartesian limit
-  pilz::CartesianLimit cartesian_limit_;
+  /// Tolerance of the spline output handed to the loaders, atomic since it is set while planning
+  std::atomic<double> spline_tolerance_ {0.};
 };
 
 MOVEIT_CLASS_FORWARD(CommandPlanner)
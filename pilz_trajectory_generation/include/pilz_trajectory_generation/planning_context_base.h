@@ -41,15 +41,23 @@ class PlanningContextBase : public planning_interface::PlanningContext
 {
 public:
 
+  /**
+   * @param generator_args additional arguments passed to the constructor of the trajectory generator
+   */
+  template <typename... GeneratorArgs>
   PlanningContextBase<GeneratorT>(const std::string& name,
                      const std::string& group,
                      const moveit::core::RobotModelConstPtr& model,
-                     const pilz::LimitsContainer& limits):
+                     const pilz::LimitsContainer& limits,
+                     const GeneratorArgs&... generator_args):
   planning_interface::PlanningContext(name, group),
   terminated_(false),
   model_(model),
   limits_(limits),
-  generator_(model, limits_){}
+  generator_(model, limits_, generator_args...)
+  {
+    generator_.setTerminationFlag(&terminated_);
+  }
 
   virtual ~PlanningContextBase() {}
 
@@ -62,8 +70,8 @@ public:
 
   /**
    * @brief Will return the same trajectory as solve(planning_interface::MotionPlanResponse& res)
-   * This function just delegates to the common response however here the same trajectory is stored with the
-   * descriptions "plan", "simplify", "interpolate"
+   * The trajectory is stored once per stage of the trajectory generator, the description is the name of the stage
+   * (see STAGE_* in trajectory_functions.h) and the processing time its duration in seconds.
    * @param res The detailed response
    * @return true on success, false otherwise
    */
@@ -71,16 +79,27 @@ public:
 
   /**
    * @brief Will terminate solve()
-   * @return
-   * @note Currently will not stop a runnning solve but
+   *
+   * A running solve() stops at the next trajectory sample and fails with moveit_msgs::MoveItErrorCodes::PREEMPTED.
+   * Can be called from another thread.
+   * @return true
    */
   virtual bool terminate() override;
 
   /**
    * @copydoc planning_interface::PlanningContext::clear()
+   * @note Resets the terminated flag, so that a pooled context can be reused for a new request.
    */
   virtual void clear() override;
 
+  /**
+   * @brief Enables the spline output of the trajectories, see TrajectoryGenerator::setSplineTolerance()
+   */
+  void setSplineTolerance(double tolerance)
+  {
+    generator_.setSplineTolerance(tolerance);
+  }
+
   /// Flag if terminated
   std::atomic_bool terminated_;
 
@@ -90,14 +109,35 @@ public:
   /// Joint limits to be used during planning
   pilz::LimitsContainer limits_;
 
+protected:
+  /**
+   * @brief Implementation of solve(), the durations of the stages are added to stage_times if given
+   */
+  bool plan(planning_interface::MotionPlanResponse& res, StageTimes* stage_times);
+
+  /**
+   * @brief Logs the cost of the inverse kinematics of a planned trajectory, warns about slow IK solver calls
+   */
+  void logIKStatistics(const IKStatistics& ik_statistics) const;
+
 protected:
   GeneratorT generator_;
 
+  /// Fraction of the IK timeout from which an IK solver call is reported as slow
+  static constexpr double SLOW_IK_FRACTION {0.5};
+
 };
 
 
 template <typename GeneratorT>
 bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlanResponse &res)
+{
+  return plan(res, nullptr);
+}
+
+template <typename GeneratorT>
+bool pilz::PlanningContextBase<GeneratorT>::plan(planning_interface::MotionPlanResponse &res,
+                                                 StageTimes* stage_times)
 {
   if(!terminated_)
   {
@@ -108,7 +148,11 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
       moveit::core::robotStateToRobotStateMsg(getPlanningScene()->getCurrentState(), currentState);
       request_.start_state = currentState;
     }
-    bool result = generator_.generate(request_, res);
+
+    IKStatistics ik_statistics;
+    bool result = generator_.generate(request_, res, TrajectoryGenerator::DEFAULT_SAMPLING_TIME, stage_times,
+                                      &ik_statistics);
+    logIKStatistics(ik_statistics);
     return result;
     //res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     //return false; // TODO
@@ -120,24 +164,31 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
 }
 
 
+template <typename GeneratorT>
+void pilz::PlanningContextBase<GeneratorT>::logIKStatistics(const IKStatistics& ik_statistics) const
+{
+  ROS_DEBUG_STREAM(name_ << ": " << ik_statistics);
+  if(ik_statistics.max_solver_call_seconds >= SLOW_IK_FRACTION * DEFAULT_IK_TIMEOUT)
+  {
+    ROS_WARN_STREAM(name_ << ": the slowest IK solver call took " << ik_statistics.max_solver_call_seconds
+                    << "s of the timeout of " << DEFAULT_IK_TIMEOUT << "s.");
+  }
+}
+
 template <typename GeneratorT>
 bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlanDetailedResponse &res)
 {
    // delegate to regular response
    planning_interface::MotionPlanResponse undetailed_response;
-   bool result = solve(undetailed_response);
-
-   res.description_.push_back("plan");
-   res.trajectory_.push_back(undetailed_response.trajectory_);
-   res.processing_time_.push_back(undetailed_response.planning_time_);
-
-   res.description_.push_back("simplify");
-   res.trajectory_.push_back(undetailed_response.trajectory_);
-   res.processing_time_.push_back(0);
+   StageTimes stage_times;
+   bool result = plan(undetailed_response, &stage_times);
 
-   res.description_.push_back("interpolate");
-   res.trajectory_.push_back(undetailed_response.trajectory_);
-   res.processing_time_.push_back(0);
+   for(std::size_t i = 0; i < stage_times.getStages().size(); ++i)
+   {
+     res.description_.push_back(stage_times.getStages()[i]);
+     res.trajectory_.push_back(undetailed_response.trajectory_);
+     res.processing_time_.push_back(stage_times.getDurations()[i]);
+   }
 
    res.error_code_ = undetailed_response.error_code_;
    return result;
@@ -156,8 +207,7 @@ bool pilz::PlanningContextBase<GeneratorT>::terminate()
 template <typename GeneratorT>
 void pilz::PlanningContextBase<GeneratorT>::clear()
 {
-  // No structures that need cleaning
-  return;
+  terminated_ = false;
 }
 
 
@@ -19,8 +19,11 @@
 #define PLANNING_CONTEXT_LOADER_H
 
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <moveit/planning_interface/planning_interface.h>
@@ -52,11 +55,22 @@ public:
 
   /**
    * @brief Sets limits the planner can pass to the contexts
+   *
+   * Can be called while planning, contexts which are in use keep the limits they were created with.
    * @param limits container of limits, no guarantee to contain the limits for all joints of the model
    * @return true if limits could be set
    */
   virtual bool setLimits(const pilz::LimitsContainer& limits);
 
+  /**
+   * @brief Sets the tolerance of the spline output of the contexts, see TrajectoryGenerator::setSplineTolerance()
+   *
+   * Like setLimits() contexts which are in use keep the tolerance they were created with. The pooled contexts are only
+   * dropped if the tolerance changes.
+   * @param tolerance: 0 for uniformly sampled trajectories
+   */
+  void setSplineTolerance(double tolerance);
+
   /**
    * @brief Return the planning context
    * @param planning_context
@@ -68,19 +82,32 @@ public:
                    const std::string& name,
                    const std::string& group) const = 0;
 
+  /**
+   * @brief Terminates all contexts handed out by this loader, running solve() calls stop as soon as possible
+   *
+   * Idle pooled contexts are cleared before they are handed out again, so later requests are not affected.
+   */
+  void terminateContexts() const;
+
 
 protected:
   /**
    * @brief Return the planning context of type T
+   *
+   * Contexts are pooled per (name, group). An idle pooled context (only referenced by the pool) is cleared and handed
+   * out again instead of constructing a new one. If all pooled contexts are in use a new one is created.
+   *
    * @param planning_context
    * @param name context name
    * @param group name of the planning group
+   * @param args additional arguments passed to the constructor of a new context
    * @return true on success, false otherwise
    */
-  template <typename T>
+  template <typename T, typename... Args>
   bool loadContext(planning_interface::PlanningContextPtr& planning_context,
                    const std::string& name,
-                   const std::string& group) const;
+                   const std::string& group,
+                   const Args&... args) const;
 
 protected:
 
@@ -98,6 +125,34 @@ protected:
 
   /// The robot model
   moveit::core::RobotModelConstPtr model_;
+
+  /// Tolerance of the spline output of the contexts
+  double spline_tolerance_ {0.};
+
+private:
+  /**
+   * @brief Drop all pooled contexts, e.g. if the limits or the model change. Requires context_pool_mutex_ to be locked.
+   *
+   * The dropped contexts are still tracked as unpooled contexts to be able to terminate the ones in use.
+   */
+  void clearContextPool();
+
+  /// Track a context which is not part of the pool. Requires context_pool_mutex_ to be locked.
+  void addUnpooledContext(const planning_interface::PlanningContextPtr& planning_context) const;
+
+private:
+  /// Maximal number of contexts kept per (name, group)
+  static constexpr std::size_t MAX_POOLED_CONTEXTS {4};
+
+  /// Previously created contexts per (name, group)
+  mutable std::map<std::pair<std::string, std::string>,
+                   std::vector<planning_interface::PlanningContextPtr> > context_pool_;
+
+  /// Contexts handed out but not pooled, only needed to terminate them
+  mutable std::vector<planning_interface::PlanningContextWeakPtr> unpooled_contexts_;
+
+  /// Protects the context pool and the unpooled contexts
+  mutable std::mutex context_pool_mutex_;
 };
 
 
@@ -105,13 +160,40 @@ typedef boost::shared_ptr<PlanningContextLoader> PlanningContextLoaderPtr;
 typedef boost::shared_ptr<const PlanningContextLoader> PlanningContextLoaderConstPtr;
 
 
-template <typename T>
+template <typename T, typename... Args>
 bool PlanningContextLoader::loadContext(planning_interface::PlanningContextPtr& planning_context,
                                                          const std::string& name,
-                                                         const std::string& group) const
+                                                         const std::string& group,
+                                                         const Args&... args) const
 {
   if(limits_set_ && model_set_) {
-    planning_context.reset(new T(name, group, model_, limits_));
+    std::lock_guard<std::mutex> lock(context_pool_mutex_);
+    auto& pool = context_pool_[std::make_pair(name, group)];
+
+    // A context is idle if the pool holds the only reference to it
+    for(const auto& pooled_context : pool)
+    {
+      if(pooled_context.use_count() == 1)
+      {
+        pooled_context->clear();
+        planning_context = pooled_context;
+        PlanningMetrics::instance().increment(PlanningMetricsSnapshot::CONTEXT_CACHE_HITS);
+        return true;
+      }
+    }
+
+    PlanningMetrics::instance().increment(PlanningMetricsSnapshot::CONTEXT_CACHE_MISSES);
+    T* context {new T(name, group, model_, limits_, args...)};
+    context->setSplineTolerance(spline_tolerance_);
+    planning_context.reset(context);
+    if(pool.size() < MAX_POOLED_CONTEXTS)
+    {
+      pool.push_back(planning_context);
+    }
+    else
+    {
+      addUnpooledContext(planning_context);
+    }
     return true;
   }
   else
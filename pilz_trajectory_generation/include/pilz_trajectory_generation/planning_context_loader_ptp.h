@@ -19,9 +19,12 @@
 #define PLANNING_CONTEXT_LOADER_PTP_H
 
 #include "pilz_trajectory_generation/planning_context_loader.h"
+#include "pilz_trajectory_generation/trajectory_generator_ptp.h"
 
 #include <moveit/planning_interface/planning_interface.h>
 
+#include <mutex>
+
 namespace pilz {
 
 /**
@@ -44,6 +47,29 @@ public:
   virtual bool loadContext(planning_interface::PlanningContextPtr& planning_context,
                            const std::string& name,
                            const std::string& group) const override;
+
+  /**
+   * @copydoc PlanningContextLoader::setModel()
+   * @note Computes the most strict limits of the planning groups shared by all contexts
+   */
+  virtual bool setModel(const moveit::core::RobotModelConstPtr& model) override;
+
+  /**
+   * @copydoc PlanningContextLoader::setLimits()
+   * @note Computes the most strict limits of the planning groups shared by all contexts
+   */
+  virtual bool setLimits(const pilz::LimitsContainer& limits) override;
+
+private:
+  /// Recompute most_strict_limits_ once model and limits are set. Requires most_strict_limits_mutex_ to be locked.
+  void updateMostStrictLimits();
+
+private:
+  /// Most strict limits of the planning groups, computed once per model and limits
+  MostStrictLimitsConstPtr most_strict_limits_;
+
+  /// Keeps most_strict_limits_ consistent with the model and the limits the contexts are created with
+  mutable std::mutex most_strict_limits_mutex_;
 };
 
 typedef boost::shared_ptr<PlanningContextLoaderPTP> PlanningContextLoaderPTPPtr;                                                                             \
@@ -44,8 +44,9 @@ class PlanningContextPTP : public pilz::PlanningContextBase<TrajectoryGeneratorP
     PlanningContextPTP(const std::string& name,
                        const std::string& group,
                        const moveit::core::RobotModelConstPtr& model,
-                       const pilz::LimitsContainer& limits):
-    pilz::PlanningContextBase<TrajectoryGeneratorPTP>(name, group, model, limits){}
+                       const pilz::LimitsContainer& limits,
+                       const MostStrictLimitsConstPtr& most_strict_limits = nullptr):
+    pilz::PlanningContextBase<TrajectoryGeneratorPTP>(name, group, model, limits, most_strict_limits){}
 };
 
 } // namespace
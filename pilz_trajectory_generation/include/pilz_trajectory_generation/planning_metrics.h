@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANNING_METRICS_H
+#define PLANNING_METRICS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <diagnostic_msgs/DiagnosticStatus.h>
+#include <moveit/planning_interface/planning_response.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Histogram of latencies with logarithmic buckets, each power of two is split into 8 linear sub buckets.
+ *
+ * The relative error of a value taken from the histogram is below 12.5% over the whole range of values.
+ */
+class LatencyHistogram
+{
+public:
+  /// Number of linear sub buckets per power of two
+  static constexpr std::size_t SUB_BUCKET_COUNT {8};
+  static constexpr std::size_t BUCKET_COUNT {(64 - 2) * SUB_BUCKET_COUNT};
+
+  static std::size_t getBucketIndex(std::uint64_t value);
+
+  /**
+   * @return the largest value which falls into the bucket
+   */
+  static std::uint64_t getBucketUpperBound(std::size_t index);
+
+  void add(std::uint64_t value)
+  {
+    addToBucket(getBucketIndex(value), 1);
+  }
+
+  void addToBucket(std::size_t index, std::uint64_t count)
+  {
+    buckets_[index] += count;
+    count_ += count;
+  }
+
+  /**
+   * @brief Removes the values of an older state of the same histogram, e.g. to obtain the values of an interval
+   */
+  void subtract(const LatencyHistogram& older);
+
+  std::uint64_t getCount() const
+  {
+    return count_;
+  }
+
+  /**
+   * @param quantile in [0, 1]
+   * @return the upper bound of the bucket containing the quantile, 0 if the histogram is empty
+   */
+  std::uint64_t getQuantile(double quantile) const;
+
+  /**
+   * @return the upper bound of the highest filled bucket, 0 if the histogram is empty
+   */
+  std::uint64_t getMax() const;
+
+private:
+  std::array<std::uint64_t, BUCKET_COUNT> buckets_ {};
+  std::uint64_t count_ {0};
+};
+
+/**
+ * @brief Counters and latency histograms of the planning collected over all threads
+ */
+struct PlanningMetricsSnapshot
+{
+  enum Algorithm
+  {
+    PTP,
+    LIN,
+    CIRC,
+    SEQUENCE,
+    ALGORITHM_COUNT
+  };
+
+  enum Counter
+  {
+    IK_CALLS,
+    IK_FAILURES,
+    BLENDS,
+    CONTEXT_CACHE_HITS,
+    CONTEXT_CACHE_MISSES,
+    POINTS,
+    SEQUENCE_POINTS,
+    COUNTER_COUNT
+  };
+
+  static const std::array<std::string, ALGORITHM_COUNT> ALGORITHM_NAMES;
+  static const std::array<std::string, COUNTER_COUNT> COUNTER_NAMES;
+
+  std::array<std::uint64_t, ALGORITHM_COUNT> plans {};
+  std::array<std::uint64_t, ALGORITHM_COUNT> plan_failures {};
+
+  /// Planning latencies in microseconds
+  std::array<LatencyHistogram, ALGORITHM_COUNT> latencies_us;
+
+  std::array<std::uint64_t, COUNTER_COUNT> counters {};
+
+  /**
+   * @brief Removes the values of an older snapshot, e.g. to obtain the values of an interval
+   */
+  void subtract(const PlanningMetricsSnapshot& older);
+};
+
+/**
+ * @brief Collects counters and latencies of the planning.
+ *
+ * Each thread writes into its own block of relaxed atomics, so recording takes no locks and does not contend
+ * with other threads. Only the first recording of a thread locks to register its block. getSnapshot() sums up the
+ * blocks of all threads. The blocks are kept until the destruction of the metrics.
+ */
+class PlanningMetrics
+{
+public:
+  typedef PlanningMetricsSnapshot::Algorithm Algorithm;
+  typedef PlanningMetricsSnapshot::Counter Counter;
+
+  PlanningMetrics();
+  ~PlanningMetrics();
+
+  PlanningMetrics(const PlanningMetrics&) = delete;
+  PlanningMetrics& operator=(const PlanningMetrics&) = delete;
+
+  /**
+   * @brief The metrics collected by the planner, the sequence capabilities and the blender.
+   */
+  static PlanningMetrics& instance();
+
+  void recordPlan(Algorithm algorithm, std::chrono::nanoseconds latency, bool success);
+
+  void increment(Counter counter, std::uint64_t count = 1);
+
+  PlanningMetricsSnapshot getSnapshot() const;
+
+private:
+  struct ThreadMetrics;
+
+  ThreadMetrics& getThreadMetrics();
+
+  /// Distinguishes the instances in the cache of the thread local block
+  const std::uint64_t id_;
+
+  /// Protects the registration of the thread blocks
+  mutable std::mutex threads_mutex_;
+  std::vector<std::unique_ptr<ThreadMetrics> > threads_;
+};
+
+/**
+ * @brief Records the latency and the result of a planning request when leaving the scope.
+ *
+ * The request counts as successful if the error code of the response is SUCCESS, the number of points of the
+ * response trajectory is added to the POINTS counter, or to the SEQUENCE_POINTS counter for a sequence. The points of
+ * a sequence are already counted by the single commands.
+ */
+class ScopedPlanMetrics
+{
+public:
+  ScopedPlanMetrics(PlanningMetrics::Algorithm algorithm,
+                    const planning_interface::MotionPlanResponse& res,
+                    PlanningMetrics& metrics = PlanningMetrics::instance())
+    : algorithm_(algorithm),
+      res_(res),
+      metrics_(metrics),
+      start_(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedPlanMetrics();
+
+  ScopedPlanMetrics(const ScopedPlanMetrics&) = delete;
+  ScopedPlanMetrics& operator=(const ScopedPlanMetrics&) = delete;
+
+private:
+  const PlanningMetrics::Algorithm algorithm_;
+  const planning_interface::MotionPlanResponse& res_;
+  PlanningMetrics& metrics_;
+  const std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Converts the metrics into a diagnostic status.
+ *
+ * The counters are the totals since the start, the latency quantiles are taken from the interval since the
+ * previous status to show changes quickly.
+ * @param total The metrics since the start
+ * @param interval The metrics since the previous status
+ */
+diagnostic_msgs::DiagnosticStatus toDiagnosticStatus(const PlanningMetricsSnapshot& total,
+                                                     const PlanningMetricsSnapshot& interval);
+
+/**
+ * @brief Periodically publishes the metrics of PlanningMetrics::instance() on /diagnostics.
+ */
+class PlanningMetricsPublisher
+{
+public:
+  /**
+   * @param nh Node handle used to advertise the topic and create the timer
+   * @param period Publishing period in seconds
+   */
+  PlanningMetricsPublisher(ros::NodeHandle& nh, double period);
+
+private:
+  void publish(const ros::TimerEvent& event);
+
+  ros::Publisher publisher_;
+  ros::Timer timer_;
+
+  /// Metrics at the previous publish, used to compute the interval
+  PlanningMetricsSnapshot previous_;
+};
+
+/**
+ * @brief Starts publishing the planning metrics once per process, further calls do nothing.
+ *
+ * The planner is loaded multiple times within move_group (e.g. by the sequence capabilities), all instances
+ * write into the same metrics.
+ * @return true if the publishing was started by this call
+ */
+bool startPlanningMetricsPublisher(const ros::NodeHandle& nh, double period);
+
+}
+
+#endif // PLANNING_METRICS_H
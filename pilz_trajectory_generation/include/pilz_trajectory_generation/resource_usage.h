@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESOURCE_USAGE_H
+#define RESOURCE_USAGE_H
+
+#include <cstddef>
+
+namespace pilz
+{
+
+/**
+ * @brief CPU time and heap memory used by a computation
+ */
+struct ResourceUsage
+{
+  /// CPU time of the computing threads in seconds
+  double cpu_seconds {0.};
+  /// Highest heap memory in use by the process during the computation minus the one at its start in bytes, see
+  /// ResourceMeter
+  std::size_t heap_peak_bytes {0};
+
+  /**
+   * @brief Adds the usage of another computation, the CPU times are summed up, the larger heap peak is kept
+   */
+  void add(const ResourceUsage& other);
+};
+
+/**
+ * @brief Measures the resources used by the calling thread from the construction until the destruction
+ *
+ * The CPU time is the CPU time of the calling thread, so that it stays valid if other threads plan at the same time;
+ * threads which compute a part of the same request have to use their own meter and add their usage.
+ * The heap peak is the highest heap memory in use by the process at the construction, at each sampleHeap() and at the
+ * destruction, minus the one at the construction. Allocations freed between two samples are missed and the
+ * allocations of other threads in the meantime are included. Reading the heap locks all malloc arenas, so it is
+ * optional.
+ *
+ * Does nothing if no ResourceUsage is given, which allows to pass an optional nullptr through.
+ */
+class ResourceMeter
+{
+public:
+  explicit ResourceMeter(ResourceUsage* usage, bool measure_heap = true);
+
+  /**
+   * @brief Adds the measured usage to the ResourceUsage given at construction
+   */
+  ~ResourceMeter();
+
+  ResourceMeter(const ResourceMeter&) = delete;
+  ResourceMeter& operator=(const ResourceMeter&) = delete;
+
+  /**
+   * @brief Updates the heap peak with the heap memory currently in use, e.g. at the end of each stage
+   */
+  void sampleHeap();
+
+  /**
+   * @return CPU time of the calling thread in seconds
+   */
+  static double getThreadCpuSeconds();
+
+  /**
+   * @return bytes of heap memory in use by the process, 0 if the C library is not glibc
+   */
+  static std::size_t getHeapBytesInUse();
+
+private:
+  ResourceUsage* usage_;
+  const bool measure_heap_;
+  double cpu_start_ {0.};
+  std::size_t heap_start_ {0};
+  std::size_t heap_peak_ {0};
+};
+
+}
+
+#endif // RESOURCE_USAGE_H
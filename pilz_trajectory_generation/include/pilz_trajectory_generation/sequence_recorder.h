@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEQUENCE_RECORDER_H
+#define SEQUENCE_RECORDER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <rosbag/bag.h>
+#include <moveit/planning_interface/planning_response.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+#include "pilz_msgs/MotionSequenceRecord.h"
+#include "pilz_msgs/MotionSequenceRequest.h"
+
+namespace pilz_trajectory_generation
+{
+
+/// Topic of the records within the bag file
+static const std::string SEQUENCE_RECORD_TOPIC_NAME = "motion_sequence_records";
+
+/**
+ * @brief A planned sequence as queued for recording.
+ *
+ * The scene and the trajectory are shared with the queue and must not be modified after queueing.
+ */
+struct PlannedSequence
+{
+  /// Scene the sequence was planned in, nullptr if unknown
+  planning_scene::PlanningSceneConstPtr planning_scene;
+  pilz_msgs::MotionSequenceRequest request;
+  planning_interface::MotionPlanResponse response;
+};
+
+/**
+ * @brief Appends planned sequences to a bag file to replay them offline.
+ *
+ * The sequences are queued and converted into records and written by a background thread, so the planning
+ * neither waits for the message conversion nor for the disk.
+ * If the writer falls behind by more than max_pending records, new records are dropped instead of blocking.
+ */
+class SequenceRecorder
+{
+public:
+  /**
+   * @brief Opens the bag file, an existing file is overwritten.
+   * @throw rosbag::BagException if the file cannot be opened
+   */
+  SequenceRecorder(const std::string& file_name, std::size_t max_pending = 100);
+
+  /**
+   * @brief Writes the pending records and closes the bag file.
+   */
+  ~SequenceRecorder();
+
+  SequenceRecorder(const SequenceRecorder&) = delete;
+  SequenceRecorder& operator=(const SequenceRecorder&) = delete;
+
+  /**
+   * @brief Returns the recorder of the file, which is shared by all users of the file within the process.
+   *
+   * The sequence action and the sequence service record into the same file.
+   * @throw rosbag::BagException if the file cannot be opened
+   */
+  static std::shared_ptr<SequenceRecorder> getSharedRecorder(const std::string& file_name);
+
+  /**
+   * @brief Queues the sequence for writing.
+   * @return false if the sequence was dropped because too many records are pending
+   */
+  bool record(PlannedSequence&& sequence);
+
+  /**
+   * @brief Blocks until all queued records are written.
+   */
+  void flush();
+
+  /**
+   * @return the number of records dropped so far
+   */
+  std::size_t getDroppedCount() const;
+
+private:
+  void writeRecords();
+
+  static void toRecord(PlannedSequence&& sequence, pilz_msgs::MotionSequenceRecord& record);
+
+private:
+  rosbag::Bag bag_;
+  const std::size_t max_pending_;
+
+  /// Protects all members below
+  mutable std::mutex mutex_;
+  std::condition_variable pending_condition_;
+  std::condition_variable written_condition_;
+  std::deque<std::pair<ros::Time, PlannedSequence> > pending_;
+  bool writing_ {false};
+  bool stop_ {false};
+  std::size_t dropped_ {0};
+
+  std::thread writer_;
+};
+
+}
+
+#endif // SEQUENCE_RECORDER_H
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STAGE_TIMES_H
+#define STAGE_TIMES_H
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "pilz_trajectory_generation/resource_usage.h"
+
+namespace pilz
+{
+
+/**
+ * @brief Durations of the named stages of a computation in seconds, in the order the stages were first reported
+ */
+class StageTimes
+{
+public:
+  /**
+   * @brief Adds the duration to the stage, durations of a stage reported multiple times are summed up
+   */
+  void add(const std::string& stage, double seconds)
+  {
+    const auto it {std::find(stages_.begin(), stages_.end(), stage)};
+    if(it == stages_.end())
+    {
+      stages_.push_back(stage);
+      durations_.push_back(seconds);
+      return;
+    }
+    durations_[static_cast<std::size_t>(it - stages_.begin())] += seconds;
+  }
+
+  /**
+   * @return the duration of the stage, 0 if the stage was not reported
+   */
+  double get(const std::string& stage) const
+  {
+    const auto it {std::find(stages_.begin(), stages_.end(), stage)};
+    return it == stages_.end() ? 0. : durations_[static_cast<std::size_t>(it - stages_.begin())];
+  }
+
+  double total() const
+  {
+    return std::accumulate(durations_.begin(), durations_.end(), 0.);
+  }
+
+  const std::vector<std::string>& getStages() const
+  {
+    return stages_;
+  }
+
+  const std::vector<double>& getDurations() const
+  {
+    return durations_;
+  }
+
+  void clear()
+  {
+    stages_.clear();
+    durations_.clear();
+  }
+
+private:
+  std::vector<std::string> stages_;
+  std::vector<double> durations_;
+};
+
+/**
+ * @brief Measures consecutive stages with a monotonic clock
+ *
+ * Each call of lap() reports the time since the construction or the previous lap() as duration of the given stage.
+ * Does nothing if no StageTimes are given, which allows to pass an optional nullptr through.
+ * If a ResourceMeter is given, each lap() also samples its heap peak.
+ */
+class StageStopWatch
+{
+public:
+  explicit StageStopWatch(StageTimes* times, ResourceMeter* resource_meter = nullptr)
+    : times_(times),
+      resource_meter_(resource_meter),
+      last_(times ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+  {
+  }
+
+  void lap(const std::string& stage)
+  {
+    if(resource_meter_)
+    {
+      resource_meter_->sampleHeap();
+    }
+    if(!times_)
+    {
+      return;
+    }
+    const std::chrono::steady_clock::time_point now {std::chrono::steady_clock::now()};
+    times_->add(stage, std::chrono::duration<double>(now - last_).count());
+    last_ = now;
+  }
+
+private:
+  StageTimes* times_;
+  ResourceMeter* resource_meter_;
+  std::chrono::steady_clock::time_point last_;
+};
+
+}
+
+#endif // STAGE_TIMES_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace pilz
+{
+
+/**
+ * @brief Records timed spans into a fixed size ring buffer and exports them in the Chrome trace event format.
+ *
+ * Recording is lock-free and can be done from any thread, the oldest spans are overwritten once the buffer is full.
+ * The recorder is disabled until enable() is called, recording into a disabled recorder does nothing.
+ * The exported json can be opened with chrome://tracing or https://ui.perfetto.dev.
+ */
+class TraceRecorder
+{
+public:
+  TraceRecorder();
+  ~TraceRecorder();
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  /**
+   * @brief The recorder used by the planner, the generators and the blender.
+   */
+  static TraceRecorder& instance();
+
+  /**
+   * @brief Starts recording.
+   *
+   * The buffer is allocated by the first call, later calls keep the capacity of the existing buffer.
+   * @param capacity Number of spans kept in the ring buffer, recording is not enabled if 0.
+   */
+  void enable(std::size_t capacity);
+
+  /**
+   * @brief Stops recording, the recorded spans are kept.
+   */
+  void disable();
+
+  bool isEnabled() const
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @return the number of spans the ring buffer can hold, 0 before the first enable()
+   */
+  std::size_t getCapacity() const;
+
+  /**
+   * @brief Records a finished span.
+   * @param name Name of the span, has to outlive the recorder (e.g. a string literal) and must not contain quotes.
+   * @param begin_ns Start time in nanoseconds of the steady clock.
+   * @param end_ns End time in nanoseconds of the steady clock.
+   */
+  void record(const char* name, std::int64_t begin_ns, std::int64_t end_ns);
+
+  /**
+   * @brief Removes all recorded spans.
+   */
+  void clear();
+
+  /**
+   * @return the recorded spans as Chrome trace event json, the oldest span first
+   */
+  std::string toChromeTraceJson() const;
+
+  /**
+   * @brief Writes the recorded spans as Chrome trace event json into the given file.
+   * @return true on success, false if the file could not be written
+   */
+  bool writeChromeTrace(const std::string& file_name) const;
+
+  /**
+   * @return the current time of the steady clock in nanoseconds
+   */
+  static std::int64_t now();
+
+private:
+  struct Slot;
+
+  /// Ring buffer, allocated once by enable() and kept until the destruction of the recorder
+  std::atomic<Slot*> slots_ {nullptr};
+  std::size_t capacity_ {0};
+
+  /// Number of spans recorded so far, the next span is written to slots_[next_ % capacity_]
+  std::atomic<std::uint64_t> next_ {0};
+
+  std::atomic_bool enabled_ {false};
+
+  /// Serializes the allocation of the buffer and the writing of files, recording does not lock
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief Records the lifetime of the object as span, if the recorder is enabled at construction.
+ *
+ * Spans created within the lifetime of another span on the same thread are shown nested.
+ */
+class TraceSpan
+{
+public:
+  explicit TraceSpan(const char* name, TraceRecorder& recorder = TraceRecorder::instance())
+    : recorder_(recorder.isEnabled() ? &recorder : nullptr),
+      name_(name),
+      begin_ns_(recorder_ ? TraceRecorder::now() : 0)
+  {
+  }
+
+  ~TraceSpan()
+  {
+    if(recorder_)
+    {
+      recorder_->record(name_, begin_ns_, TraceRecorder::now());
+    }
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+  TraceRecorder* recorder_;
+  const char* name_;
+  std::int64_t begin_ns_;
+};
+
+}
+
+#endif // TRACE_RECORDER_H
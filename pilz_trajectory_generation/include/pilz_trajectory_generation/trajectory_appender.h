@@ -34,8 +34,11 @@ public:
      * @note Controllers, so far at least the ros_controllers::JointTrajectoryController require a timewise strictly
      * increasing trajectory. If through appending the last point of the original trajectory gets repeated it is removed
      * here.
+     *
+     * The waypoints of the source are shared with the result, not copied. Modifying a waypoint of one of the
+     * trajectories afterwards modifies it in both.
      */
-    void merge(robot_trajectory::RobotTrajectory &result, const robot_trajectory::RobotTrajectory &source) override;
+    void merge(robot_trajectory::RobotTrajectory &result, robot_trajectory::RobotTrajectory &source) override;
 
     //! Constant to check for equality of variables of two RobotState instances.
     static constexpr double ROBOT_STATE_EQUALITY_EPSILON = 1e-4;
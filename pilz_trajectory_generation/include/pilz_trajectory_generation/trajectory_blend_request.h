@@ -18,6 +18,7 @@
 #ifndef TRAJECTORY_BLEND_REQUEST_H
 #define TRAJECTORY_BLEND_REQUEST_H
 
+#include <atomic>
 #include <string>
 
 #include <moveit/robot_trajectory/robot_trajectory.h>
@@ -39,6 +40,13 @@ struct TrajectoryBlendRequest
 
   // Blend radius in meter
   double blend_radius;
+
+  // Sampling time of both trajectories if known by the caller, the durations of their waypoints are then not checked.
+  // If 0, the sampling time is determined and checked from the waypoints.
+  double sampling_time {0.};
+
+  // Optional flag terminating the blending as soon as it is set, not owned
+  const std::atomic_bool* terminated {nullptr};
 };
 
 
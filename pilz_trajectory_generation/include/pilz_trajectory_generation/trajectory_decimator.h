@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORY_DECIMATOR_H
+#define TRAJECTORY_DECIMATOR_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include "pilz_trajectory_generation/joint_trajectory_columns.h"
+
+namespace pilz
+{
+
+/**
+ * @brief Number of waypoints of a trajectory before and after the decimation
+ */
+struct DecimationStatistics
+{
+  std::size_t input_points {0};
+  std::size_t output_points {0};
+
+  /**
+   * @return input points per output point, 1 if no point was removed
+   */
+  double getCompressionRatio() const
+  {
+    return output_points == 0 ? 1. : static_cast<double>(input_points) / static_cast<double>(output_points);
+  }
+};
+
+/**
+ * @brief Removes the waypoints of a trajectory which the interpolation of a controller reconstructs anyway
+ *
+ * Controllers like the ros_controllers::JointTrajectoryController interpolate between the waypoints with splines,
+ * a cubic spline through the positions and velocities or a quintic spline through the positions, velocities and
+ * accelerations of the two neighbouring waypoints. A waypoint is removed if the spline between the remaining
+ * waypoints passes all removed waypoints of the segment within the tolerance, in every joint of the group.
+ * The first and the last waypoint are always kept.
+ */
+class TrajectoryDecimator
+{
+public:
+  enum Interpolation
+  {
+    CUBIC,
+    QUINTIC
+  };
+
+  /**
+   * @param tolerance: largest allowed deviation of the interpolated joint positions from the removed waypoints
+   * @param interpolation: interpolation of the controller the trajectory is meant for
+   */
+  TrajectoryDecimator(double tolerance, Interpolation interpolation);
+
+  /**
+   * @brief Parses "cubic" or "quintic"
+   * @return false if the name is unknown
+   */
+  static bool parseInterpolation(const std::string& name, Interpolation& interpolation);
+
+  /**
+   * @brief Removes the reconstructible waypoints, the remaining waypoints are not copied
+   *
+   * The waypoints are searched with an exponential search followed by a binary search per segment, every accepted
+   * segment is checked against all waypoints it replaces.
+   */
+  DecimationStatistics decimate(robot_trajectory::RobotTrajectory& trajectory) const;
+
+  /**
+   * @brief Removes the reconstructible points of a joint trajectory, all joints of the trajectory are compared
+   *
+   * Used by the generators to reduce their samples to the knots of a spline.
+   */
+  DecimationStatistics decimate(JointTrajectoryColumns& trajectory) const;
+
+  /**
+   * @brief Interpolates the position at the given time of a segment like the controller does
+   * @param duration: duration of the segment, > 0
+   * @param time: time since the start of the segment
+   */
+  static double interpolate(Interpolation interpolation, double duration, double time,
+                            double start_position, double start_velocity, double start_acceleration,
+                            double end_position, double end_velocity, double end_acceleration);
+
+private:
+  /**
+   * @brief Searches the waypoints to keep
+   * @param count: number of waypoints
+   * @param is_reconstructible: true if the segment between two waypoints passes all waypoints between them
+   * @return indices of the kept waypoints in increasing order, including the first and the last one
+   */
+  std::vector<std::size_t> findKeptWaypoints(std::size_t count,
+                                             const std::function<bool(std::size_t, std::size_t)>& is_reconstructible)
+                                             const;
+
+  /**
+   * @return true if the segment between the waypoints start and end passes all waypoints between them within the
+   * tolerance
+   */
+  bool isReconstructible(const robot_trajectory::RobotTrajectory& trajectory,
+                         const std::vector<double>& times,
+                         const std::vector<int>& variable_indices,
+                         std::size_t start,
+                         std::size_t end) const;
+
+  /**
+   * @return true if the segment between the points start and end passes all points between them within the tolerance
+   */
+  bool isReconstructible(const JointTrajectoryColumns& trajectory, std::size_t start, std::size_t end) const;
+
+private:
+  const double tolerance_;
+  const Interpolation interpolation_;
+};
+
+}
+
+#endif // TRAJECTORY_DECIMATOR_H
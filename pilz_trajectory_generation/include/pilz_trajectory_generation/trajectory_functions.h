@@ -18,6 +18,8 @@
 #ifndef TRAJECTORY_FUNCTIONS_H
 #define TRAJECTORY_FUNCTIONS_H
 
+#include <atomic>
+
 #include <Eigen/Geometry>
 #include <kdl/trajectory.hpp>
 #include <moveit/robot_model/robot_model.h>
@@ -26,14 +28,32 @@
 #include <eigen_conversions/eigen_msg.h>
 #include <trajectory_msgs/MultiDOFJointTrajectory.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/planning_scene/planning_scene.h>
 #include <tf/transform_datatypes.h>
 
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/joint_limits_table.h"
 #include "pilz_trajectory_generation/cartesian_trajectory.h"
+#include "pilz_trajectory_generation/ik_statistics.h"
+#include "pilz_trajectory_generation/joint_trajectory_columns.h"
+#include "pilz_trajectory_generation/stage_times.h"
 
 
 namespace pilz {
 
+/**
+ * @brief Checks the optional termination flag of a running planning request
+ * @param terminated: flag set from another thread to stop the planning, nullptr if planning cannot be terminated
+ * @return true if the flag is given and set
+ */
+inline bool isTerminated(const std::atomic_bool* terminated)
+{
+  return terminated && terminated->load(std::memory_order_relaxed);
+}
+
+/// Default timeout of the IK solver in seconds
+static constexpr double DEFAULT_IK_TIMEOUT {0.1};
+
 /**
  * @brief compute the inverse kinematics of a given pose, also check robot self collision
  * @param robot_model: kinematic model of the robot
@@ -44,7 +64,8 @@ namespace pilz {
  * @param seed: seed state of IK solver
  * @param solution: solution of IK
  * @param check_self_collision: true to enable self collision checking after IK computation
- * @param max_attempt: maximal attempts of IK
+ * @param timeout: timeout of the IK solver in seconds
+ * @param ik_statistics: optional, the cost of the call is added if given
  * @return true if succeed
  */
 bool computePoseIK(const robot_model::RobotModelConstPtr& robot_model,
@@ -55,7 +76,8 @@ bool computePoseIK(const robot_model::RobotModelConstPtr& robot_model,
                    const std::map<std::string, double>& seed,
                    std::map<std::string, double>& solution,
                    bool check_self_collision = true,
-                   const double timeout = 0.1);
+                   const double timeout = DEFAULT_IK_TIMEOUT,
+                   IKStatistics* ik_statistics = nullptr);
 
 bool computePoseIK(const robot_model::RobotModelConstPtr& robot_model,
                    const std::string& group_name,
@@ -65,7 +87,36 @@ bool computePoseIK(const robot_model::RobotModelConstPtr& robot_model,
                    const std::map<std::string, double>& seed,
                    std::map<std::string, double>& solution,
                    bool check_self_collision = true,
-                   const double timeout = 0.1);
+                   const double timeout = DEFAULT_IK_TIMEOUT,
+                   IKStatistics* ik_statistics = nullptr);
+
+/**
+ * @brief compute the inverse kinematics of a given pose using the given robot state for the computation
+ *
+ * Avoids the construction of a robot state per call, e.g. while sampling a trajectory. The seed is set in the state,
+ * all other joints keep their values. On success the state holds the solution.
+ * @param rstate: robot state used for the computation
+ * @param group_name: name of planning group
+ * @param link_name: name of target link
+ * @param pose: target pose in IK solver Frame
+ * @param frame_id: reference frame of the target pose
+ * @param seed: seed state of IK solver
+ * @param solution: solution of IK
+ * @param check_self_collision: true to enable self collision checking after IK computation
+ * @param timeout: timeout of the IK solver in seconds
+ * @param ik_statistics: optional, the cost of the call is added if given
+ * @return true if succeed
+ */
+bool computePoseIK(robot_state::RobotState& rstate,
+                   const std::string& group_name,
+                   const std::string& link_name,
+                   const Eigen::Isometry3d& pose,
+                   const std::string& frame_id,
+                   const std::map<std::string, double>& seed,
+                   std::map<std::string, double>& solution,
+                   bool check_self_collision = true,
+                   const double timeout = DEFAULT_IK_TIMEOUT,
+                   IKStatistics* ik_statistics = nullptr);
 
 /**
  * @brief compute the pose of a link at give robot state
@@ -80,6 +131,19 @@ bool computeLinkFK(const robot_model::RobotModelConstPtr& robot_model,
                    const std::map<std::string, double>& joint_state,
                    Eigen::Isometry3d& pose);
 
+/**
+ * @brief compute the pose of a link using the given robot state for the computation
+ * @param rstate: robot state used for the computation, the joint positions are set in the state
+ * @param link_name: target link name
+ * @param joint_state: joint positons of this group
+ * @param pose: pose of the link in base frame of robot model
+ * @return true if succeed
+ */
+bool computeLinkFK(robot_state::RobotState& rstate,
+                   const std::string& link_name,
+                   const std::map<std::string, double>& joint_state,
+                   Eigen::Isometry3d& pose);
+
 bool computeLinkFK(const robot_model::RobotModelConstPtr& robot_model,
                    const std::string& link_name,
                    const std::vector<std::string>& joint_names,
@@ -105,6 +169,62 @@ bool verifySampleJointLimits(const std::map<std::string, double>& position_last,
                              double duration_current,
                              const JointLimitsContainer &joint_limits);
 
+/**
+ * @brief verify the velocity/acceleration limits of current sample, see overload above.
+ *
+ * The joints are given by their variable index in the robot model, all vectors must have the same size
+ * and ordering as variable_indices.
+ * @param joint_limits: joint limits addressed by variable index
+ * @param variable_indices: variable indices of the joints
+ * @param joint_names: names of the joints, only used for error messages
+ * @param position_last: position of last sample
+ * @param velocity_last: velocity of last sample
+ * @param position_current: position of current sample
+ * @param duration_last: duration of last sample
+ * @param duration_current: duration of current sample
+ * @return
+ */
+bool verifySampleJointLimits(const JointLimitsTable& joint_limits,
+                             const std::vector<std::size_t>& variable_indices,
+                             const std::vector<std::string>& joint_names,
+                             const std::vector<double>& position_last,
+                             const std::vector<double>& velocity_last,
+                             const std::vector<double>& position_current,
+                             double duration_last,
+                             double duration_current);
+
+
+// Stages reported by TrajectoryGenerator::generate()
+static const std::string STAGE_REQUEST_VALIDATION = "validation";
+static const std::string STAGE_INFO_EXTRACTION = "info_extraction";
+static const std::string STAGE_GOAL_KINEMATICS = "goal_kinematics";
+static const std::string STAGE_PATH_SETUP = "path_setup";
+static const std::string STAGE_SAMPLING = "sampling";
+static const std::string STAGE_LIMIT_CHECKS = "limit_checks";
+static const std::string STAGE_SPLINE_FIT = "spline_fit";
+static const std::string STAGE_CONVERSION = "conversion";
+
+/**
+ * @brief Optional settings of generateJointTrajectory(), the pointers are not owned
+ */
+struct JointTrajectoryGenerationOptions
+{
+  /// Check the samples for self collision
+  bool check_self_collision {false};
+
+  /// Checked before each sample, the generation stops as soon as it is set
+  const std::atomic_bool* terminated {nullptr};
+
+  /// Reports STAGE_SAMPLING and STAGE_LIMIT_CHECKS if given
+  StageStopWatch* stop_watch {nullptr};
+
+  /// The cost of the inverse kinematics of all samples is added if given
+  IKStatistics* ik_statistics {nullptr};
+
+  /// State of the joints outside the group and attached bodies of all samples, the default values of the robot model
+  /// without attached bodies if not given
+  const robot_state::RobotState* start_state {nullptr};
+};
 
 /**
  * @brief Generate joint trajectory from a KDL Cartesian trajectory
@@ -117,8 +237,8 @@ bool verifySampleJointLimits(const std::map<std::string, double>& position_last,
  * @param sampling_time: sampling time of the generated trajectory
  * @param joint_trajectory: output as robot joint trajectory, first and last point will have zero velocity
  * and acceleration
- * @param error_code: detailed error information
- * @param check_self_collision: check for self collision during creation
+ * @param error_code: detailed error information, moveit_msgs::MoveItErrorCodes::PREEMPTED if terminated
+ * @param options: self collision check, termination, stage times, IK statistics and start state
  * @return true if succeed
  */
 bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
@@ -128,9 +248,9 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
                              const std::string& link_name,
                              const std::map<std::string, double>& initial_joint_position,
                              const double& sampling_time,
-                             trajectory_msgs::JointTrajectory& joint_trajectory,
+                             JointTrajectoryColumns& joint_trajectory,
                              moveit_msgs::MoveItErrorCodes& error_code,
-                             bool check_self_collision = false);
+                             const JointTrajectoryGenerationOptions& options = JointTrajectoryGenerationOptions());
 
 /**
  * @brief Generate joint trajectory from a MultiDOFJointTrajectory
@@ -138,7 +258,8 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
  * @param info: motion plan information
  * @param sampling_time
  * @param joint_trajectory
- * @param error_code
+ * @param error_code: moveit_msgs::MoveItErrorCodes::PREEMPTED if terminated
+ * @param options: self collision check, termination, stage times, IK statistics and start state
  * @return true if succeed
  */
 bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
@@ -148,9 +269,9 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
                              const std::string& link_name,
                              const std::map<std::string, double>& initial_joint_position,
                              const std::map<std::string, double>& initial_joint_velocity,
-                             trajectory_msgs::JointTrajectory& joint_trajectory,
+                             JointTrajectoryColumns& joint_trajectory,
                              moveit_msgs::MoveItErrorCodes& error_code,
-                             bool check_self_collision = false);
+                             const JointTrajectoryGenerationOptions& options = JointTrajectoryGenerationOptions());
 
 
 /**
@@ -164,6 +285,16 @@ bool determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectoryPtr& f
                                    double EPSILON,
                                    double& sampling_time);
 
+/**
+ * @brief Determines the sampling time of a single trajectory and checks that all its durations (except the last one)
+ * are equal to it.
+ * @param sampling_time: output, only valid if true is returned
+ * @return false if the trajectory has less than three points or is not uniformly sampled
+ */
+bool determineSamplingTime(const robot_trajectory::RobotTrajectory& trajectory,
+                           double epsilon,
+                           double& sampling_time);
+
 /**
  * @brief Deprecated, do not use this function signature anymore.
  *
@@ -189,6 +320,14 @@ bool isRobotStateEqual(const robot_state::RobotState& state1,
                        const std::string& joint_group_name,
                        double epsilon);
 
+/**
+ * @brief Estimates the memory held by the waypoints of a trajectory in bytes
+ *
+ * Counts per waypoint the robot state with its positions, velocities, accelerations and transforms (as allocated by
+ * robot_state::RobotState), the pointer to the state and the duration.
+ */
+std::size_t getTrajectoryMemoryBytes(const robot_trajectory::RobotTrajectory& trajectory);
+
 /**
  * @brief check if the robot state have zero velocity/acceleartion
  * @param state
@@ -223,8 +362,18 @@ bool intersectionFound(const Eigen::Vector3d &p_center,
                        const Eigen::Vector3d &p_next,
                        const double& r);
 
+/**
+ * @brief Returns the empty planning scene used for the self collision checks of the robot model
+ *
+ * The scene and its collision structures are created on the first call for a model and shared afterwards, as long as
+ * a returned pointer is held. The planner and the trajectory generators hold the scene of their model.
+ */
+planning_scene::PlanningSceneConstPtr getSelfCollisionScene(const moveit::core::RobotModelConstPtr& robot_model);
+
 /**
  * @brief Checks if current robot state is in self collision.
+ *
+ * The check uses the scene of getSelfCollisionScene().
  * @param test_for_self_collision Flag to deactivate this check during IK.
  * @param robot_model: robot kinematics model.
  * @param state Robot state instance used for .
@@ -237,6 +386,17 @@ bool isStateColliding(const bool test_for_self_collision,
                       robot_state::RobotState* state,
                       const robot_state::JointModelGroup * const group,
                       const double * const ik_solution);
+
+/**
+ * @brief Runs forward and inverse kinematics including the self collision check for all groups with an IK solver.
+ *
+ * The IK solvers and the scene of the self collision check, see getSelfCollisionScene(), are otherwise initialized
+ * lazily during the first planning request. The scene stays initialized only while the caller holds it.
+ * @param robot_model: robot kinematics model
+ * @param iterations: number of FK/IK round trips per group
+ * @return number of groups which were warmed up
+ */
+std::size_t warmUpKinematics(const moveit::core::RobotModelConstPtr &robot_model, std::size_t iterations);
 }
 
 void normalizeQuaternion(geometry_msgs::Quaternion & quat);
@@ -18,6 +18,8 @@
 #ifndef TRAJECTORYGENERATOR_H
 #define TRAJECTORYGENERATOR_H
 
+#include <atomic>
+
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/planning_interface/planning_interface.h>
 #include <Eigen/Geometry>
@@ -42,22 +44,57 @@ public:
   TrajectoryGenerator(const robot_model::RobotModelConstPtr& robot_model,
                       const pilz::LimitsContainer& planner_limits)
     :robot_model_(robot_model),
-      planner_limits_(planner_limits)
+      planner_limits_(planner_limits),
+      self_collision_scene_(getSelfCollisionScene(robot_model))
   {
   }
 
   virtual ~TrajectoryGenerator(){}
 
+  /// Sampling time of generate() if none is given, the planning contexts plan with it
+  static constexpr double DEFAULT_SAMPLING_TIME {0.1};
+
   /**
    * @brief generate robot trajectory with given sampling time
    * @param req: motion plan request
    * @param res: motion plan response
-   * @param sampling_time: sampling time of the generate trajectory (default 8ms)
+   * @param sampling_time: sampling time of the generate trajectory (default 100ms)
+   * @param stage_times: optional, the durations of the stages (see STAGE_* in trajectory_functions.h) are added
+   * if given
+   * @param ik_statistics: optional, the cost of the inverse kinematics of the trajectory is added if given
    * @return motion plan succeed/fail, detailed information in motion plan responce
    */
   virtual bool generate(const planning_interface::MotionPlanRequest& req,
                         planning_interface::MotionPlanResponse&  res,
-                        double sampling_time=0.008) = 0;
+                        double sampling_time=DEFAULT_SAMPLING_TIME,
+                        StageTimes* stage_times=nullptr,
+                        IKStatistics* ik_statistics=nullptr) = 0;
+
+  /**
+   * @brief Sets the flag which terminates a running generate()
+   *
+   * The flag is checked while sampling the trajectory. Once it is set, generate() stops and fails
+   * with moveit_msgs::MoveItErrorCodes::PREEMPTED.
+   * @param terminated: must outlive the generator, nullptr to disable termination
+   */
+  void setTerminationFlag(const std::atomic_bool* terminated)
+  {
+    terminated_ = terminated;
+  }
+
+  /**
+   * @brief Enables the spline output
+   *
+   * Instead of the uniform samples the trajectory only contains the knots of a piecewise quintic spline through the
+   * positions, velocities and accelerations of the knots, as interpolated by the
+   * ros_controllers::JointTrajectoryController. The spline deviates at most by the tolerance from the samples.
+   * Trajectories with spline output can not be blended.
+   * @param tolerance: largest deviation of the spline in every joint, 0 (default) for uniform samples
+   */
+  void setSplineTolerance(double tolerance)
+  {
+    spline_tolerance_ = tolerance;
+  }
 
 protected:
   /**
@@ -73,8 +110,31 @@ protected:
     std::map<std::string, double> start_joint_position;
     std::map<std::string, double> goal_joint_position;
     std::pair<std::string, Eigen::Vector3d> circ_path_point;
+    /// Start state of the request, parsed once and shared by all phases of the planning
+    robot_state::RobotStatePtr start_state;
+    /// Joint limits adapted to the start state, nullptr to plan with the static joint limits
+    std::shared_ptr<const JointLimitsContainer> start_state_joint_limits;
   };
 
+  /**
+   * @brief Parses the start state of the request including the attached bodies. Joints not given in the request keep
+   * their default values.
+   *
+   * Meant to be called once per request, see MotionPlanInfo::start_state.
+   */
+  robot_state::RobotStatePtr createStartState(const planning_interface::MotionPlanRequest& req) const;
+
+  /**
+   * @brief Sets MotionPlanInfo::start_state and, if the planner limits have a JointLimitsProvider, the joint limits
+   * adapted to it, e.g. to the attached payload
+   */
+  void setStartState(const planning_interface::MotionPlanRequest& req, MotionPlanInfo& info) const;
+
+  /**
+   * @brief Returns the joint limits to plan the request with, see setStartState()
+   */
+  const JointLimitsContainer& getJointLimits(const MotionPlanInfo& info) const;
+
   /**
    * @brief Validate the motion plan request based on the common requirements of trajectroy generator
    * Checks that:
@@ -133,11 +193,15 @@ protected:
    * @param req: motion plan request
    * @param info: information extracted from motion plan request which is necessary for the planning
    * @param error_code: MoveItErrorCodes which indicates the detailed error
+   * @param stop_watch: reports STAGE_INFO_EXTRACTION and STAGE_GOAL_KINEMATICS
+   * @param ik_statistics: optional, the cost of the inverse kinematics of the goal is added if given
    * @return: true if planning information is successfully extracted
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
                                      MotionPlanInfo& info,
-                                     moveit_msgs::MoveItErrorCodes& error_code) const = 0;
+                                     moveit_msgs::MoveItErrorCodes& error_code,
+                                     StageStopWatch& stop_watch,
+                                     IKStatistics* ik_statistics) const = 0;
 
   /**
    * @brief set MotionPlanResponse from joint trajectory
@@ -145,17 +209,32 @@ protected:
    * @param res: MotionPlanResponse
    * @param joint_trajectory
    * @param err_code
+   * @param start_state: start state of the request, parsed from the request if not given
    */
   bool setResponse(const planning_interface::MotionPlanRequest& req,
                    planning_interface::MotionPlanResponse& res,
-                   const trajectory_msgs::JointTrajectory& joint_trajectory,
+                   const JointTrajectoryColumns& joint_trajectory,
                    const moveit_msgs::MoveItErrorCodes& err_code,
-                   const ros::Time &planning_start) const;
+                   const ros::Time &planning_start,
+                   const robot_state::RobotStateConstPtr& start_state = nullptr) const;
+
+  /**
+   * @brief Reduces the samples to the knots of the spline output, does nothing if the spline output is disabled
+   *
+   * Reports STAGE_SPLINE_FIT if the spline output is enabled.
+   */
+  void fitSpline(JointTrajectoryColumns& joint_trajectory, StageStopWatch& stop_watch) const;
 
 
 protected:
   const robot_model::RobotModelConstPtr robot_model_;
   const pilz::LimitsContainer planner_limits_;
+  /// Keeps the shared scene of the self collision checks alive, see getSelfCollisionScene()
+  const planning_scene::PlanningSceneConstPtr self_collision_scene_;
+  /// Terminates a running generate() if set, not owned
+  const std::atomic_bool* terminated_ {nullptr};
+  /// Tolerance of the spline output, 0 for uniform samples
+  double spline_tolerance_ {0.};
   static constexpr double MIN_SCALING_FACTOR {0.0001};
   static constexpr double VELOCITY_TOLERANCE {1e-8};
 };
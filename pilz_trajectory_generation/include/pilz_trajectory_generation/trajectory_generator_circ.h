@@ -67,13 +67,17 @@ public:
    *   - trajectory/joint_trajectory/joint_names
    *   - trajectory/joint_trajectory/points/(positions, velocities, accelerations and time_from_start)
    *
-   * @param sampling_time: sampling time of the generate trajectory (default 8ms)
+   * @param sampling_time: sampling time of the generate trajectory (default 100ms)
+   * @param stage_times: optional, the durations of the stages are added if given
+   * @param ik_statistics: optional, the cost of the inverse kinematics is added if given
    *
    * @return motion plan succeed/fail, detailed information in motion plan responce/error_code
    */
   virtual bool generate(const planning_interface::MotionPlanRequest& req,
                         planning_interface::MotionPlanResponse& res,
-                        double sampling_time=0.1) override;
+                        double sampling_time=DEFAULT_SAMPLING_TIME,
+                        StageTimes* stage_times=nullptr,
+                        IKStatistics* ik_statistics=nullptr) override;
 
 private:
 
@@ -95,7 +99,9 @@ private:
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
                                      MotionPlanInfo &info,
-                                     moveit_msgs::MoveItErrorCodes &error_code) const final;
+                                     moveit_msgs::MoveItErrorCodes &error_code,
+                                     StageStopWatch& stop_watch,
+                                     IKStatistics* ik_statistics) const final;
 
   /**
    * @brief construct a KDL::Path object for a Cartesian path of an arc
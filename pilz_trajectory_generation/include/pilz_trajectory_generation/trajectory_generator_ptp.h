@@ -19,6 +19,8 @@
 #define TRAJECTORY_GENERATOR_PTP_H
 
 #include "eigen3/Eigen/Eigen"
+#include <map>
+#include <memory>
 #include "pilz_trajectory_generation/trajectory_generator.h"
 #include "pilz_trajectory_generation/velocity_profile_atrap.h"
 
@@ -26,6 +28,10 @@ namespace pilz {
 
 //TODO date type of units
 
+/// Most strict joint limit of each planning group with complete velocity, acceleration and deceleration limits
+typedef std::map<std::string, pilz_extensions::JointLimit> MostStrictLimits;
+typedef std::shared_ptr<const MostStrictLimits> MostStrictLimitsConstPtr;
+
 /**
  * @brief This class implements a point-to-point trajectory generator based on
  * VelocityProfile_ATrap.
@@ -35,11 +41,16 @@ class TrajectoryGeneratorPTP : public TrajectoryGenerator
 public:
   /**
    * @brief Constructor of PTP Trajectory Generator
-   * @throw TrajectoryGeneratorInvalidLimitsException
+   *
+   * Groups lacking limits do not make the constructor fail, planning for them fails instead.
+   * @throw TrajectoryGeneratorInvalidLimitsException if no joint limits are given
    * @param model: a map of joint limits information
+   * @param most_strict_limits: most strict limits of the groups computed by computeMostStrictLimits() from the
+   * model and the joint limits of planner_limits, shared between generators. Computed here if not given.
    */
   TrajectoryGeneratorPTP(const robot_model::RobotModelConstPtr& robot_model,
-                         const pilz::LimitsContainer& planner_limits);
+                         const pilz::LimitsContainer& planner_limits,
+                         const MostStrictLimitsConstPtr& most_strict_limits = nullptr);
 
   ~TrajectoryGeneratorPTP();
 
@@ -64,13 +75,28 @@ public:
    *   - planning_time
    *   - error_code/val
    *
-   * @param sampling_time: sampling time of the generate trajectory (default 8ms)
+   * @param sampling_time: sampling time of the generate trajectory (default 100ms)
+   * @param stage_times: optional, the durations of the stages are added if given
+   * @param ik_statistics: optional, the cost of the inverse kinematics is added if given
    *
    * @return motion plan succeed/fail, detailed information in motion plan responce/error_code
    */
   virtual bool generate(const planning_interface::MotionPlanRequest& req,
                         planning_interface::MotionPlanResponse&  res,
-                        double sampling_time=0.1) override;
+                        double sampling_time=DEFAULT_SAMPLING_TIME,
+                        StageTimes* stage_times=nullptr,
+                        IKStatistics* ik_statistics=nullptr) override;
+
+  /**
+   * @brief Compute the most strict joint limit of every planning group of the model
+   *
+   * Groups lacking velocity, acceleration or deceleration limits are left out.
+   * @param robot_model
+   * @param joint_limits
+   * @return immutable limits to be shared by all generators planning with the model and the joint limits
+   */
+  static MostStrictLimitsConstPtr computeMostStrictLimits(const robot_model::RobotModelConstPtr& robot_model,
+                                                          const JointLimitsContainer& joint_limits);
 
 private:
 
@@ -84,31 +110,63 @@ private:
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
                                      MotionPlanInfo& info,
-                                     moveit_msgs::MoveItErrorCodes& error_code) const override;
+                                     moveit_msgs::MoveItErrorCodes& error_code,
+                                     StageStopWatch& stop_watch,
+                                     IKStatistics* ik_statistics) const override;
 
   /**
    * @brief plan ptp joint trajectory with zero start velocity
    * @param start_pos
    * @param goal_pos
    * @param joint_trajectory
-   * @param group_name
+   * @param most_strict_limit most strict joint limit of the planning group
    * @param velocity_scaling_factor
    * @param acceleration_scaling_factor
    * @param sampling_time
+   * @return false if the planning was terminated, see TrajectoryGenerator::setTerminationFlag()
    */
-  void planPTP(const std::map<std::string, double>& start_pos,
+  bool planPTP(const std::map<std::string, double>& start_pos,
                const std::map<std::string, double>& goal_pos,
-               trajectory_msgs::JointTrajectory& joint_trajectory,
-               const std::string &group_name,
+               JointTrajectoryColumns& joint_trajectory,
+               const pilz_extensions::JointLimit& most_strict_limit,
                const double& velocity_scaling_factor,
                const double& acceleration_scaling_factor,
                const double& sampling_time);
 
+  /**
+   * @brief Return the sample times of the spline output of a synchronized profile
+   *
+   * The knots are placed inside the phases of the profile, the transitions between the phases take
+   * SPLINE_TRANSITION_TIME. Apart from the transitions the spline is exact.
+   * @param acc_time, const_time, dec_time: durations of the phases of the leading axis
+   * @return strictly increasing times from 0 to the duration of the profile
+   */
+  static std::vector<double> getSplineKnotTimes(double acc_time, double const_time, double dec_time);
+
+  /**
+   * @brief Return the most strict joint limit of the planning group of the request.
+   *
+   * The shared limits are used unless the joint limits are adapted to the start state, see setStartState().
+   * @throw TrajectoryGeneratorInvalidLimitsException if the group lacks velocity, acceleration or deceleration limits
+   * @param info: planning information of the request
+   * @return most strict joint limit of the group
+   */
+  pilz_extensions::JointLimit getMostStrictLimit(const MotionPlanInfo& info) const;
+
+  /**
+   * @brief Compute the most strict joint limit of a single planning group
+   * @throw TrajectoryGeneratorInvalidLimitsException if the group lacks velocity, acceleration or deceleration limits
+   */
+  static pilz_extensions::JointLimit computeMostStrictLimit(const robot_model::RobotModelConstPtr& robot_model,
+                                                            const JointLimitsContainer& joint_limits,
+                                                            const std::string& group_name);
+
 private:
   const double MIN_MOVEMENT = 0.001;
-  pilz::JointLimitsContainer joint_limits_;
-  // most strict joint limits for each group
-  std::map<std::string, pilz_extensions::JointLimit> most_strict_limits_;
+  /// Duration of the spline segments connecting the phases of the profile, in seconds
+  static constexpr double SPLINE_TRANSITION_TIME {0.001};
+  // most strict joint limits for each group, shared with the other generators of the model
+  const MostStrictLimitsConstPtr most_strict_limits_;
 };
 
 }
@@ -31,8 +31,10 @@ class TrajectoryMerger
 public:
     /**
      * @brief Merge trajectory into current result trajectory.
+     *
+     * The waypoints of the source may be shared with the result instead of being copied.
      */
-    virtual void merge(robot_trajectory::RobotTrajectory &result, const robot_trajectory::RobotTrajectory &source) = 0;
+    virtual void merge(robot_trajectory::RobotTrajectory &result, robot_trajectory::RobotTrajectory &source) = 0;
 };
 
 }  // namespace pilz_trajectory_generation
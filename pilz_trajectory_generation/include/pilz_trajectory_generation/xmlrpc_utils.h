@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef XMLRPC_UTILS_H
+#define XMLRPC_UTILS_H
+
+#include <string>
+
+#include <ros/ros.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Fetches all parameters in the namespace of the node handle with a single request to the parameter server
+ * @return the parameters as struct, an empty struct if the namespace does not exist
+ */
+inline XmlRpc::XmlRpcValue getParamNamespace(const ros::NodeHandle& nh)
+{
+  XmlRpc::XmlRpcValue params;
+  if(!nh.getParam(nh.getNamespace(), params) || params.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    params = XmlRpc::XmlRpcValue();
+    params.begin(); // turns the value into an empty struct
+  }
+  return params;
+}
+
+/**
+ * @brief Returns the member of a struct
+ * @return pointer to the member, nullptr if value is no struct or has no such member
+ */
+inline XmlRpc::XmlRpcValue* getXmlRpcMember(XmlRpc::XmlRpcValue& value, const std::string& name)
+{
+  if(value.getType() != XmlRpc::XmlRpcValue::TypeStruct || !value.hasMember(name))
+  {
+    return nullptr;
+  }
+  return &value[name];
+}
+
+/**
+ * @brief Reads a boolean member of a struct, same semantics as ros::NodeHandle::getParam()
+ * @return true if the member exists and is a boolean
+ */
+inline bool getXmlRpcBool(XmlRpc::XmlRpcValue& value, const std::string& name, bool& result)
+{
+  XmlRpc::XmlRpcValue* member {getXmlRpcMember(value, name)};
+  if(!member || member->getType() != XmlRpc::XmlRpcValue::TypeBoolean)
+  {
+    return false;
+  }
+  result = static_cast<bool>(*member);
+  return true;
+}
+
+/**
+ * @brief Reads a floating point member of a struct, integers are converted like ros::NodeHandle::getParam() does
+ * @return true if the member exists and is a number
+ */
+inline bool getXmlRpcDouble(XmlRpc::XmlRpcValue& value, const std::string& name, double& result)
+{
+  XmlRpc::XmlRpcValue* member {getXmlRpcMember(value, name)};
+  if(!member)
+  {
+    return false;
+  }
+  if(member->getType() == XmlRpc::XmlRpcValue::TypeDouble)
+  {
+    result = static_cast<double>(*member);
+    return true;
+  }
+  if(member->getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    result = static_cast<int>(*member);
+    return true;
+  }
+  return false;
+}
+
+}
+
+#endif // XMLRPC_UTILS_H
@@ -18,6 +18,7 @@
 #include "ros/ros.h"
 
 #include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/xmlrpc_utils.h"
 
 static const std::string param_cartesian_limits_ns = "cartesian_limits";
 
@@ -30,43 +31,51 @@ static const std::string param_max_rot_dec = "max_rot_dec";
 
 pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(const ros::NodeHandle& nh)
 {
+  return getAggregatedLimits(getParamNamespace(nh));
+}
 
-  std::string param_prefix = param_cartesian_limits_ns + "/";
-
+pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(XmlRpc::XmlRpcValue params)
+{
   pilz::CartesianLimit cartesian_limit;
 
+  XmlRpc::XmlRpcValue* limit_params {getXmlRpcMember(params, param_cartesian_limits_ns)};
+  if(!limit_params)
+  {
+    return cartesian_limit;
+  }
+
   // translational velocity
   double max_trans_vel;
-  if(nh.getParam(param_prefix + param_max_trans_vel, max_trans_vel))
+  if(getXmlRpcDouble(*limit_params, param_max_trans_vel, max_trans_vel))
   {
     cartesian_limit.setMaxTranslationalVelocity(max_trans_vel);
   }
 
   // translational acceleration
   double max_trans_acc;
-  if(nh.getParam(param_prefix + param_max_trans_acc, max_trans_acc))
+  if(getXmlRpcDouble(*limit_params, param_max_trans_acc, max_trans_acc))
   {
     cartesian_limit.setMaxTranslationalAcceleration(max_trans_acc);
   }
 
   // translational deceleration
   double max_trans_dec;
-  if(nh.getParam(param_prefix + param_max_trans_dec, max_trans_dec))
+  if(getXmlRpcDouble(*limit_params, param_max_trans_dec, max_trans_dec))
   {
     cartesian_limit.setMaxTranslationalDeceleration(max_trans_dec);
   }
 
   // rotational velocity
   double max_rot_vel;
-  if(nh.getParam(param_prefix + param_max_rot_vel, max_rot_vel))
+  if(getXmlRpcDouble(*limit_params, param_max_rot_vel, max_rot_vel))
   {
     cartesian_limit.setMaxRotationalVelocity(max_rot_vel);
   }
 
   // rotational acceleration + deceleration deprecated
   // LCOV_EXCL_START
-  if(nh.hasParam(param_prefix + param_max_rot_acc)
-     || nh.hasParam(param_prefix + param_max_rot_dec))
+  if(getXmlRpcMember(*limit_params, param_max_rot_acc)
+     || getXmlRpcMember(*limit_params, param_max_rot_dec))
   {
     ROS_WARN_STREAM("Ignoring cartesian limits parameters for rotational acceleration / deceleration;"
                     << "these parameters are deprecated and are automatically calculated from"
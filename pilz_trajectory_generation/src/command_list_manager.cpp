@@ -17,48 +17,316 @@
 
 #include "pilz_trajectory_generation/command_list_manager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
 #include <ros/ros.h>
-#include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/robot_state/conversions.h>
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
 #include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/xmlrpc_utils.h"
 #include "pilz_trajectory_generation/trajectory_blender_transition_window.h"
 #include "pilz_trajectory_generation/trajectory_blend_request.h"
+#include "pilz_trajectory_generation/capability_names.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
 
 namespace pilz_trajectory_generation {
 
 static const std::string PARAM_NAMESPACE_LIMTS = "robot_description_planning";
 static const double point_identity_threshold=10e-5;
+static const std::string PARAM_TRACE_BUFFER_SIZE = "trace_buffer_size";
+static const std::string PARAM_TRACE_FILE = "trace_file";
+static const std::string PARAM_TRACE_DUMP_INTERVAL = "trace_dump_interval";
+static const std::string DEFAULT_TRACE_FILE = "pilz_planning_trace.json";
+static const std::string PARAM_RECORD_FILE = "record_file";
+static const std::string PARAM_DECIMATION_TOLERANCE = "decimation_tolerance";
+static const std::string PARAM_DECIMATION_INTERPOLATION = "decimation_interpolation";
+static const std::string DEFAULT_DECIMATION_INTERPOLATION = "quintic";
+static const std::string PARAM_MEASURE_HEAP_PEAK = "measure_heap_peak";
+/// Allowed deviation of the durations from the sampling time, the same as checked by the blender
+static const double SAMPLING_TIME_EPSILON = 1e-4;
 
 //CTOR
 CommandListManager::CommandListManager(const ros::NodeHandle &nh, const moveit::core::RobotModelConstPtr &model):
   nh_(nh),
   model_(model)
 {
+  blender_ = createBlender();
+
+  planning_pipeline_.reset(new planning_pipeline::PlanningPipeline(model_, nh_));
+  disableSplineOutput();
+  readPlannerSamplingTime();
+
+  reload_limits_subscriber_ = nh_.subscribe(RELOAD_LIMITS_TOPIC_NAME, 1,
+                                            &CommandListManager::reloadLimitsCallback, this);
+
+  setupTracing();
+  setupRecording();
+  setupDecimation();
+  nh_.param(PARAM_MEASURE_HEAP_PEAK, measure_heap_peak_, false);
+}
+
+void CommandListManager::disableSplineOutput()
+{
+  const planning_interface::PlannerManagerPtr& planner {planning_pipeline_->getPlannerManager()};
+  if(!planner)
+  {
+    return;
+  }
+
+  // the sequence result is decimated as a whole instead, see setupDecimation()
+  planning_interface::PlannerConfigurationMap configurations {planner->getPlannerConfigurations()};
+  planning_interface::PlannerConfigurationSettings& settings {configurations[SPLINE_OUTPUT_CONFIGURATION_NAME]};
+  settings.name = SPLINE_OUTPUT_CONFIGURATION_NAME;
+  settings.config[SPLINE_OUTPUT_TOLERANCE_PARAM_NAME] = "0";
+  planner->setPlannerConfigurations(configurations);
+}
+
+void CommandListManager::readPlannerSamplingTime()
+{
+  planner_sampling_time_ = 0.;
+  const planning_interface::PlannerManagerPtr& planner {planning_pipeline_->getPlannerManager()};
+  // request adapters may change the timing of the trajectories after the planner
+  if(!planner || !planning_pipeline_->getAdapterPluginNames().empty())
+  {
+    return;
+  }
+
+  const planning_interface::PlannerConfigurationMap& configurations {planner->getPlannerConfigurations()};
+  const auto settings = configurations.find(SPLINE_OUTPUT_CONFIGURATION_NAME);
+  if(settings == configurations.end())
+  {
+    return;
+  }
+  const auto sampling_time = settings->second.config.find(SAMPLING_TIME_PARAM_NAME);
+  if(sampling_time == settings->second.config.end())
+  {
+    return;
+  }
+
+  try
+  {
+    planner_sampling_time_ = std::max(0., std::stod(sampling_time->second));
+  }
+  catch(const std::logic_error&)
+  {
+    ROS_WARN_STREAM("Invalid " << SAMPLING_TIME_PARAM_NAME << " \"" << sampling_time->second
+                    << "\" reported by the planner, the sampling of the trajectories is checked on each blend.");
+  }
+}
+
+void CommandListManager::setupDecimation()
+{
+  double tolerance {0.};
+  std::string interpolation_name;
+  nh_.param(PARAM_DECIMATION_TOLERANCE, tolerance, 0.);
+  nh_.param(PARAM_DECIMATION_INTERPOLATION, interpolation_name, DEFAULT_DECIMATION_INTERPOLATION);
+  if(tolerance <= 0.)
+  {
+    return;
+  }
+
+  pilz::TrajectoryDecimator::Interpolation interpolation;
+  if(!pilz::TrajectoryDecimator::parseInterpolation(interpolation_name, interpolation))
+  {
+    ROS_ERROR_STREAM("Unknown decimation interpolation \"" << interpolation_name
+                     << "\" (expected \"cubic\" or \"quintic\"), the sequences are not decimated.");
+    return;
+  }
+
+  decimator_.reset(new pilz::TrajectoryDecimator(tolerance, interpolation));
+  ROS_INFO_STREAM("Decimating the planned sequences with a tolerance of " << tolerance << " for a "
+                  << interpolation_name << " interpolation");
+}
+
+void CommandListManager::decimateTrajectory(robot_trajectory::RobotTrajectory& trajectory,
+                                            pilz::StageStopWatch& stop_watch,
+                                            pilz::DecimationStatistics* decimation) const
+{
+  pilz::DecimationStatistics statistics;
+  statistics.input_points = statistics.output_points = trajectory.getWayPointCount();
+  if(decimator_)
+  {
+    statistics = decimator_->decimate(trajectory);
+    stop_watch.lap(STAGE_DECIMATION);
+    ROS_DEBUG_STREAM("Decimated the sequence from " << statistics.input_points << " to " << statistics.output_points
+                     << " waypoints (compression ratio " << statistics.getCompressionRatio() << ")");
+  }
+  if(decimation)
+  {
+    *decimation = statistics;
+  }
+}
+
+void CommandListManager::setupRecording()
+{
+  std::string record_file;
+  nh_.param(PARAM_RECORD_FILE, record_file, std::string());
+  if(record_file.empty())
+  {
+    return;
+  }
+
+  try
+  {
+    recorder_ = SequenceRecorder::getSharedRecorder(record_file);
+    ROS_INFO_STREAM("Recording the planned sequences to " << record_file);
+  }
+  catch(const rosbag::BagException& ex)
+  {
+    ROS_ERROR_STREAM("Failed to open the record file, the sequences are not recorded: " << ex.what());
+  }
+}
+
+void CommandListManager::recordSequence(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                        const pilz_msgs::MotionSequenceRequest& req_list,
+                                        const planning_interface::MotionPlanResponse& res,
+                                        double planning_time)
+{
+  // The scene of the planning scene monitor is modified in place after the planning, the copy shares the
+  // collision objects and the model, the messages are only created by the writer thread
+  PlannedSequence sequence;
+  if(planning_scene)
+  {
+    sequence.planning_scene = planning_scene::PlanningScene::clone(planning_scene);
+  }
+  sequence.request = req_list;
+  sequence.response = res;
+  sequence.response.planning_time_ = planning_time;
+  recorder_->record(std::move(sequence));
+}
+
+void CommandListManager::setupTracing()
+{
+  int buffer_size {0};
+  int dump_interval {0};
+  nh_.param(PARAM_TRACE_BUFFER_SIZE, buffer_size, 0);
+  nh_.param(PARAM_TRACE_FILE, trace_file_, DEFAULT_TRACE_FILE);
+  nh_.param(PARAM_TRACE_DUMP_INTERVAL, dump_interval, 0);
+
+  if(buffer_size <= 0)
+  {
+    return;
+  }
+
+  trace_dump_interval_ = static_cast<std::size_t>(std::max(dump_interval, 0));
+  pilz::TraceRecorder::instance().enable(static_cast<std::size_t>(buffer_size));
+  dump_trace_subscriber_ = nh_.subscribe(DUMP_TRACE_TOPIC_NAME, 1, &CommandListManager::dumpTraceCallback, this);
+  ROS_INFO_STREAM("Tracing of the planning enabled, the trace is written to " << trace_file_);
+}
+
+void CommandListManager::dumpTraceCallback(const std_msgs::Empty::ConstPtr& /*msg*/)
+{
+  pilz::TraceRecorder::instance().writeChromeTrace(trace_file_);
+}
+
+std::shared_ptr<pilz::TrajectoryBlender> CommandListManager::createBlender() const
+{
+  // Fetch all parameters at once instead of querying the parameter server per joint
+  const XmlRpc::XmlRpcValue params {pilz::getParamNamespace(ros::NodeHandle(PARAM_NAMESPACE_LIMTS))};
+
   // Obtain the aggregated joint limits
   pilz::JointLimitsContainer aggregated_limit_active_joints;
 
   aggregated_limit_active_joints = pilz::JointLimitsAggregator::getAggregatedLimits(
-          ros::NodeHandle(PARAM_NAMESPACE_LIMTS),model_->getActiveJointModels());
+          params, model_->getActiveJointModels());
 
 
   // Obtain cartesian limits
-  pilz::CartesianLimit cartesian_limit = pilz::CartesianLimitsAggregator::getAggregatedLimits(ros::NodeHandle(PARAM_NAMESPACE_LIMTS));
+  pilz::CartesianLimit cartesian_limit = pilz::CartesianLimitsAggregator::getAggregatedLimits(params);
 
   pilz::LimitsContainer limits;
   limits.setJointLimits(aggregated_limit_active_joints);
   limits.setCartesianLimits(cartesian_limit);
 
   // Currently using Lloyed blender
-  std::unique_ptr<pilz::TrajectoryBlender> blender(new pilz::TrajectoryBlenderTransitionWindow(limits));
-  blender_ = std::move(blender);
+  return std::make_shared<pilz::TrajectoryBlenderTransitionWindow>(limits);
+}
+
+bool CommandListManager::reloadLimits()
+{
+  std::lock_guard<std::mutex> lock(reload_mutex_);
+
+  std::shared_ptr<pilz::TrajectoryBlender> blender;
+  try
+  {
+    blender = createBlender();
+  }
+  catch(const pilz::AggregationException& ex)
+  {
+    ROS_ERROR_STREAM("Failed to reload the blending limits, keeping the previous limits: " << ex.what());
+    return false;
+  }
+
+  // Sequences being solved hold their own reference to the previous blender
+  std::atomic_store(&blender_, blender);
+  ROS_INFO("Reloaded the blending limits.");
+  return true;
+}
+
+void CommandListManager::reloadLimitsCallback(const std_msgs::Empty::ConstPtr& /*msg*/)
+{
+  reloadLimits();
+}
+
+void CommandListManager::terminate()
+{
+  ROS_DEBUG("Terminate called");
+  terminated_ = true;
+  planning_pipeline_->terminate();
+}
+
+void CommandListManager::resetTermination()
+{
+  terminated_ = false;
 }
 
 bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                const pilz_msgs::MotionSequenceRequest &req_list,
-                               planning_interface::MotionPlanResponse& res)
+                               planning_interface::MotionPlanResponse& res,
+                               pilz::StageTimes* stage_times,
+                               pilz::ResourceUsage* resource_usage,
+                               pilz::DecimationStatistics* decimation)
+{
+  const std::chrono::steady_clock::time_point start {std::chrono::steady_clock::now()};
+  bool result;
+  {
+    pilz::TraceSpan span("CommandListManager::solve");
+    pilz::ScopedPlanMetrics metrics(pilz::PlanningMetricsSnapshot::SEQUENCE, res);
+    pilz::ResourceMeter resource_meter(resource_usage, measure_heap_peak_);
+    result = solveSequence(planning_scene, req_list, res, stage_times, resource_meter, decimation);
+  }
+  // a terminate() arriving before solveSequence() aborted it, it must not abort the next solve()
+  resetTermination();
+
+  if(recorder_)
+  {
+    recordSequence(planning_scene, req_list, res,
+                   std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  if(trace_dump_interval_ > 0 && ++solves_since_dump_ >= trace_dump_interval_)
+  {
+    solves_since_dump_ = 0;
+    pilz::TraceRecorder::instance().writeChromeTrace(trace_file_);
+  }
+  return result;
+}
+
+bool CommandListManager::solveSequence(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                       const pilz_msgs::MotionSequenceRequest &req_list,
+                                       planning_interface::MotionPlanResponse& res,
+                                       pilz::StageTimes* stage_times,
+                                       pilz::ResourceMeter& resource_meter,
+                                       pilz::DecimationStatistics* decimation)
 {
+  pilz::StageStopWatch stop_watch(stage_times, &resource_meter);
+
   //*****************************
   // Validations
   //*****************************
@@ -71,7 +339,9 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
     return true;
   }
 
-  if(!validateRequestList(req_list, res))
+  const bool valid_request_list {validateRequestList(req_list, res)};
+  stop_watch.lap(STAGE_VALIDATION);
+  if(!valid_request_list)
   {
     return false;
   }
@@ -82,9 +352,12 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
 
   // Collect the responses
   std::vector<planning_interface::MotionPlanResponse> motion_plan_responses;
+  std::vector<double> sampling_times;
   std::vector<double> radii;
 
-  if(!solveRequests(planning_scene, req_list, res, motion_plan_responses, radii))
+  const bool solved {solveRequests(planning_scene, req_list, res, motion_plan_responses, sampling_times, radii)};
+  stop_watch.lap(STAGE_PLANNING);
+  if(!solved)
   {
     return false;
   }
@@ -95,7 +368,9 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
 
   const auto group_name = req_list.items.front().req.group_name;
 
-  if(!validateBlendingRadiiDoNotOverlap(motion_plan_responses, radii, group_name))
+  const bool radii_valid {validateBlendingRadiiDoNotOverlap(motion_plan_responses, radii, group_name)};
+  stop_watch.lap(STAGE_RADIUS_VALIDATION);
+  if(!radii_valid)
   {
     res.trajectory_.reset(new robot_trajectory::RobotTrajectory(model_, 0));
     res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
@@ -115,15 +390,17 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
   if(req_list.items.size() == 1)
   {
     res.trajectory_ = motion_plan_responses[0].trajectory_;
+    decimateTrajectory(*res.trajectory_, stop_watch, decimation);
     res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
 
     return true;
   }
 
-  if(!generateTrajectory(motion_plan_responses, radii, result_trajectory, res))
+  if(!generateTrajectory(motion_plan_responses, sampling_times, radii, result_trajectory, res, stop_watch))
   {
     return false;
   }
+  decimateTrajectory(*result_trajectory, stop_watch, decimation);
 
   //*****************************
   // Create the response
@@ -217,15 +494,21 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
                                        const pilz_msgs::MotionSequenceRequest &req_list,
                                        planning_interface::MotionPlanResponse &res,
                                        std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+                                       std::vector<double> &sampling_times,
                                        std::vector<double> &radii)
 {
-  // Obtain the planning pipeline
-  planning_pipeline::PlanningPipelinePtr planning_pipeline(new planning_pipeline::PlanningPipeline(model_, nh_));
-
   for(auto req_it = req_list.items.begin(); req_it < req_list.items.end(); req_it++)
   {
     size_t idx = std::distance(req_list.items.begin(), req_it);
 
+    if(terminated_)
+    {
+      ROS_INFO("Solving the sequence was terminated.");
+      res.trajectory_.reset(new robot_trajectory::RobotTrajectory(model_, 0));
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      return false;
+    }
+
     planning_interface::MotionPlanRequest req = req_it->req;
     planning_interface::MotionPlanResponse plan_res;
 
@@ -236,7 +519,10 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
                                               req.start_state);
     }
 
-    planning_pipeline->generatePlan(planning_scene, req, plan_res);
+    {
+      pilz::TraceSpan span("PlanningPipeline::generatePlan");
+      planning_pipeline_->generatePlan(planning_scene, req, plan_res);
+    }
     /* Check that the planning was successful */
     if (plan_res.error_code_.val != plan_res.error_code_.SUCCESS)
     {
@@ -249,7 +535,25 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
 
     ROS_DEBUG_STREAM("Solved [" << idx+1 << "/" << req_list.items.size() << "]");
 
+    // The blender trusts the sampling time instead of checking the waypoints on each blend. The planner reports it,
+    // only the trajectories of other planners are checked once here.
+    double sampling_time {0.};
+    const bool blended {req_it->blend_radius > 0. || (!radii.empty() && radii.back() > 0.)};
+    if(blended && planner_sampling_time_ > 0.)
+    {
+      // like determineSamplingTime(), which needs at least one interval besides the last one
+      if(plan_res.trajectory_->getWayPointCount() >= 3)
+      {
+        sampling_time = planner_sampling_time_;
+      }
+    }
+    else if(blended && !pilz::determineSamplingTime(*plan_res.trajectory_, SAMPLING_TIME_EPSILON, sampling_time))
+    {
+      sampling_time = 0.;
+    }
+
     motion_plan_responses.push_back(plan_res);
+    sampling_times.push_back(sampling_time);
     radii.push_back(req_it->blend_radius);
   }
 
@@ -258,16 +562,23 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
 
 bool CommandListManager::generateTrajectory(
                                const std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+                               const std::vector<double> &sampling_times,
                                const std::vector<double> &radii,
                                robot_trajectory::RobotTrajectoryPtr& result_trajectory,
-                               planning_interface::MotionPlanResponse &res)
+                               planning_interface::MotionPlanResponse &res,
+                               pilz::StageStopWatch& stop_watch)
 {
+  // use the same limits for all blends of this sequence
+  const std::shared_ptr<pilz::TrajectoryBlender> blender {std::atomic_load(&blender_)};
+
   // prefill the first_trajectory for the next blending request
   auto first_trajectory = motion_plan_responses.front().trajectory_;
+  double first_sampling_time = sampling_times.front();
 
   for(size_t i = 0; i < motion_plan_responses.size()-1; i++)
   {
     auto traj_2 = motion_plan_responses.at(i+1).trajectory_;
+    const double sampling_time_2 = sampling_times.at(i+1);
     auto blend_radius = radii.at(i);
 
     // No blending is needed if the radius is 0.0
@@ -283,31 +594,56 @@ bool CommandListManager::generateTrajectory(
       blend_request.blend_radius = blend_radius;
       blend_request.group_name = first_trajectory->getGroupName();
       blend_request.link_name = model_->getJointModelGroup(blend_request.group_name)->getSolverInstance()->getTipFrame();
+      blend_request.terminated = &terminated_;
+
+      // Only pass the sampling time if both trajectories agree on it, otherwise the blender checks the waypoints
+      if(first_sampling_time > 0. && std::fabs(first_sampling_time - sampling_time_2) <= SAMPLING_TIME_EPSILON)
+      {
+        blend_request.sampling_time = first_sampling_time;
+      }
 
       // The response
       pilz::TrajectoryBlendResponse blend_response;
-      if (!blender_->blend(blend_request, blend_response))
+      const bool blended {blender->blend(blend_request, blend_response)};
+      stop_watch.lap(STAGE_BLENDING);
+      if (!blended)
       {
-        ROS_ERROR("Blending failed.");
         res.trajectory_.reset(new robot_trajectory::RobotTrajectory(model_, 0));
+        if(blend_response.error_code.val == moveit_msgs::MoveItErrorCodes::PREEMPTED)
+        {
+          ROS_INFO("Blending was terminated.");
+          res.error_code_.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+          return false;
+        }
+        ROS_ERROR("Blending failed.");
         res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
         return false;
       }
 
       // Append the new trajectory
+      pilz::TraceSpan span("CommandListManager::merge");
       result_trajectory->append(*blend_response.first_trajectory, 0.0);
       result_trajectory->append(*blend_response.blend_trajectory, 0.0);
       first_trajectory = blend_response.second_trajectory; // first for next blending segment
+      first_sampling_time = sampling_time_2; // the rest of the second trajectory keeps its sampling
+      stop_watch.lap(STAGE_MERGING);
     }
     // if blend radius == 0.0
     else
     {
+      pilz::TraceSpan span("CommandListManager::merge");
       appender_.merge(*result_trajectory, *first_trajectory);
       first_trajectory = traj_2;
+      first_sampling_time = sampling_time_2;
+      stop_watch.lap(STAGE_MERGING);
     }
   }
 
-  appender_.merge(*result_trajectory, *first_trajectory); // append tail
+  {
+    pilz::TraceSpan span("CommandListManager::merge");
+    appender_.merge(*result_trajectory, *first_trajectory); // append tail
+  }
+  stop_watch.lap(STAGE_MERGING);
   return true;
 }
 
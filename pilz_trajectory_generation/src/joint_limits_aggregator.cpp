@@ -16,8 +16,8 @@
  */
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
-
-#include "pilz_extensions/joint_limits_interface_extension.h"
+#include "pilz_trajectory_generation/payload_joint_limits_provider.h"
+#include "pilz_trajectory_generation/xmlrpc_utils.h"
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/robot_model/robot_model.h>
@@ -26,12 +26,97 @@
 
 using namespace pilz_extensions;
 
+namespace
+{
+
+/**
+ * @brief Reads one limit type, same semantics as joint_limits_interface::getJointLimits()
+ *
+ * The limit is only changed if has_<type>_limits is set. If it is false the limit is removed.
+ */
+void readLimit(XmlRpc::XmlRpcValue& joint_params, const std::string& type, const std::string& value_name,
+               bool& has_limit, double& value)
+{
+  bool has_param_limit {false};
+  if(pilz::getXmlRpcBool(joint_params, "has_" + type + "_limits", has_param_limit))
+  {
+    if(!has_param_limit)
+    {
+      has_limit = false;
+    }
+    double param_value;
+    if(has_param_limit && pilz::getXmlRpcDouble(joint_params, value_name, param_value))
+    {
+      has_limit = true;
+      value = param_value;
+    }
+  }
+}
+
+/**
+ * @brief Reads the limits of a joint from the prefetched joint_limits parameters,
+ * same semantics as pilz_extensions::joint_limits_interface::getJointLimits()
+ * @return true if there are parameters for the joint
+ */
+bool getJointLimits(XmlRpc::XmlRpcValue& joint_limits_params, const std::string& joint_name, JointLimit& limits)
+{
+  XmlRpc::XmlRpcValue* joint_params {pilz::getXmlRpcMember(joint_limits_params, joint_name)};
+  if(!joint_params)
+  {
+    ROS_DEBUG_STREAM("No joint limits specification found for joint '" << joint_name << "'.");
+    return false;
+  }
+
+  // Position limits
+  bool has_position_limits {false};
+  if(pilz::getXmlRpcBool(*joint_params, "has_position_limits", has_position_limits))
+  {
+    if(!has_position_limits)
+    {
+      limits.has_position_limits = false;
+    }
+    double min_pos, max_pos;
+    if(has_position_limits && pilz::getXmlRpcDouble(*joint_params, "min_position", min_pos)
+       && pilz::getXmlRpcDouble(*joint_params, "max_position", max_pos))
+    {
+      limits.has_position_limits = true;
+      limits.min_position = min_pos;
+      limits.max_position = max_pos;
+    }
+    bool angle_wraparound;
+    if(!has_position_limits && pilz::getXmlRpcBool(*joint_params, "angle_wraparound", angle_wraparound))
+    {
+      limits.angle_wraparound = angle_wraparound;
+    }
+  }
+
+  readLimit(*joint_params, "velocity", "max_velocity", limits.has_velocity_limits, limits.max_velocity);
+  readLimit(*joint_params, "acceleration", "max_acceleration", limits.has_acceleration_limits,
+            limits.max_acceleration);
+  readLimit(*joint_params, "jerk", "max_jerk", limits.has_jerk_limits, limits.max_jerk);
+  readLimit(*joint_params, "effort", "max_effort", limits.has_effort_limits, limits.max_effort);
+  readLimit(*joint_params, "deceleration", "max_deceleration", limits.has_deceleration_limits,
+            limits.max_deceleration);
+
+  return true;
+}
+
+}
+
 pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(const ros::NodeHandle& nh,
                                                              const std::vector<const moveit::core::JointModel*>& joint_models)
+{
+  ROS_INFO_STREAM("Reading limits from namespace " << nh.getNamespace());
+  return getAggregatedLimits(getParamNamespace(nh), joint_models);
+}
+
+pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(XmlRpc::XmlRpcValue params,
+                                                             const std::vector<const moveit::core::JointModel*>& joint_models)
 {
   JointLimitsContainer container;
 
-  ROS_INFO_STREAM("Reading limits from namespace " << nh.getNamespace());
+  XmlRpc::XmlRpcValue no_params;
+  XmlRpc::XmlRpcValue* joint_limits_params {getXmlRpcMember(params, "joint_limits")};
 
   // Iterate over all joint models and generate the map
   for(auto joint_model : joint_models)
@@ -39,7 +124,7 @@ pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(cons
     JointLimit joint_limit;
 
     // If there is something defined for the joint on the parameter server
-    if(pilz_extensions::joint_limits_interface::getJointLimits(joint_model->getName(), nh, joint_limit))
+    if(getJointLimits(joint_limits_params ? *joint_limits_params : no_params, joint_model->getName(), joint_limit))
     {
       if(joint_limit.has_position_limits)
       {
@@ -82,6 +167,87 @@ pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(cons
   return container;
 }
 
+pilz::JointLimitsProviderConstPtr pilz::JointLimitsAggregator::getPayloadLimitsProvider(
+    const ros::NodeHandle& nh, const JointLimitsContainer& limits)
+{
+  return getPayloadLimitsProvider(getParamNamespace(nh), limits);
+}
+
+pilz::JointLimitsProviderConstPtr pilz::JointLimitsAggregator::getPayloadLimitsProvider(
+    XmlRpc::XmlRpcValue params, const JointLimitsContainer& limits)
+{
+  XmlRpc::XmlRpcValue* payload_params {getXmlRpcMember(params, "payload")};
+  if(!payload_params)
+  {
+    return nullptr;
+  }
+
+  double max_mass {0.};
+  if(!getXmlRpcDouble(*payload_params, "max_mass", max_mass) || max_mass <= 0.)
+  {
+    throw AggregationException("payload/max_mass must be set to a positive value");
+  }
+
+  std::map<std::string, double> object_masses;
+  if(XmlRpc::XmlRpcValue* object_masses_params = getXmlRpcMember(*payload_params, "object_masses"))
+  {
+    if(object_masses_params->getType() != XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      throw AggregationException("payload/object_masses must be a map from object id to mass");
+    }
+    for(auto& object_mass : *object_masses_params)
+    {
+      double mass;
+      if(!getXmlRpcDouble(*object_masses_params, object_mass.first, mass) || mass < 0.)
+      {
+        throw AggregationException("mass of object " + object_mass.first + " must not be negative");
+      }
+      object_masses[object_mass.first] = mass;
+    }
+  }
+
+  XmlRpc::XmlRpcValue* unloaded_params {getXmlRpcMember(*payload_params, "joint_limits")};
+  std::map<std::string, UnloadedJointLimit> unloaded_limits;
+  for(const auto& limit : limits)
+  {
+    XmlRpc::XmlRpcValue* joint_params {unloaded_params ? getXmlRpcMember(*unloaded_params, limit.first) : nullptr};
+    if(!joint_params)
+    {
+      continue;
+    }
+    UnloadedJointLimit unloaded_limit;
+
+    if(getXmlRpcDouble(*joint_params, "max_acceleration", unloaded_limit.max_acceleration))
+    {
+      if(!limit.second.has_acceleration_limits || unloaded_limit.max_acceleration < limit.second.max_acceleration)
+      {
+        throw AggregationBoundsViolationException("unloaded max_acceleration of " + limit.first
+                                                  + " is stricter than the max_acceleration");
+      }
+      unloaded_limit.has_acceleration_limits = true;
+    }
+
+    if(getXmlRpcDouble(*joint_params, "max_deceleration", unloaded_limit.max_deceleration))
+    {
+      if(!limit.second.has_deceleration_limits || unloaded_limit.max_deceleration > limit.second.max_deceleration)
+      {
+        throw AggregationBoundsViolationException("unloaded max_deceleration of " + limit.first
+                                                  + " is stricter than the max_deceleration");
+      }
+      unloaded_limit.has_deceleration_limits = true;
+    }
+
+    if(unloaded_limit.has_acceleration_limits || unloaded_limit.has_deceleration_limits)
+    {
+      unloaded_limits[limit.first] = unloaded_limit;
+    }
+  }
+
+  ROS_INFO_STREAM("Scaling the acceleration limits of " << unloaded_limits.size()
+                  << " joints for payloads up to " << max_mass << "kg.");
+  return std::make_shared<PayloadJointLimitsProvider>(max_mass, object_masses, unloaded_limits);
+}
+
 void pilz::JointLimitsAggregator::updatePositionLimitFromJointModel(const moveit::core::JointModel* joint_model,
                                                                     JointLimit& joint_limit)
 {
@@ -75,11 +75,17 @@ pilz_extensions::JointLimit JointLimitsContainer::getCommonLimit(const std::vect
   return common_limit;
 }
 
-pilz_extensions::JointLimit JointLimitsContainer::getLimit(const std::string &joint_name) const
+const pilz_extensions::JointLimit& JointLimitsContainer::getLimit(const std::string &joint_name) const
 {
   return container_.at(joint_name);
 }
 
+const pilz_extensions::JointLimit* JointLimitsContainer::findLimit(const std::string &joint_name) const
+{
+  const auto it {container_.find(joint_name)};
+  return it == container_.end() ? nullptr : &(it->second);
+}
+
 std::map<std::string, pilz_extensions::JointLimit>::const_iterator JointLimitsContainer::begin() const
 {
   return container_.begin();
@@ -93,19 +99,21 @@ std::map<std::string, pilz_extensions::JointLimit>::const_iterator JointLimitsCo
 bool JointLimitsContainer::verifyVelocityLimit(const std::string &joint_name,
                                                      const double &joint_velocity) const
 {
-  return (!(hasLimit(joint_name)
-          && getLimit(joint_name).has_velocity_limits
-          && fabs(joint_velocity) > getLimit(joint_name).max_velocity));
+  const pilz_extensions::JointLimit* limit {findLimit(joint_name)};
+  return (!(limit
+          && limit->has_velocity_limits
+          && fabs(joint_velocity) > limit->max_velocity));
 }
 
 
 bool JointLimitsContainer::verifyPositionLimit(const std::string &joint_name,
                                                      const double &joint_position) const
 {
-  return (!( hasLimit(joint_name)
-             && getLimit(joint_name).has_position_limits
-             && (joint_position < getLimit(joint_name).min_position
-                || joint_position > getLimit(joint_name).max_position) ) );
+  const pilz_extensions::JointLimit* limit {findLimit(joint_name)};
+  return (!( limit
+             && limit->has_position_limits
+             && (joint_position < limit->min_position
+                || joint_position > limit->max_position) ) );
 }
 
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/joint_limits_table.h"
+
+#include <limits>
+
+namespace pilz
+{
+
+JointLimitsTable::JointLimitsTable(const robot_model::RobotModelConstPtr& robot_model,
+                                   const JointLimitsContainer& joint_limits)
+{
+  const double inf {std::numeric_limits<double>::infinity()};
+  const std::size_t variable_count {robot_model->getVariableCount()};
+
+  min_position_.assign(variable_count, -inf);
+  max_position_.assign(variable_count, inf);
+  max_velocity_.assign(variable_count, inf);
+  max_acceleration_.assign(variable_count, inf);
+  max_deceleration_.assign(variable_count, inf);
+
+  for(const auto& limit : joint_limits)
+  {
+    // limits are given per joint, only single variable joints can be mapped
+    if(!robot_model->hasJointModel(limit.first))
+    {
+      continue;
+    }
+    const robot_model::JointModel* joint_model {robot_model->getJointModel(limit.first)};
+    if(joint_model->getVariableCount() != 1)
+    {
+      continue;
+    }
+
+    const std::size_t index {static_cast<std::size_t>(joint_model->getFirstVariableIndex())};
+    const pilz_extensions::JointLimit& joint_limit {limit.second};
+    if(joint_limit.has_position_limits)
+    {
+      min_position_[index] = joint_limit.min_position;
+      max_position_[index] = joint_limit.max_position;
+    }
+    if(joint_limit.has_velocity_limits)
+    {
+      max_velocity_[index] = joint_limit.max_velocity;
+    }
+    if(joint_limit.has_acceleration_limits)
+    {
+      max_acceleration_[index] = std::fabs(joint_limit.max_acceleration);
+    }
+    if(joint_limit.has_deceleration_limits)
+    {
+      max_deceleration_[index] = std::fabs(joint_limit.max_deceleration);
+    }
+  }
+}
+
+}  // namespace pilz
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/joint_trajectory_columns.h"
+
+namespace pilz
+{
+
+JointTrajectoryColumns::JointTrajectoryColumns(const std::vector<std::string>& joint_names)
+{
+  setJointNames(joint_names);
+}
+
+void JointTrajectoryColumns::setJointNames(const std::vector<std::string>& joint_names)
+{
+  joint_names_ = joint_names;
+  time_from_start_.clear();
+  positions_.assign(joint_names_.size(), std::vector<double>());
+  velocities_.assign(joint_names_.size(), std::vector<double>());
+  accelerations_.assign(joint_names_.size(), std::vector<double>());
+}
+
+void JointTrajectoryColumns::reserve(std::size_t point_count)
+{
+  time_from_start_.reserve(point_count);
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    positions_[j].reserve(point_count);
+    velocities_[j].reserve(point_count);
+    accelerations_[j].reserve(point_count);
+  }
+}
+
+void JointTrajectoryColumns::clear()
+{
+  time_from_start_.clear();
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    positions_[j].clear();
+    velocities_[j].clear();
+    accelerations_[j].clear();
+  }
+}
+
+void JointTrajectoryColumns::addPoint(double time_from_start,
+                                      const std::vector<double>& positions,
+                                      const std::vector<double>& velocities,
+                                      const std::vector<double>& accelerations)
+{
+  time_from_start_.push_back(time_from_start);
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    positions_[j].push_back(positions[j]);
+    velocities_[j].push_back(velocities[j]);
+    accelerations_[j].push_back(accelerations[j]);
+  }
+}
+
+void JointTrajectoryColumns::setLastPointAtRest()
+{
+  if(empty())
+  {
+    return;
+  }
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    velocities_[j].back() = 0.0;
+    accelerations_[j].back() = 0.0;
+  }
+}
+
+void JointTrajectoryColumns::keepPoints(const std::vector<std::size_t>& points)
+{
+  for(std::size_t i = 0; i < points.size(); ++i)
+  {
+    time_from_start_[i] = time_from_start_[points[i]];
+    for(std::size_t j = 0; j < joint_names_.size(); ++j)
+    {
+      positions_[j][i] = positions_[j][points[i]];
+      velocities_[j][i] = velocities_[j][points[i]];
+      accelerations_[j][i] = accelerations_[j][points[i]];
+    }
+  }
+
+  time_from_start_.resize(points.size());
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    positions_[j].resize(points.size());
+    velocities_[j].resize(points.size());
+    accelerations_[j].resize(points.size());
+  }
+}
+
+void JointTrajectoryColumns::fromMsg(const trajectory_msgs::JointTrajectory& joint_trajectory)
+{
+  setJointNames(joint_trajectory.joint_names);
+  reserve(joint_trajectory.points.size());
+  const std::vector<double> zeros(joint_names_.size(), 0.0);
+  for(const auto& point : joint_trajectory.points)
+  {
+    addPoint(point.time_from_start.toSec(),
+             point.positions,
+             point.velocities.empty() ? zeros : point.velocities,
+             point.accelerations.empty() ? zeros : point.accelerations);
+  }
+}
+
+void JointTrajectoryColumns::toMsg(trajectory_msgs::JointTrajectory& joint_trajectory) const
+{
+  joint_trajectory.joint_names = joint_names_;
+  joint_trajectory.points.resize(size());
+  for(std::size_t i = 0; i < size(); ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& point {joint_trajectory.points[i]};
+    point.time_from_start = ros::Duration(time_from_start_[i]);
+    point.positions.resize(joint_names_.size());
+    point.velocities.resize(joint_names_.size());
+    point.accelerations.resize(joint_names_.size());
+    for(std::size_t j = 0; j < joint_names_.size(); ++j)
+    {
+      point.positions[j] = positions_[j][i];
+      point.velocities[j] = velocities_[j][i];
+      point.accelerations[j] = accelerations_[j][i];
+    }
+  }
+}
+
+void JointTrajectoryColumns::toRobotTrajectory(const robot_state::RobotState& reference_state,
+                                               robot_trajectory::RobotTrajectory& trajectory) const
+{
+  // copy first, the reference state might be a waypoint of the trajectory
+  const robot_state::RobotState reference {reference_state};
+  trajectory.clear();
+
+  std::vector<int> variable_indices;
+  variable_indices.reserve(joint_names_.size());
+  for(const auto& joint_name : joint_names_)
+  {
+    variable_indices.push_back(reference.getRobotModel()->getVariableIndex(joint_name));
+  }
+
+  // the durations are computed like setRobotTrajectoryMsg() does, on the nanosecond resolution of ros::Duration
+  ros::Duration time_from_start_last(0.0);
+  for(std::size_t i = 0; i < size(); ++i)
+  {
+    robot_state::RobotStatePtr state {new robot_state::RobotState(reference)};
+    for(std::size_t j = 0; j < variable_indices.size(); ++j)
+    {
+      state->setVariablePosition(variable_indices[j], positions_[j][i]);
+      state->setVariableVelocity(variable_indices[j], velocities_[j][i]);
+      state->setVariableAcceleration(variable_indices[j], accelerations_[j][i]);
+    }
+    const ros::Duration time_from_start(time_from_start_[i]);
+    trajectory.addSuffixWayPoint(state, (time_from_start - time_from_start_last).toSec());
+    time_from_start_last = time_from_start;
+  }
+}
+
+std::size_t JointTrajectoryColumns::getMemoryBytes() const
+{
+  std::size_t bytes {sizeof(double) * time_from_start_.capacity()};
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    bytes += sizeof(double) * (positions_[j].capacity() + velocities_[j].capacity() + accelerations_[j].capacity());
+  }
+  return bytes;
+}
+
+}
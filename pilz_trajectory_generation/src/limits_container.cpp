@@ -59,3 +59,18 @@ const pilz::CartesianLimit& pilz::LimitsContainer::getCartesianLimits() const
 {
   return cartesian_limit_;
 }
+
+bool pilz::LimitsContainer::hasJointLimitsProvider() const
+{
+  return static_cast<bool>(joint_limits_provider_);
+}
+
+void pilz::LimitsContainer::setJointLimitsProvider(const pilz::JointLimitsProviderConstPtr& joint_limits_provider)
+{
+  joint_limits_provider_ = joint_limits_provider;
+}
+
+const pilz::JointLimitsProviderConstPtr& pilz::LimitsContainer::getJointLimitsProvider() const
+{
+  return joint_limits_provider_;
+}
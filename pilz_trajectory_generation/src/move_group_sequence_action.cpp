@@ -45,6 +45,7 @@
 #include <moveit/kinematic_constraints/utils.h>
 
 #include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
 
 namespace pilz_trajectory_generation
 {
@@ -72,6 +73,13 @@ void MoveGroupSequenceAction::executeSequenceCallback(const pilz_msgs::MoveGroup
 {
   setMoveState(move_group::PLANNING);
 
+  // withdraw a preempt of a previous goal, which arrived after its planning, but keep the one of this goal
+  sequence_manager_->resetTermination();
+  if(move_action_server_->isPreemptRequested())
+  {
+    sequence_manager_->terminate();
+  }
+
   pilz_msgs::MoveGroupSequenceResult action_res;
 
   // Handle empty requests
@@ -138,8 +146,12 @@ void MoveGroupSequenceAction::executeSequenceCallback_PlanAndExecute(const pilz_
   opt.replan_delay_ = goal->planning_options.replan_delay;
   opt.before_execution_callback_ = boost::bind(&MoveGroupSequenceAction::startMoveExecutionCallback, this);
 
+  pilz::StageTimes stage_times;
+  pilz::ResourceUsage resource_usage;
+  pilz::DecimationStatistics decimation;
   opt.plan_callback_ =
-      boost::bind(&MoveGroupSequenceAction::planUsingSequenceManager, this, boost::cref(goal->request), _1);
+      boost::bind(&MoveGroupSequenceAction::planUsingSequenceManager, this, boost::cref(goal->request), _1,
+                  &stage_times, &resource_usage, &decimation);
 
   if (goal->planning_options.look_around && context_->plan_with_sensing_)
   {
@@ -159,6 +171,11 @@ void MoveGroupSequenceAction::executeSequenceCallback_PlanAndExecute(const pilz_
   // LCOV_EXCL_STOP
 
   action_res.error_code = plan.error_code_;
+  setProcessingTimes(stage_times, action_res);
+  setResourceUsage(resource_usage,
+                   plan.plan_components_.empty() ? nullptr : plan.plan_components_.front().trajectory_,
+                   action_res);
+  action_res.trajectory_compression_ratio = decimation.getCompressionRatio();
 }
 
 void MoveGroupSequenceAction::executeMoveCallback_PlanOnly(const pilz_msgs::MoveGroupSequenceGoalConstPtr& goal,
@@ -175,9 +192,12 @@ void MoveGroupSequenceAction::executeMoveCallback_PlanOnly(const pilz_msgs::Move
         lscene->diff(goal->planning_options.planning_scene_diff);
 
   planning_interface::MotionPlanResponse res;
+  pilz::StageTimes stage_times;
+  pilz::ResourceUsage resource_usage;
+  pilz::DecimationStatistics decimation;
   try
   {
-    sequence_manager_->solve(the_scene, goal->request, res);
+    sequence_manager_->solve(the_scene, goal->request, res, &stage_times, &resource_usage, &decimation);
   }
   // LCOV_EXCL_START // Keep moveit up even if lower parts throw
   catch (std::exception& ex)
@@ -190,10 +210,16 @@ void MoveGroupSequenceAction::executeMoveCallback_PlanOnly(const pilz_msgs::Move
   convertToMsg(res.trajectory_, action_res.trajectory_start, action_res.planned_trajectory);
   action_res.error_code = res.error_code_;
   action_res.planning_time = res.planning_time_;
+  setProcessingTimes(stage_times, action_res);
+  setResourceUsage(resource_usage, res.trajectory_, action_res);
+  action_res.trajectory_compression_ratio = decimation.getCompressionRatio();
 }
 
 bool MoveGroupSequenceAction::planUsingSequenceManager(const pilz_msgs::MotionSequenceRequest& req,
-                                                     plan_execution::ExecutableMotionPlan& plan)
+                                                       plan_execution::ExecutableMotionPlan& plan,
+                                                       pilz::StageTimes* stage_times,
+                                                       pilz::ResourceUsage* resource_usage,
+                                                       pilz::DecimationStatistics* decimation)
 {
   setMoveState(move_group::PLANNING);
 
@@ -202,7 +228,7 @@ bool MoveGroupSequenceAction::planUsingSequenceManager(const pilz_msgs::MotionSe
   planning_interface::MotionPlanResponse res;
   try
   {
-    solved = sequence_manager_->solve(plan.planning_scene_, req, res);
+    solved = sequence_manager_->solve(plan.planning_scene_, req, res, stage_times, resource_usage, decimation);
   }
   // LCOV_EXCL_START // Keep moveit up even if lower parts throw
   catch (std::exception& ex)
@@ -222,6 +248,22 @@ bool MoveGroupSequenceAction::planUsingSequenceManager(const pilz_msgs::MotionSe
   return solved;
 }
 
+void MoveGroupSequenceAction::setProcessingTimes(const pilz::StageTimes& stage_times,
+                                                 pilz_msgs::MoveGroupSequenceResult& action_res)
+{
+  action_res.processing_stages = stage_times.getStages();
+  action_res.processing_times = stage_times.getDurations();
+}
+
+void MoveGroupSequenceAction::setResourceUsage(const pilz::ResourceUsage& resource_usage,
+                                               const robot_trajectory::RobotTrajectoryConstPtr& trajectory,
+                                               pilz_msgs::MoveGroupSequenceResult& action_res)
+{
+  action_res.planning_cpu_time = resource_usage.cpu_seconds;
+  action_res.planning_heap_peak_bytes = resource_usage.heap_peak_bytes;
+  action_res.trajectory_bytes = trajectory ? pilz::getTrajectoryMemoryBytes(*trajectory) : 0;
+}
+
 void MoveGroupSequenceAction::startMoveExecutionCallback()
 {
   setMoveState(move_group::MONITOR);
@@ -229,6 +271,8 @@ void MoveGroupSequenceAction::startMoveExecutionCallback()
 
 void MoveGroupSequenceAction::preemptMoveCallback()
 {
+  // stop a running planning as well as the execution
+  sequence_manager_->terminate();
   context_->plan_execution_->stop();
 }
 
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/payload_joint_limits_provider.h"
+
+#include <algorithm>
+
+#include <ros/ros.h>
+
+namespace pilz
+{
+
+PayloadJointLimitsProvider::PayloadJointLimitsProvider(double max_payload_mass,
+                                                       const std::map<std::string, double>& object_masses,
+                                                       const std::map<std::string, UnloadedJointLimit>& unloaded_limits)
+  : max_payload_mass_(max_payload_mass),
+    object_masses_(object_masses),
+    unloaded_limits_(unloaded_limits)
+{
+}
+
+double PayloadJointLimitsProvider::getPayloadMass(const robot_state::RobotState& state) const
+{
+  std::vector<const robot_state::AttachedBody*> attached_bodies;
+  state.getAttachedBodies(attached_bodies);
+
+  double payload_mass {0.};
+  for(const auto& attached_body : attached_bodies)
+  {
+    const auto it {object_masses_.find(attached_body->getName())};
+    if(it == object_masses_.end())
+    {
+      ROS_WARN_STREAM("Mass of attached body " << attached_body->getName()
+                      << " is unknown, planning with the limits of the maximal payload.");
+      return max_payload_mass_;
+    }
+    payload_mass += it->second;
+  }
+
+  if(payload_mass > max_payload_mass_)
+  {
+    ROS_WARN_STREAM("Attached payload of " << payload_mass << "kg exceeds the maximal payload of "
+                    << max_payload_mass_ << "kg.");
+  }
+  return std::min(payload_mass, max_payload_mass_);
+}
+
+JointLimitsContainer PayloadJointLimitsProvider::getLimits(const JointLimitsContainer& limits,
+                                                           const robot_state::RobotState& state) const
+{
+  const double ratio {getPayloadMass(state) / max_payload_mass_};
+
+  JointLimitsContainer payload_limits;
+  for(const auto& limit : limits)
+  {
+    pilz_extensions::JointLimit joint_limit {limit.second};
+
+    const auto unloaded {unloaded_limits_.find(limit.first)};
+    if(unloaded != unloaded_limits_.end())
+    {
+      if(joint_limit.has_acceleration_limits && unloaded->second.has_acceleration_limits)
+      {
+        joint_limit.max_acceleration = unloaded->second.max_acceleration
+            + (joint_limit.max_acceleration - unloaded->second.max_acceleration) * ratio;
+      }
+      if(joint_limit.has_deceleration_limits && unloaded->second.has_deceleration_limits)
+      {
+        joint_limit.max_deceleration = unloaded->second.max_deceleration
+            + (joint_limit.max_deceleration - unloaded->second.max_deceleration) * ratio;
+      }
+    }
+
+    payload_limits.addLimit(limit.first, joint_limit);
+  }
+
+  return payload_limits;
+}
+
+}  // namespace pilz
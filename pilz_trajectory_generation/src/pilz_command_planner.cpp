@@ -20,9 +20,19 @@
 #include "pilz_trajectory_generation/planning_context_loader.h"
 #include "pilz_trajectory_generation/planning_context_loader_ptp.h"
 #include "pilz_trajectory_generation/planning_exceptions.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/capability_names.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
+#include "pilz_trajectory_generation/trajectory_generator.h"
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
 #include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/xmlrpc_utils.h"
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
 
 // Boost includes
 #include <boost/scoped_ptr.hpp>
@@ -34,6 +44,8 @@
 namespace pilz {
 
 static const std::string PARAM_NAMESPACE_LIMTS = "robot_description_planning";
+static const std::string PARAM_WARM_UP_ITERATIONS = "warm_up_iterations";
+static const std::string PARAM_METRICS_PUBLISH_PERIOD = "metrics_publish_period";
 
 bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, const std::string &ns)
 {
@@ -43,13 +55,20 @@ bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, c
   // Store the model and the namespace
   model_ = model;
   namespace_ = ns;
+  self_collision_scene_ = pilz::getSelfCollisionScene(model_);
 
-  // Obtain the aggregated joint limits
-  aggregated_limit_active_joints_ = pilz::JointLimitsAggregator::getAggregatedLimits(
-        ros::NodeHandle(PARAM_NAMESPACE_LIMTS),model->getActiveJointModels());
+  // Obtain the aggregated joint and cartesian limits
+  const pilz::LimitsContainer limits {aggregateLimits()};
+  std::atomic_store(&limits_, std::make_shared<const pilz::LimitsContainer>(limits));
 
-  // Obtain cartesian limits
-  cartesian_limit_ = pilz::CartesianLimitsAggregator::getAggregatedLimits(ros::NodeHandle(PARAM_NAMESPACE_LIMTS));
+  // Optionally emit the knots of a spline instead of uniform samples
+  double spline_tolerance {0.};
+  ros::NodeHandle(ns).param(pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME, spline_tolerance, 0.);
+  spline_tolerance_ = spline_tolerance;
+  if(spline_tolerance > 0.)
+  {
+    ROS_INFO_STREAM("Spline output with a tolerance of " << spline_tolerance);
+  }
 
   // Load the planning context loader
   planner_context_loader.reset(new pluginlib::ClassLoader<PlanningContextLoader>("pilz_trajectory_generation",
@@ -72,20 +91,148 @@ bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, c
     ROS_INFO_STREAM("About to load: " << factories[i]);
     PlanningContextLoaderPtr loader_pointer(planner_context_loader->createInstance(factories[i]));
 
-    pilz::LimitsContainer limits;
-    limits.setJointLimits(aggregated_limit_active_joints_);
-    limits.setCartesianLimits(cartesian_limit_);
-
     loader_pointer->setLimits(limits);
     loader_pointer->setModel(model_);
+    loader_pointer->setSplineTolerance(spline_tolerance);
 
     registerContextLoader(loader_pointer);
 
   }
 
+  // Optionally initialize the IK solvers and collision structures before the first request
+  int warm_up_iterations {0};
+  ros::NodeHandle(ns).param(PARAM_WARM_UP_ITERATIONS, warm_up_iterations, 0);
+  if(warm_up_iterations > 0)
+  {
+    const ros::WallTime start {ros::WallTime::now()};
+    const std::size_t groups {pilz::warmUpKinematics(model_, static_cast<std::size_t>(warm_up_iterations))};
+    ROS_INFO_STREAM("Warmed up kinematics of " << groups << " planning group(s) in "
+                    << (ros::WallTime::now() - start).toSec() << "s");
+  }
+
+  // Optionally publish the planning metrics, shared by all planner instances of the process
+  double metrics_publish_period {0.};
+  ros::NodeHandle(ns).param(PARAM_METRICS_PUBLISH_PERIOD, metrics_publish_period, 0.);
+  pilz::startPlanningMetricsPublisher(ros::NodeHandle(ns), metrics_publish_period);
+
+  reload_limits_subscriber_ = ros::NodeHandle(ns).subscribe(pilz_trajectory_generation::RELOAD_LIMITS_TOPIC_NAME, 1,
+                                                            &CommandPlanner::reloadLimitsCallback, this);
+
+  reportSamplingTime(spline_tolerance);
+  return true;
+}
+
+std::shared_ptr<const pilz::LimitsContainer> CommandPlanner::getLimits() const
+{
+  return std::atomic_load(&limits_);
+}
+
+bool CommandPlanner::reloadLimits()
+{
+  std::lock_guard<std::mutex> lock(reload_mutex_);
+
+  pilz::LimitsContainer limits;
+  try
+  {
+    limits = aggregateLimits();
+  }
+  catch(const AggregationException& ex)
+  {
+    ROS_ERROR_STREAM("Failed to reload the limits, keeping the previous limits: " << ex.what());
+    return false;
+  }
+
+  std::atomic_store(&limits_, std::make_shared<const pilz::LimitsContainer>(limits));
+
+  // Each loader swaps its limits atomically, contexts in use keep their own copy
+  for(const auto& loader : context_loader_map_)
+  {
+    loader.second->setLimits(limits);
+  }
+
+  ROS_INFO("Reloaded the planner limits.");
   return true;
 }
 
+pilz::LimitsContainer CommandPlanner::aggregateLimits() const
+{
+  // Fetch all parameters at once instead of querying the parameter server per joint
+  const XmlRpc::XmlRpcValue params {pilz::getParamNamespace(ros::NodeHandle(PARAM_NAMESPACE_LIMTS))};
+
+  pilz::JointLimitsContainer joint_limits {pilz::JointLimitsAggregator::getAggregatedLimits(
+          params, model_->getActiveJointModels())};
+  pilz::CartesianLimit cartesian_limit {pilz::CartesianLimitsAggregator::getAggregatedLimits(params)};
+
+  pilz::LimitsContainer limits;
+  limits.setJointLimits(joint_limits);
+  limits.setCartesianLimits(cartesian_limit);
+  limits.setJointLimitsProvider(pilz::JointLimitsAggregator::getPayloadLimitsProvider(params, joint_limits));
+  return limits;
+}
+
+void CommandPlanner::reloadLimitsCallback(const std_msgs::Empty::ConstPtr& /*msg*/)
+{
+  reloadLimits();
+}
+
+void CommandPlanner::setPlannerConfigurations(const planning_interface::PlannerConfigurationMap& pcs)
+{
+  planning_interface::PlannerManager::setPlannerConfigurations(pcs);
+  // the stored configurations are replaced, so the sampling time is reported again
+  reportSamplingTime(spline_tolerance_);
+
+  // move_group merges the configurations of set_planner_params into the existing ones, so the tolerance is only
+  // taken from one configuration, a stale value in another configuration must not override it
+  const auto settings = pcs.find(pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME);
+  if(settings == pcs.end())
+  {
+    return;
+  }
+  const auto tolerance = settings->second.config.find(pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME);
+  if(tolerance == settings->second.config.end())
+  {
+    return;
+  }
+
+  try
+  {
+    setSplineTolerance(std::stod(tolerance->second));
+  }
+  catch(const std::logic_error&)
+  {
+    ROS_ERROR_STREAM("Invalid " << pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME << " \""
+                     << tolerance->second << "\" in the planner configuration "
+                     << pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME << ".");
+  }
+}
+
+void CommandPlanner::setSplineTolerance(double tolerance)
+{
+  spline_tolerance_ = tolerance;
+  for(const auto& loader : context_loader_map_)
+  {
+    loader.second->setSplineTolerance(tolerance);
+  }
+  reportSamplingTime(tolerance);
+}
+
+void CommandPlanner::reportSamplingTime(double spline_tolerance)
+{
+  // the knots of the spline output are not uniformly sampled
+  double sampling_time {TrajectoryGenerator::DEFAULT_SAMPLING_TIME};
+  if(spline_tolerance > 0.)
+  {
+    sampling_time = 0.;
+  }
+  std::ostringstream value;
+  value << std::setprecision(std::numeric_limits<double>::max_digits10) << sampling_time;
+
+  planning_interface::PlannerConfigurationSettings& settings
+  {config_settings_[pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME]};
+  settings.name = pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME;
+  settings.config[pilz_trajectory_generation::SAMPLING_TIME_PARAM_NAME] = value.str();
+}
+
 std::string CommandPlanner::getDescription() const
 {
   return "Simple Command Planner";
@@ -136,6 +283,14 @@ bool CommandPlanner::canServiceRequest(const moveit_msgs::MotionPlanRequest& req
   return context_loader_map_.find(req.planner_id) != context_loader_map_.end();
 }
 
+void CommandPlanner::terminate() const
+{
+  for(const auto& context_loader : context_loader_map_)
+  {
+    context_loader.second->terminateContexts();
+  }
+}
+
 void CommandPlanner::registerContextLoader(pilz::PlanningContextLoaderPtr planning_context_loader)
 {
   // Only add if command is not already in list, throw exception if not
@@ -17,6 +17,8 @@
 #include <ros/ros.h>
 #include "pilz_trajectory_generation/planning_context_loader.h"
 
+#include <algorithm>
+
 pilz::PlanningContextLoader::PlanningContextLoader():
   limits_set_(false),
   model_set_(false)
@@ -28,6 +30,8 @@ pilz::PlanningContextLoader::~PlanningContextLoader(){}
 
 bool pilz::PlanningContextLoader::setModel(const moveit::core::RobotModelConstPtr &model)
 {
+  std::lock_guard<std::mutex> lock(context_pool_mutex_);
+  clearContextPool();
   model_ = model;
   model_set_ = true;
   return true;
@@ -35,11 +39,70 @@ bool pilz::PlanningContextLoader::setModel(const moveit::core::RobotModelConstPt
 
 bool pilz::PlanningContextLoader::setLimits(const pilz::LimitsContainer &limits)
 {
+  // Swap the limits together with the pool, contexts in use keep the limits they were created with
+  std::lock_guard<std::mutex> lock(context_pool_mutex_);
+  clearContextPool();
   limits_ = limits;
   limits_set_ = true;
   return true;
 }
 
+void pilz::PlanningContextLoader::setSplineTolerance(double tolerance)
+{
+  std::lock_guard<std::mutex> lock(context_pool_mutex_);
+  if(tolerance == spline_tolerance_)
+  {
+    return;
+  }
+  clearContextPool();
+  spline_tolerance_ = tolerance;
+}
+
+void pilz::PlanningContextLoader::clearContextPool()
+{
+  for(const auto& pool : context_pool_)
+  {
+    for(const auto& pooled_context : pool.second)
+    {
+      addUnpooledContext(pooled_context);
+    }
+  }
+  context_pool_.clear();
+}
+
+void pilz::PlanningContextLoader::addUnpooledContext(
+    const planning_interface::PlanningContextPtr& planning_context) const
+{
+  // forget the contexts which are no longer used
+  unpooled_contexts_.erase(std::remove_if(unpooled_contexts_.begin(), unpooled_contexts_.end(),
+                                          [](const planning_interface::PlanningContextWeakPtr& context)
+                                          { return context.expired(); }),
+                           unpooled_contexts_.end());
+  unpooled_contexts_.push_back(planning_context);
+}
+
+void pilz::PlanningContextLoader::terminateContexts() const
+{
+  std::lock_guard<std::mutex> lock(context_pool_mutex_);
+  for(const auto& pool : context_pool_)
+  {
+    for(const auto& pooled_context : pool.second)
+    {
+      pooled_context->terminate();
+    }
+  }
+  for(const auto& unpooled_context : unpooled_contexts_)
+  {
+    const planning_interface::PlanningContextPtr context {unpooled_context.lock()};
+    if(context)
+    {
+      context->terminate();
+    }
+  }
+}
+
+constexpr std::size_t pilz::PlanningContextLoader::MAX_POOLED_CONTEXTS;
+
 std::string pilz::PlanningContextLoader::getAlgorithm() const
 {
   return alg_;
@@ -35,21 +35,31 @@ bool pilz::PlanningContextLoaderPTP::loadContext(planning_interface::PlanningCon
                                                  const std::string& name,
                                                  const std::string& group) const
 {
-  if(limits_set_ && model_set_) {
-    planning_context.reset(new PlanningContextPTP(name, group, model_, limits_));
-    return true;
-  }
-  else
+  std::lock_guard<std::mutex> lock(most_strict_limits_mutex_);
+  return PlanningContextLoader::loadContext<PlanningContextPTP>(planning_context, name, group, most_strict_limits_);
+}
+
+bool pilz::PlanningContextLoaderPTP::setModel(const moveit::core::RobotModelConstPtr& model)
+{
+  std::lock_guard<std::mutex> lock(most_strict_limits_mutex_);
+  const bool result {PlanningContextLoader::setModel(model)};
+  updateMostStrictLimits();
+  return result;
+}
+
+bool pilz::PlanningContextLoaderPTP::setLimits(const pilz::LimitsContainer& limits)
+{
+  std::lock_guard<std::mutex> lock(most_strict_limits_mutex_);
+  const bool result {PlanningContextLoader::setLimits(limits)};
+  updateMostStrictLimits();
+  return result;
+}
+
+void pilz::PlanningContextLoaderPTP::updateMostStrictLimits()
+{
+  if(model_set_ && limits_set_)
   {
-    if(!limits_set_)
-    {
-      ROS_ERROR_STREAM("Joint Limits are not defined. Cannot load planning context. Call setLimits loadContext");
-    }
-    if(!model_set_)
-    {
-      ROS_ERROR_STREAM("Robot model was not set");
-    }
-    return false;
+    most_strict_limits_ = TrajectoryGeneratorPTP::computeMostStrictLimits(model_, limits_.getJointLimitContainer());
   }
 }
 
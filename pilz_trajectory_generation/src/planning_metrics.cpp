@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/planning_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <diagnostic_msgs/KeyValue.h>
+
+namespace pilz
+{
+
+static const std::string DIAGNOSTICS_TOPIC_NAME = "/diagnostics";
+static const std::string DIAGNOSTIC_STATUS_NAME = "pilz_trajectory_generation: Planning metrics";
+
+constexpr std::size_t LatencyHistogram::SUB_BUCKET_COUNT;
+constexpr std::size_t LatencyHistogram::BUCKET_COUNT;
+
+const std::array<std::string, PlanningMetricsSnapshot::ALGORITHM_COUNT> PlanningMetricsSnapshot::ALGORITHM_NAMES
+{ {"ptp", "lin", "circ", "sequence"} };
+
+const std::array<std::string, PlanningMetricsSnapshot::COUNTER_COUNT> PlanningMetricsSnapshot::COUNTER_NAMES
+{ {"ik_calls", "ik_failures", "blends", "context_cache_hits", "context_cache_misses", "points",
+   "sequence_points"} };
+
+//*****************************
+// LatencyHistogram
+//*****************************
+
+std::size_t LatencyHistogram::getBucketIndex(std::uint64_t value)
+{
+  if(value < SUB_BUCKET_COUNT)
+  {
+    return static_cast<std::size_t>(value);
+  }
+
+  // position of the highest set bit, at least 3 because value >= 8
+  std::size_t exponent {0};
+  for(std::uint64_t rest = value; rest > 1; rest >>= 1)
+  {
+    ++exponent;
+  }
+  const std::size_t sub_bucket {static_cast<std::size_t>((value >> (exponent - 3)) & (SUB_BUCKET_COUNT - 1))};
+  return (exponent - 2) * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::getBucketUpperBound(std::size_t index)
+{
+  if(index < SUB_BUCKET_COUNT)
+  {
+    return index;
+  }
+
+  const std::size_t exponent {index / SUB_BUCKET_COUNT + 2};
+  const std::uint64_t sub_bucket {index % SUB_BUCKET_COUNT};
+  const std::uint64_t width {std::uint64_t {1} << (exponent - 3)};
+  return ((SUB_BUCKET_COUNT + sub_bucket) << (exponent - 3)) + (width - 1);
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram& older)
+{
+  for(std::size_t i = 0; i < BUCKET_COUNT; ++i)
+  {
+    buckets_[i] -= older.buckets_[i];
+  }
+  count_ -= older.count_;
+}
+
+std::uint64_t LatencyHistogram::getQuantile(double quantile) const
+{
+  if(count_ == 0)
+  {
+    return 0;
+  }
+
+  const double clamped {std::min(std::max(quantile, 0.), 1.)};
+  const std::uint64_t rank {std::max<std::uint64_t>(
+          1, static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(count_))))};
+  std::uint64_t cumulated {0};
+  for(std::size_t i = 0; i < BUCKET_COUNT; ++i)
+  {
+    cumulated += buckets_[i];
+    if(cumulated >= rank)
+    {
+      return getBucketUpperBound(i);
+    }
+  }
+  return getMax();
+}
+
+std::uint64_t LatencyHistogram::getMax() const
+{
+  for(std::size_t i = BUCKET_COUNT; i > 0; --i)
+  {
+    if(buckets_[i - 1] > 0)
+    {
+      return getBucketUpperBound(i - 1);
+    }
+  }
+  return 0;
+}
+
+//*****************************
+// PlanningMetricsSnapshot
+//*****************************
+
+void PlanningMetricsSnapshot::subtract(const PlanningMetricsSnapshot& older)
+{
+  for(std::size_t i = 0; i < ALGORITHM_COUNT; ++i)
+  {
+    plans[i] -= older.plans[i];
+    plan_failures[i] -= older.plan_failures[i];
+    latencies_us[i].subtract(older.latencies_us[i]);
+  }
+  for(std::size_t i = 0; i < COUNTER_COUNT; ++i)
+  {
+    counters[i] -= older.counters[i];
+  }
+}
+
+//*****************************
+// PlanningMetrics
+//*****************************
+
+/**
+ * @brief The metrics of one thread.
+ *
+ * Only the owning thread writes, the atomics allow reading them concurrently in getSnapshot().
+ */
+struct PlanningMetrics::ThreadMetrics
+{
+  explicit ThreadMetrics(std::thread::id id)
+    : thread_id(id)
+  {
+    for(auto& value : plans) { value = 0; }
+    for(auto& value : plan_failures) { value = 0; }
+    for(auto& histogram : latencies_us)
+    {
+      for(auto& bucket : histogram) { bucket = 0; }
+    }
+    for(auto& value : counters) { value = 0; }
+  }
+
+  /**
+   * @brief Increment for the owning thread, a plain load and store is sufficient with a single writer
+   */
+  static void add(std::atomic<std::uint64_t>& value, std::uint64_t count)
+  {
+    value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+  }
+
+  const std::thread::id thread_id;
+  std::array<std::atomic<std::uint64_t>, PlanningMetricsSnapshot::ALGORITHM_COUNT> plans;
+  std::array<std::atomic<std::uint64_t>, PlanningMetricsSnapshot::ALGORITHM_COUNT> plan_failures;
+  std::array<std::array<std::atomic<std::uint64_t>, LatencyHistogram::BUCKET_COUNT>,
+             PlanningMetricsSnapshot::ALGORITHM_COUNT> latencies_us;
+  std::array<std::atomic<std::uint64_t>, PlanningMetricsSnapshot::COUNTER_COUNT> counters;
+};
+
+namespace
+{
+
+std::uint64_t getNextMetricsId()
+{
+  static std::atomic<std::uint64_t> next_id {1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+
+PlanningMetrics::PlanningMetrics()
+  : id_(getNextMetricsId())
+{
+}
+
+PlanningMetrics::~PlanningMetrics()
+{
+}
+
+PlanningMetrics& PlanningMetrics::instance()
+{
+  static PlanningMetrics metrics;
+  return metrics;
+}
+
+PlanningMetrics::ThreadMetrics& PlanningMetrics::getThreadMetrics()
+{
+  // Cache of the block of the metrics last used by this thread
+  struct ThreadCache
+  {
+    std::uint64_t metrics_id {0};
+    ThreadMetrics* metrics {nullptr};
+  };
+  static thread_local ThreadCache cache;
+
+  if(cache.metrics_id == id_)
+  {
+    return *cache.metrics;
+  }
+
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  const std::thread::id thread_id {std::this_thread::get_id()};
+  auto it {std::find_if(threads_.begin(), threads_.end(),
+                        [&thread_id](const std::unique_ptr<ThreadMetrics>& thread_metrics)
+                        { return thread_metrics->thread_id == thread_id; })};
+  if(it == threads_.end())
+  {
+    threads_.emplace_back(new ThreadMetrics(thread_id));
+    it = threads_.end() - 1;
+  }
+
+  cache.metrics_id = id_;
+  cache.metrics = it->get();
+  return *cache.metrics;
+}
+
+void PlanningMetrics::recordPlan(Algorithm algorithm, std::chrono::nanoseconds latency, bool success)
+{
+  ThreadMetrics& metrics {getThreadMetrics()};
+  ThreadMetrics::add(metrics.plans[algorithm], 1);
+  if(!success)
+  {
+    ThreadMetrics::add(metrics.plan_failures[algorithm], 1);
+  }
+
+  const std::uint64_t latency_us {static_cast<std::uint64_t>(
+          std::max<std::chrono::microseconds::rep>(
+            0, std::chrono::duration_cast<std::chrono::microseconds>(latency).count()))};
+  ThreadMetrics::add(metrics.latencies_us[algorithm][LatencyHistogram::getBucketIndex(latency_us)], 1);
+}
+
+void PlanningMetrics::increment(Counter counter, std::uint64_t count)
+{
+  ThreadMetrics::add(getThreadMetrics().counters[counter], count);
+}
+
+PlanningMetricsSnapshot PlanningMetrics::getSnapshot() const
+{
+  PlanningMetricsSnapshot snapshot;
+
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  for(const auto& metrics : threads_)
+  {
+    for(std::size_t i = 0; i < PlanningMetricsSnapshot::ALGORITHM_COUNT; ++i)
+    {
+      snapshot.plans[i] += metrics->plans[i].load(std::memory_order_relaxed);
+      snapshot.plan_failures[i] += metrics->plan_failures[i].load(std::memory_order_relaxed);
+      for(std::size_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT; ++bucket)
+      {
+        const std::uint64_t count {metrics->latencies_us[i][bucket].load(std::memory_order_relaxed)};
+        if(count > 0)
+        {
+          snapshot.latencies_us[i].addToBucket(bucket, count);
+        }
+      }
+    }
+    for(std::size_t i = 0; i < PlanningMetricsSnapshot::COUNTER_COUNT; ++i)
+    {
+      snapshot.counters[i] += metrics->counters[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+//*****************************
+// ScopedPlanMetrics
+//*****************************
+
+ScopedPlanMetrics::~ScopedPlanMetrics()
+{
+  const bool success {res_.error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS};
+  metrics_.recordPlan(algorithm_,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_),
+                      success);
+  if(success && res_.trajectory_)
+  {
+    metrics_.increment(algorithm_ == PlanningMetricsSnapshot::SEQUENCE ? PlanningMetricsSnapshot::SEQUENCE_POINTS
+                                                                       : PlanningMetricsSnapshot::POINTS,
+                       res_.trajectory_->getWayPointCount());
+  }
+}
+
+//*****************************
+// Diagnostics
+//*****************************
+
+namespace
+{
+
+void addValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key, std::uint64_t value)
+{
+  diagnostic_msgs::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = std::to_string(value);
+  status.values.push_back(key_value);
+}
+
+}
+
+diagnostic_msgs::DiagnosticStatus toDiagnosticStatus(const PlanningMetricsSnapshot& total,
+                                                     const PlanningMetricsSnapshot& interval)
+{
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = DIAGNOSTIC_STATUS_NAME;
+  status.message = "Planning metrics";
+
+  for(std::size_t i = 0; i < PlanningMetricsSnapshot::ALGORITHM_COUNT; ++i)
+  {
+    const std::string& name {PlanningMetricsSnapshot::ALGORITHM_NAMES[i]};
+    addValue(status, name + "_plans", total.plans[i]);
+    addValue(status, name + "_failures", total.plan_failures[i]);
+    addValue(status, name + "_latency_p50_us", interval.latencies_us[i].getQuantile(0.5));
+    addValue(status, name + "_latency_p99_us", interval.latencies_us[i].getQuantile(0.99));
+    addValue(status, name + "_latency_max_us", interval.latencies_us[i].getMax());
+  }
+
+  for(std::size_t i = 0; i < PlanningMetricsSnapshot::COUNTER_COUNT; ++i)
+  {
+    addValue(status, PlanningMetricsSnapshot::COUNTER_NAMES[i], total.counters[i]);
+  }
+
+  return status;
+}
+
+PlanningMetricsPublisher::PlanningMetricsPublisher(ros::NodeHandle& nh, double period)
+  : publisher_(nh.advertise<diagnostic_msgs::DiagnosticArray>(DIAGNOSTICS_TOPIC_NAME, 1)),
+    timer_(nh.createTimer(ros::Duration(period), &PlanningMetricsPublisher::publish, this)),
+    previous_(PlanningMetrics::instance().getSnapshot())
+{
+}
+
+void PlanningMetricsPublisher::publish(const ros::TimerEvent& /*event*/)
+{
+  const PlanningMetricsSnapshot total {PlanningMetrics::instance().getSnapshot()};
+  PlanningMetricsSnapshot interval {total};
+  interval.subtract(previous_);
+  previous_ = total;
+
+  diagnostic_msgs::DiagnosticArray diagnostics;
+  diagnostics.header.stamp = ros::Time::now();
+  diagnostics.status.push_back(toDiagnosticStatus(total, interval));
+  publisher_.publish(diagnostics);
+}
+
+bool startPlanningMetricsPublisher(const ros::NodeHandle& nh, double period)
+{
+  static std::mutex mutex;
+  static std::unique_ptr<PlanningMetricsPublisher> publisher;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if(publisher || period <= 0.)
+  {
+    return false;
+  }
+
+  ros::NodeHandle publisher_nh {nh};
+  publisher.reset(new PlanningMetricsPublisher(publisher_nh, period));
+  ROS_INFO_STREAM("Publishing the planning metrics every " << period << "s on " << DIAGNOSTICS_TOPIC_NAME);
+  return true;
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/resource_usage.h"
+
+#include <algorithm>
+
+#include <time.h>
+
+// __GLIBC_PREREQ is only defined by glibc, so it must not be evaluated in the same condition which checks for glibc
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2
+#endif
+#endif
+
+namespace pilz
+{
+
+void ResourceUsage::add(const ResourceUsage& other)
+{
+  cpu_seconds += other.cpu_seconds;
+  heap_peak_bytes = std::max(heap_peak_bytes, other.heap_peak_bytes);
+}
+
+ResourceMeter::ResourceMeter(ResourceUsage* usage, bool measure_heap)
+  : usage_(usage)
+  , measure_heap_(measure_heap)
+{
+  if(!usage_)
+  {
+    return;
+  }
+  if(measure_heap_)
+  {
+    heap_start_ = heap_peak_ = getHeapBytesInUse();
+  }
+  cpu_start_ = getThreadCpuSeconds();
+}
+
+ResourceMeter::~ResourceMeter()
+{
+  if(!usage_)
+  {
+    return;
+  }
+  ResourceUsage usage;
+  usage.cpu_seconds = std::max(0., getThreadCpuSeconds() - cpu_start_);
+  if(measure_heap_)
+  {
+    sampleHeap();
+    usage.heap_peak_bytes = heap_peak_ - heap_start_;
+  }
+  usage_->add(usage);
+}
+
+void ResourceMeter::sampleHeap()
+{
+  if(!usage_ || !measure_heap_)
+  {
+    return;
+  }
+  heap_peak_ = std::max(heap_peak_, getHeapBytesInUse());
+}
+
+double ResourceMeter::getThreadCpuSeconds()
+{
+  timespec time;
+  if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+  {
+    return 0.; // LCOV_EXCL_LINE
+  }
+  return static_cast<double>(time.tv_sec) + 1.0e-9 * static_cast<double>(time.tv_nsec);
+}
+
+std::size_t ResourceMeter::getHeapBytesInUse()
+{
+  // allocated chunks of the arenas plus the chunks allocated by mmap
+#if defined(HAVE_MALLINFO2)
+  const struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+  // reported as int, wraps around above 2GB
+  const struct mallinfo info = mallinfo();
+  return static_cast<std::size_t>(static_cast<unsigned int>(info.uordblks))
+      + static_cast<std::size_t>(static_cast<unsigned int>(info.hblkhd));
+#else
+  return 0;
+#endif
+}
+
+}
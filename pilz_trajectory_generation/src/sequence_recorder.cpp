@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/sequence_recorder.h"
+
+#include <map>
+
+#include <ros/ros.h>
+
+namespace pilz_trajectory_generation
+{
+
+SequenceRecorder::SequenceRecorder(const std::string& file_name, std::size_t max_pending)
+  : max_pending_(max_pending)
+{
+  bag_.open(file_name, rosbag::bagmode::Write);
+  writer_ = std::thread(&SequenceRecorder::writeRecords, this);
+}
+
+SequenceRecorder::~SequenceRecorder()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  pending_condition_.notify_one();
+  writer_.join();
+  bag_.close();
+}
+
+std::shared_ptr<SequenceRecorder> SequenceRecorder::getSharedRecorder(const std::string& file_name)
+{
+  static std::mutex recorders_mutex;
+  static std::map<std::string, std::weak_ptr<SequenceRecorder> > recorders;
+
+  std::lock_guard<std::mutex> lock(recorders_mutex);
+  std::shared_ptr<SequenceRecorder> recorder {recorders[file_name].lock()};
+  if(!recorder)
+  {
+    recorder = std::make_shared<SequenceRecorder>(file_name);
+    recorders[file_name] = recorder;
+  }
+  return recorder;
+}
+
+bool SequenceRecorder::record(PlannedSequence&& sequence)
+{
+  // Wall time, the bag does not accept the zero time of a simulated clock which is not running
+  const ros::WallTime now {ros::WallTime::now()};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(pending_.size() >= max_pending_)
+    {
+      ++dropped_;
+      ROS_WARN_STREAM_THROTTLE(10., "Writing the sequence records falls behind, dropped "
+                               << dropped_ << " record(s) so far.");
+      return false;
+    }
+    pending_.emplace_back(ros::Time(now.sec, now.nsec), std::move(sequence));
+  }
+  pending_condition_.notify_one();
+  return true;
+}
+
+void SequenceRecorder::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  written_condition_.wait(lock, [this](){ return pending_.empty() && !writing_; });
+}
+
+std::size_t SequenceRecorder::getDroppedCount() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+void SequenceRecorder::toRecord(PlannedSequence&& sequence, pilz_msgs::MotionSequenceRecord& record)
+{
+  record.request = std::move(sequence.request);
+  if(sequence.planning_scene)
+  {
+    sequence.planning_scene->getPlanningSceneMsg(record.planning_scene);
+  }
+  sequence.response.getMessage(record.response);
+}
+
+void SequenceRecorder::writeRecords()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(true)
+  {
+    pending_condition_.wait(lock, [this](){ return stop_ || !pending_.empty(); });
+    if(pending_.empty())
+    {
+      // stopped and everything is written
+      return;
+    }
+
+    std::pair<ros::Time, PlannedSequence> entry {std::move(pending_.front())};
+    pending_.pop_front();
+    writing_ = true;
+
+    // Convert and write without holding the lock, the planning only waits for the queue
+    lock.unlock();
+    try
+    {
+      pilz_msgs::MotionSequenceRecord record;
+      toRecord(std::move(entry.second), record);
+      bag_.write(SEQUENCE_RECORD_TOPIC_NAME, entry.first, record);
+    }
+    catch(const rosbag::BagException& ex)
+    {
+      ROS_ERROR_STREAM("Failed to write a sequence record: " << ex.what());
+      lock.lock();
+      ++dropped_;
+      lock.unlock();
+    }
+    lock.lock();
+
+    writing_ = false;
+    written_condition_.notify_all();
+  }
+}
+
+}
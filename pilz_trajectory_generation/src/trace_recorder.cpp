@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <ros/ros.h>
+
+namespace pilz
+{
+
+/**
+ * @brief One span of the ring buffer.
+ *
+ * The sequence is 0 while the slot is written and the index of the span + 1 afterwards, which allows the export
+ * to skip slots which are overwritten concurrently.
+ */
+struct TraceRecorder::Slot
+{
+  std::atomic<std::uint64_t> sequence {0};
+  std::atomic<const char*> name {nullptr};
+  std::atomic<std::int64_t> begin_ns {0};
+  std::atomic<std::int64_t> end_ns {0};
+  std::atomic<std::uint32_t> thread_id {0};
+};
+
+namespace
+{
+
+/**
+ * @return a small id which is unique for each thread, used instead of the lengthy std::thread::id
+ */
+std::uint32_t getThreadId()
+{
+  static std::atomic<std::uint32_t> next_thread_id {1};
+  static thread_local const std::uint32_t thread_id {next_thread_id.fetch_add(1, std::memory_order_relaxed)};
+  return thread_id;
+}
+
+}
+
+TraceRecorder::TraceRecorder()
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+  delete[] slots_.load();
+}
+
+TraceRecorder& TraceRecorder::instance()
+{
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+void TraceRecorder::enable(std::size_t capacity)
+{
+  if(capacity == 0)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(!slots_.load(std::memory_order_relaxed))
+  {
+    // capacity_ is published together with the buffer
+    capacity_ = capacity;
+    slots_.store(new Slot[capacity], std::memory_order_release);
+  }
+  else if(capacity != capacity_)
+  {
+    ROS_WARN_STREAM("The trace buffer is already allocated, keeping its capacity of " << capacity_ << " spans.");
+  }
+
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::disable()
+{
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+std::size_t TraceRecorder::getCapacity() const
+{
+  return slots_.load(std::memory_order_acquire) ? capacity_ : 0;
+}
+
+void TraceRecorder::record(const char* name, std::int64_t begin_ns, std::int64_t end_ns)
+{
+  Slot* const slots {slots_.load(std::memory_order_acquire)};
+  if(!slots || !isEnabled())
+  {
+    return;
+  }
+
+  const std::uint64_t index {next_.fetch_add(1, std::memory_order_relaxed)};
+  Slot& slot {slots[index % capacity_]};
+
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+  slot.end_ns.store(end_ns, std::memory_order_relaxed);
+  slot.thread_id.store(getThreadId(), std::memory_order_relaxed);
+  slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::clear()
+{
+  Slot* const slots {slots_.load(std::memory_order_acquire)};
+  if(!slots)
+  {
+    return;
+  }
+
+  for(std::size_t i = 0; i < capacity_; ++i)
+  {
+    slots[i].sequence.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string TraceRecorder::toChromeTraceJson() const
+{
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  const Slot* const slots {slots_.load(std::memory_order_acquire)};
+  if(slots)
+  {
+    const std::uint64_t end {next_.load(std::memory_order_acquire)};
+    const std::uint64_t begin {end > capacity_ ? end - capacity_ : 0};
+    const int pid {static_cast<int>(getpid())};
+
+    bool first {true};
+    for(std::uint64_t index = begin; index < end; ++index)
+    {
+      const Slot& slot {slots[index % capacity_]};
+
+      // Skip slots which were cleared or are overwritten while reading them
+      if(slot.sequence.load(std::memory_order_acquire) != index + 1)
+      {
+        continue;
+      }
+      const char* const name {slot.name.load(std::memory_order_relaxed)};
+      const std::int64_t begin_ns {slot.begin_ns.load(std::memory_order_relaxed)};
+      const std::int64_t end_ns {slot.end_ns.load(std::memory_order_relaxed)};
+      const std::uint32_t thread_id {slot.thread_id.load(std::memory_order_relaxed)};
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if(slot.sequence.load(std::memory_order_relaxed) != index + 1)
+      {
+        continue;
+      }
+
+      json << (first ? "" : ",")
+           << "{\"name\":\"" << name << "\",\"cat\":\"pilz\",\"ph\":\"X\""
+           << ",\"ts\":" << static_cast<double>(begin_ns) / 1000.
+           << ",\"dur\":" << static_cast<double>(end_ns - begin_ns) / 1000.
+           << ",\"pid\":" << pid << ",\"tid\":" << thread_id << "}";
+      first = false;
+    }
+  }
+
+  json << "]}";
+  return json.str();
+}
+
+bool TraceRecorder::writeChromeTrace(const std::string& file_name) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream file(file_name);
+  file << toChromeTraceJson() << std::endl;
+  if(!file)
+  {
+    ROS_ERROR_STREAM("Failed to write the planning trace to " << file_name);
+    return false;
+  }
+  return true;
+}
+
+std::int64_t TraceRecorder::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
@@ -21,14 +21,16 @@
 namespace pilz_trajectory_generation
 {
 
-void TrajectoryAppender::merge(robot_trajectory::RobotTrajectory &result, const robot_trajectory::RobotTrajectory &source)
+void TrajectoryAppender::merge(robot_trajectory::RobotTrajectory &result, robot_trajectory::RobotTrajectory &source)
 {
-  if ( !result.empty() && pilz::isRobotStateEqual(result.getLastWayPoint(), source.getFirstWayPoint(),
-                                                  result.getGroupName(), ROBOT_STATE_EQUALITY_EPSILON) )
+  if ( !result.empty() && !source.empty()
+       && pilz::isRobotStateEqual(result.getLastWayPoint(), source.getFirstWayPoint(),
+                                  result.getGroupName(), ROBOT_STATE_EQUALITY_EPSILON) )
   {
+    // Share the states instead of copying them, like RobotTrajectory::append() does
     for (size_t i = 1; i < source.getWayPointCount(); ++i)
     {
-      result.addSuffixWayPoint(source.getWayPoint(i), source.getWayPointDurationFromPrevious(i));
+      result.addSuffixWayPoint(source.getWayPointPtr(i), source.getWayPointDurationFromPrevious(i));
     }
   }
   else
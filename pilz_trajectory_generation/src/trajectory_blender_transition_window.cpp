@@ -16,6 +16,8 @@
  */
 
 #include "pilz_trajectory_generation/trajectory_blender_transition_window.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
 
 #include <algorithm>
 #include <math.h>
@@ -24,6 +26,7 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
                                          pilz::TrajectoryBlendResponse& res)
 {
   ROS_INFO("Start trajectory blending using transition window.");
+  pilz::TraceSpan span("TrajectoryBlenderTransitionWindow::blend");
 
   double sampling_time = 0.;
   if(!validateRequest(req, sampling_time, res.error_code))
@@ -66,8 +69,12 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
     initial_joint_velocity[joint_name]
         = req.first_trajectory->getWayPoint(first_intersection_index-1).getVariableVelocity(joint_name);
   }
-  trajectory_msgs::JointTrajectory blend_joint_trajectory;
+  JointTrajectoryColumns blend_joint_trajectory;
   moveit_msgs::MoveItErrorCodes error_code;
+  pilz::JointTrajectoryGenerationOptions options;
+  options.check_self_collision = true;
+  options.terminated = req.terminated;
+  options.start_state = &req.first_trajectory->getWayPoint(first_intersection_index-1);
   if(!generateJointTrajectory(req.first_trajectory->getFirstWayPointPtr()->getRobotModel(),
                               limits_.getJointLimitContainer(),
                               blend_trajectory_cartesian,
@@ -77,7 +84,7 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
                               initial_joint_velocity,
                               blend_joint_trajectory,
                               error_code,
-                              true))
+                              options))
   {
     // LCOV_EXCL_START
     ROS_INFO("Failed to generate joint trajectory for blending trajectory.");
@@ -105,7 +112,7 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
   }
 
   // append the blend trajectory
-  res.blend_trajectory->setRobotTrajectoryMsg(req.first_trajectory->getFirstWayPoint(), blend_joint_trajectory);
+  blend_joint_trajectory.toRobotTrajectory(req.first_trajectory->getFirstWayPoint(), *res.blend_trajectory);
   // copy the points [second_intersection_index, len] from the second trajectory
   for(size_t i = second_intersection_index+1; i < req.second_trajectory->getWayPointCount(); ++i)
   {
@@ -117,6 +124,7 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
   // adjust the time from start
   res.second_trajectory->setWayPointDurationFromPrevious(0, sampling_time);
 
+  pilz::PlanningMetrics::instance().increment(pilz::PlanningMetricsSnapshot::BLENDS);
   res.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   return true;
 }
@@ -155,11 +163,15 @@ bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::Trajec
     return false;
   }
 
-  // same uniform sampling time
-  if (!pilz::determineAndCheckSamplingTime(req.first_trajectory,
-                                           req.second_trajectory,
-                                           EPSILON,
-                                           sampling_time))
+  // same uniform sampling time, a sampling time given by the caller is trusted
+  if (req.sampling_time > 0.)
+  {
+    sampling_time = req.sampling_time;
+  }
+  else if (!pilz::determineAndCheckSamplingTime(req.first_trajectory,
+                                                req.second_trajectory,
+                                                EPSILON,
+                                                sampling_time))
   {
 
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
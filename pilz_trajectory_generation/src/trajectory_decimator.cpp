@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/trajectory_decimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+namespace pilz
+{
+
+TrajectoryDecimator::TrajectoryDecimator(double tolerance, Interpolation interpolation)
+  : tolerance_(tolerance)
+  , interpolation_(interpolation)
+{
+}
+
+bool TrajectoryDecimator::parseInterpolation(const std::string& name, Interpolation& interpolation)
+{
+  if(name == "cubic")
+  {
+    interpolation = CUBIC;
+    return true;
+  }
+  if(name == "quintic")
+  {
+    interpolation = QUINTIC;
+    return true;
+  }
+  return false;
+}
+
+double TrajectoryDecimator::interpolate(Interpolation interpolation, double duration, double time,
+                                        double start_position, double start_velocity, double start_acceleration,
+                                        double end_position, double end_velocity, double end_acceleration)
+{
+  const double T {duration};
+  const double T2 {T * T};
+  const double T3 {T2 * T};
+  const double t {time};
+  const double t2 {t * t};
+  const double t3 {t2 * t};
+
+  if(interpolation == CUBIC)
+  {
+    const double a2 {(-3. * start_position + 3. * end_position - 2. * start_velocity * T - end_velocity * T) / T2};
+    const double a3 {(2. * start_position - 2. * end_position + start_velocity * T + end_velocity * T) / T3};
+    return start_position + start_velocity * t + a2 * t2 + a3 * t3;
+  }
+
+  // coefficients of the quintic spline as used by the ros_controllers::JointTrajectoryController
+  const double T4 {T3 * T};
+  const double T5 {T4 * T};
+  const double a2 {start_acceleration / 2.};
+  const double a3 {(-20. * start_position + 20. * end_position - 3. * start_acceleration * T2 + end_acceleration * T2
+                    - 12. * start_velocity * T - 8. * end_velocity * T) / (2. * T3)};
+  const double a4 {(30. * start_position - 30. * end_position + 3. * start_acceleration * T2
+                    - 2. * end_acceleration * T2 + 16. * start_velocity * T + 14. * end_velocity * T) / (2. * T4)};
+  const double a5 {(-12. * start_position + 12. * end_position - start_acceleration * T2 + end_acceleration * T2
+                    - 6. * start_velocity * T - 6. * end_velocity * T) / (2. * T5)};
+  return start_position + start_velocity * t + a2 * t2 + a3 * t3 + a4 * t2 * t2 + a5 * t3 * t2;
+}
+
+DecimationStatistics TrajectoryDecimator::decimate(robot_trajectory::RobotTrajectory& trajectory) const
+{
+  TraceSpan span("TrajectoryDecimator::decimate");
+
+  DecimationStatistics statistics;
+  const std::size_t count {trajectory.getWayPointCount()};
+  statistics.input_points = count;
+  statistics.output_points = count;
+  if(tolerance_ <= 0. || count < 3)
+  {
+    return statistics;
+  }
+
+  // compare the variables of the group, all variables if the trajectory has no group
+  std::vector<int> variable_indices;
+  if(trajectory.getGroup())
+  {
+    variable_indices = trajectory.getGroup()->getVariableIndexList();
+  }
+  else
+  {
+    variable_indices.resize(trajectory.getRobotModel()->getVariableCount());
+    for(std::size_t i = 0; i < variable_indices.size(); ++i)
+    {
+      variable_indices[i] = static_cast<int>(i);
+    }
+  }
+
+  std::vector<double> times(count, 0.);
+  for(std::size_t i = 1; i < count; ++i)
+  {
+    times[i] = times[i - 1] + trajectory.getWayPointDurationFromPrevious(i);
+  }
+
+  const std::vector<std::size_t> kept {findKeptWaypoints(count, [&](std::size_t start, std::size_t end)
+  {
+    return isReconstructible(trajectory, times, variable_indices, start, end);
+  })};
+
+  if(kept.size() == count)
+  {
+    return statistics;
+  }
+
+  robot_trajectory::RobotTrajectory decimated(trajectory.getRobotModel(), trajectory.getGroup());
+  decimated.addSuffixWayPoint(trajectory.getWayPointPtr(0), trajectory.getWayPointDurationFromPrevious(0));
+  for(std::size_t i = 1; i < kept.size(); ++i)
+  {
+    decimated.addSuffixWayPoint(trajectory.getWayPointPtr(kept[i]), times[kept[i]] - times[kept[i - 1]]);
+  }
+  trajectory.swap(decimated);
+
+  statistics.output_points = kept.size();
+  return statistics;
+}
+
+DecimationStatistics TrajectoryDecimator::decimate(JointTrajectoryColumns& trajectory) const
+{
+  TraceSpan span("TrajectoryDecimator::decimate");
+
+  DecimationStatistics statistics;
+  const std::size_t count {trajectory.size()};
+  statistics.input_points = count;
+  statistics.output_points = count;
+  if(tolerance_ <= 0. || count < 3)
+  {
+    return statistics;
+  }
+
+  const std::vector<std::size_t> kept {findKeptWaypoints(count, [&](std::size_t start, std::size_t end)
+  {
+    return isReconstructible(trajectory, start, end);
+  })};
+
+  if(kept.size() == count)
+  {
+    return statistics;
+  }
+
+  trajectory.keepPoints(kept);
+
+  statistics.output_points = kept.size();
+  return statistics;
+}
+
+std::vector<std::size_t> TrajectoryDecimator::findKeptWaypoints(
+    std::size_t count, const std::function<bool(std::size_t, std::size_t)>& is_reconstructible) const
+{
+  std::vector<std::size_t> kept {0};
+  std::size_t start {0};
+  while(start < count - 1)
+  {
+    // the next waypoint can always be reached, search the farthest reachable waypoint
+    std::size_t valid_end {start + 1};
+    std::size_t invalid_end {count};
+    std::size_t length {2};
+    while(start + length < count && is_reconstructible(start, start + length))
+    {
+      valid_end = start + length;
+      length *= 2;
+    }
+    if(start + length < count)
+    {
+      invalid_end = start + length;
+    }
+    else if(valid_end != count - 1)
+    {
+      if(is_reconstructible(start, count - 1))
+      {
+        valid_end = count - 1;
+      }
+      else
+      {
+        invalid_end = count - 1;
+      }
+    }
+    while(invalid_end - valid_end > 1 && valid_end != count - 1)
+    {
+      const std::size_t middle {valid_end + (invalid_end - valid_end) / 2};
+      if(is_reconstructible(start, middle))
+      {
+        valid_end = middle;
+      }
+      else
+      {
+        invalid_end = middle;
+      }
+    }
+    kept.push_back(valid_end);
+    start = valid_end;
+  }
+
+  return kept;
+}
+
+bool TrajectoryDecimator::isReconstructible(const robot_trajectory::RobotTrajectory& trajectory,
+                                            const std::vector<double>& times,
+                                            const std::vector<int>& variable_indices,
+                                            std::size_t start,
+                                            std::size_t end) const
+{
+  const double duration {times[end] - times[start]};
+  if(duration <= 0.)
+  {
+    return false;
+  }
+
+  const robot_state::RobotState& start_state {trajectory.getWayPoint(start)};
+  const robot_state::RobotState& end_state {trajectory.getWayPoint(end)};
+  for(std::size_t i = start + 1; i < end; ++i)
+  {
+    const double* positions {trajectory.getWayPoint(i).getVariablePositions()};
+    for(const int index : variable_indices)
+    {
+      const double interpolated {interpolate(interpolation_, duration, times[i] - times[start],
+                                             start_state.getVariablePosition(index),
+                                             start_state.getVariableVelocity(index),
+                                             start_state.getVariableAcceleration(index),
+                                             end_state.getVariablePosition(index),
+                                             end_state.getVariableVelocity(index),
+                                             end_state.getVariableAcceleration(index))};
+      if(std::fabs(interpolated - positions[index]) > tolerance_)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TrajectoryDecimator::isReconstructible(const JointTrajectoryColumns& trajectory,
+                                            std::size_t start,
+                                            std::size_t end) const
+{
+  const double duration {trajectory.getTimeFromStart(end) - trajectory.getTimeFromStart(start)};
+  if(duration <= 0.)
+  {
+    return false;
+  }
+
+  for(std::size_t j = 0; j < trajectory.getJointCount(); ++j)
+  {
+    for(std::size_t i = start + 1; i < end; ++i)
+    {
+      const double interpolated {interpolate(interpolation_, duration,
+                                             trajectory.getTimeFromStart(i) - trajectory.getTimeFromStart(start),
+                                             trajectory.getPosition(j, start),
+                                             trajectory.getVelocity(j, start),
+                                             trajectory.getAcceleration(j, start),
+                                             trajectory.getPosition(j, end),
+                                             trajectory.getVelocity(j, end),
+                                             trajectory.getAcceleration(j, end))};
+      if(std::fabs(interpolated - trajectory.getPosition(j, i)) > tolerance_)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}
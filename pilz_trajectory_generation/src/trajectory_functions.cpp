@@ -16,6 +16,14 @@
  */
 
 #include "pilz_trajectory_generation/trajectory_functions.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include <moveit/planning_scene/planning_scene.h>
 
@@ -27,41 +35,108 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                          const std::map<std::string, double> &seed,
                          std::map<std::string, double> &solution,
                          bool check_self_collision,
-                         const double timeout)
+                         const double timeout,
+                         pilz::IKStatistics* ik_statistics)
+{
+  robot_state::RobotState rstate(robot_model);
+  // By setting the robot state to default values, we basically allow
+  // the user of this function to supply an incomplete or even empty seed.
+  rstate.setToDefaultValues();
+  return computePoseIK(rstate, group_name, link_name, pose, frame_id, seed, solution, check_self_collision, timeout,
+                       ik_statistics);
+}
+
+bool pilz::computePoseIK(robot_state::RobotState& rstate,
+                         const std::string &group_name,
+                         const std::string &link_name,
+                         const Eigen::Isometry3d &pose,
+                         const std::string &frame_id,
+                         const std::map<std::string, double> &seed,
+                         std::map<std::string, double> &solution,
+                         bool check_self_collision,
+                         const double timeout,
+                         pilz::IKStatistics* ik_statistics)
 {
+  const moveit::core::RobotModelConstPtr& robot_model {rstate.getRobotModel()};
+  if(ik_statistics)
+  {
+    ++ik_statistics->calls;
+  }
+
   if(!robot_model->hasJointModelGroup(group_name))
   {
     ROS_ERROR_STREAM("Robot model has no planning group named as " << group_name);
+    if(ik_statistics)
+    {
+      ++ik_statistics->failures[IKStatistics::INVALID_GROUP];
+    }
     return false;
   }
 
   if(!robot_model->getJointModelGroup(group_name)->canSetStateFromIK(link_name))
   {
     ROS_ERROR_STREAM("No valid IK solver exists for " << link_name << " in planning group " << group_name);
+    if(ik_statistics)
+    {
+      ++ik_statistics->failures[IKStatistics::NO_IK_SOLVER];
+    }
     return false;
   }
 
   if(frame_id != robot_model->getModelFrame())
   {
     ROS_ERROR_STREAM("Given frame (" << frame_id << ") is unequal to model frame(" << robot_model->getModelFrame() << ")");
+    if(ik_statistics)
+    {
+      ++ik_statistics->failures[IKStatistics::INVALID_FRAME];
+    }
     return false;
   }
 
-  robot_state::RobotState rstate(robot_model);
-  // By setting the robot state to default values, we basically allow
-  // the user of this function to supply an incomplete or even empty seed.
-  rstate.setToDefaultValues();
   rstate.setVariablePositions(seed);
 
   moveit::core::GroupStateValidityCallbackFn ik_constraint_function;
-  ik_constraint_function = boost::bind(&pilz::isStateColliding, check_self_collision, robot_model, _1, _2, _3);
+  if(ik_statistics)
+  {
+    // measure the validity callback only if requested, the clock is read twice per solution of the solver
+    ik_constraint_function = [check_self_collision, &robot_model, ik_statistics](
+        robot_state::RobotState* state, const robot_state::JointModelGroup* group, const double* ik_solution)
+    {
+      const std::chrono::steady_clock::time_point begin {std::chrono::steady_clock::now()};
+      const bool valid {pilz::isStateColliding(check_self_collision, robot_model, state, group, ik_solution)};
+      ik_statistics->validity_seconds +=
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+      ++ik_statistics->validity_checks;
+      if(!valid)
+      {
+        ++ik_statistics->rejected_solutions;
+      }
+      return valid;
+    };
+  }
+  else
+  {
+    ik_constraint_function = boost::bind(&pilz::isStateColliding, check_self_collision, robot_model, _1, _2, _3);
+  }
 
   // call ik
-  if(rstate.setFromIK(robot_model->getJointModelGroup(group_name),
-                      pose,
-                      link_name,
-                      timeout,
-                      ik_constraint_function))
+  PlanningMetrics::instance().increment(PlanningMetricsSnapshot::IK_CALLS);
+  const std::chrono::steady_clock::time_point ik_begin {ik_statistics ? std::chrono::steady_clock::now()
+                                                                      : std::chrono::steady_clock::time_point()};
+  const bool found {rstate.setFromIK(robot_model->getJointModelGroup(group_name),
+                                     pose,
+                                     link_name,
+                                     timeout,
+                                     ik_constraint_function)};
+  if(ik_statistics)
+  {
+    const double ik_seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - ik_begin).count()};
+    ++ik_statistics->solver_calls;
+    ik_statistics->ik_seconds += ik_seconds;
+    ik_statistics->max_solver_call_seconds = std::max(ik_statistics->max_solver_call_seconds, ik_seconds);
+  }
+
+  if(found)
   {
     // copy the solution
     for(const auto& joint_name : robot_model->getJointModelGroup(group_name)->getActiveJointModelNames())
@@ -72,6 +147,11 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
   }
   else
   {
+    PlanningMetrics::instance().increment(PlanningMetricsSnapshot::IK_FAILURES);
+    if(ik_statistics)
+    {
+      ++ik_statistics->failures[IKStatistics::NO_SOLUTION];
+    }
     ROS_ERROR_STREAM("Inverse kinematics for pose \n"
                      << pose.translation()
                      << " has no solution.");
@@ -88,7 +168,8 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                          const std::map<std::string, double> &seed,
                          std::map<std::string, double> &solution,
                          bool check_self_collision,
-                         const double timeout)
+                         const double timeout,
+                         pilz::IKStatistics* ik_statistics)
 {
   Eigen::Isometry3d pose_eigen;
   tf::poseMsgToEigen(pose, pose_eigen);
@@ -100,7 +181,8 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                        seed,
                        solution,
                        check_self_collision,
-                       timeout);
+                       timeout,
+                       ik_statistics);
 }
 
 bool pilz::computeLinkFK(const moveit::core::RobotModelConstPtr &robot_model,
@@ -110,7 +192,14 @@ bool pilz::computeLinkFK(const moveit::core::RobotModelConstPtr &robot_model,
 {
   // create robot state
   robot_state::RobotState rstate(robot_model);
+  return computeLinkFK(rstate, link_name, joint_state, pose);
+}
 
+bool pilz::computeLinkFK(robot_state::RobotState& rstate,
+                         const std::string &link_name,
+                         const std::map<std::string, double> &joint_state,
+                         Eigen::Isometry3d &pose)
+{
   // check the reference frame of the target pose
   if(!rstate.knowsFrameTransform(link_name))
   {
@@ -144,15 +233,21 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
 
   double velocity_current, acceleration_current;
 
-  for(auto pos : position_current)
+  for(const auto& pos : position_current)
   {
+    const pilz_extensions::JointLimit* limit {joint_limits.findLimit(pos.first)};
+    if(!limit)
+    {
+      continue;
+    }
+
     velocity_current = (pos.second - position_last.at(pos.first))/duration_current;
 
-    if(!joint_limits.verifyVelocityLimit(pos.first, velocity_current))
+    if(limit->has_velocity_limits && fabs(velocity_current) > limit->max_velocity)
     {
       ROS_ERROR_STREAM("Joint velocity limit of " << pos.first << " violated. Set the velocity scaling factor lower!"
                        << " Actual joint velocity is " << velocity_current
-                       << ", while the limit is " << joint_limits.getLimit(pos.first).max_velocity
+                       << ", while the limit is " << limit->max_velocity
                        << ". ");
       return false;
     }
@@ -161,13 +256,13 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
     // acceleration case
     if(fabs(velocity_last.at(pos.first))<=fabs(velocity_current))
     {
-      if(joint_limits.getLimit(pos.first).has_acceleration_limits &&
-         fabs(acceleration_current)>fabs(joint_limits.getLimit(pos.first).max_acceleration))
+      if(limit->has_acceleration_limits &&
+         fabs(acceleration_current)>fabs(limit->max_acceleration))
       {
         ROS_ERROR_STREAM("Joint acceleration limit of " << pos.first
                          << " violated. Set the acceleration scaling factor lower!"
                          << " Actual joint acceleration is " << acceleration_current
-                         << ", while the limit is " << joint_limits.getLimit(pos.first).max_acceleration
+                         << ", while the limit is " << limit->max_acceleration
                          << ". ");
         return false;
       }
@@ -175,22 +270,104 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
     // deceleration case
     else
     {
-      if(joint_limits.getLimit(pos.first).has_deceleration_limits &&
-         fabs(acceleration_current)>fabs(joint_limits.getLimit(pos.first).max_deceleration))
+      if(limit->has_deceleration_limits &&
+         fabs(acceleration_current)>fabs(limit->max_deceleration))
       {
         ROS_ERROR_STREAM("Joint deceleration limit of " << pos.first
                          << " violated. Set the acceleration scaling factor lower!"
                          << " Actual joint deceleration is " << acceleration_current
-                         << ", while the limit is " << joint_limits.getLimit(pos.first).max_deceleration
+                         << ", while the limit is " << limit->max_deceleration
+                         << ". ");
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool pilz::verifySampleJointLimits(const pilz::JointLimitsTable& joint_limits,
+                                   const std::vector<std::size_t>& variable_indices,
+                                   const std::vector<std::string>& joint_names,
+                                   const std::vector<double>& position_last,
+                                   const std::vector<double>& velocity_last,
+                                   const std::vector<double>& position_current,
+                                   double duration_last,
+                                   double duration_current)
+{
+  const double EPSILON = 10e-6;
+  if(duration_current <= EPSILON)
+  {
+    ROS_ERROR("Sample duration too small, cannot compute the velocity");
+    return false;
+  }
+
+  for(std::size_t i = 0; i < variable_indices.size(); ++i)
+  {
+    const std::size_t index {variable_indices[i]};
+    const double velocity_current {(position_current[i] - position_last[i])/duration_current};
+
+    if(!joint_limits.verifyVelocity(index, velocity_current))
+    {
+      ROS_ERROR_STREAM("Joint velocity limit of " << joint_names[i]
+                       << " violated. Set the velocity scaling factor lower!"
+                       << " Actual joint velocity is " << velocity_current
+                       << ", while the limit is " << joint_limits.getMaxVelocity(index)
+                       << ". ");
+      return false;
+    }
+
+    const double acceleration_current {(velocity_current - velocity_last[i])/(duration_last + duration_current)*2};
+    // acceleration case
+    if(fabs(velocity_last[i])<=fabs(velocity_current))
+    {
+      if(!joint_limits.verifyAcceleration(index, acceleration_current))
+      {
+        ROS_ERROR_STREAM("Joint acceleration limit of " << joint_names[i]
+                         << " violated. Set the acceleration scaling factor lower!"
+                         << " Actual joint acceleration is " << acceleration_current
+                         << ", while the limit is " << joint_limits.getMaxAcceleration(index)
                          << ". ");
         return false;
       }
     }
+    // deceleration case
+    else if(!joint_limits.verifyDeceleration(index, acceleration_current))
+    {
+      ROS_ERROR_STREAM("Joint deceleration limit of " << joint_names[i]
+                       << " violated. Set the acceleration scaling factor lower!"
+                       << " Actual joint deceleration is " << acceleration_current
+                       << ", while the limit is " << -joint_limits.getMaxDeceleration(index)
+                       << ". ");
+      return false;
+    }
   }
 
   return true;
 }
 
+namespace
+{
+/**
+ * @brief Returns the joint names of the given joint positions and their variable indices in the robot model
+ */
+void getJointNamesAndIndices(const moveit::core::RobotModelConstPtr& robot_model,
+                             const std::map<std::string, double>& joint_positions,
+                             std::vector<std::string>& joint_names,
+                             std::vector<std::size_t>& variable_indices)
+{
+  joint_names.clear();
+  variable_indices.clear();
+  joint_names.reserve(joint_positions.size());
+  variable_indices.reserve(joint_positions.size());
+  for(const auto& joint_position : joint_positions)
+  {
+    joint_names.push_back(joint_position.first);
+    variable_indices.push_back(static_cast<std::size_t>(robot_model->getVariableIndex(joint_position.first)));
+  }
+}
+}
+
 bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
                                    const pilz::JointLimitsContainer& joint_limits,
                                    const KDL::Trajectory &trajectory,
@@ -198,13 +375,16 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                                    const std::string &link_name,
                                    const std::map<std::string, double> &initial_joint_position,
                                    const double &sampling_time,
-                                   trajectory_msgs::JointTrajectory &joint_trajectory,
+                                   JointTrajectoryColumns &joint_trajectory,
                                    moveit_msgs::MoveItErrorCodes &error_code,
-                                   bool check_self_collision)
+                                   const JointTrajectoryGenerationOptions& options)
 {
   ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
+  TraceSpan span("generateJointTrajectory");
 
   ros::Time generation_begin = ros::Time::now();
+  StageStopWatch no_stop_watch(nullptr);
+  StageStopWatch& sample_stop_watch = options.stop_watch ? *options.stop_watch : no_stop_watch;
 
   // generate the time samples
   const double EPSILON = 10e-06; // avoid adding the last time sample twice
@@ -215,31 +395,62 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
   }
   time_samples.push_back(trajectory.Duration());
 
-  // sample the trajectory and solve the inverse kinematics
+  // resolve the joints once, the samples are handled by index
+  const JointLimitsTable limits_table(robot_model, joint_limits);
+  std::vector<std::string> joint_names;
+  std::vector<std::size_t> variable_indices;
+  getJointNamesAndIndices(robot_model, initial_joint_position, joint_names, variable_indices);
+
+  std::vector<double> position_last;
+  position_last.reserve(joint_names.size());
+  for(const auto& joint_name : joint_names)
+  {
+    position_last.push_back(initial_joint_position.at(joint_name));
+  }
+  std::vector<double> velocity_last(joint_names.size(), 0.0);
+
+  joint_trajectory.setJointNames(joint_names);
+  joint_trajectory.reserve(time_samples.size());
+
+  // sample the trajectory and solve the inverse kinematics, the robot state and the point buffers are reused for all
+  // samples
   Eigen::Isometry3d pose_sample;
-  std::map<std::string, double> ik_solution_last, ik_solution, joint_velocity_last;
-  ik_solution_last = initial_joint_position;
-  for(const auto& item: ik_solution_last)
+  std::map<std::string, double> ik_solution_last {initial_joint_position}, ik_solution;
+  // the joints outside the group and the attached bodies are the ones of the start state for all samples
+  robot_state::RobotState rstate(options.start_state ? *options.start_state : robot_state::RobotState(robot_model));
+  if(!options.start_state)
   {
-    joint_velocity_last[item.first] = 0.0;
+    rstate.setToDefaultValues();
   }
+  std::vector<double> positions(joint_names.size()), velocities(joint_names.size()),
+      accelerations(joint_names.size());
 
   for(std::vector<double>::const_iterator time_iter=time_samples.begin();  time_iter!=time_samples.end(); ++time_iter )
   {
+    if(isTerminated(options.terminated))
+    {
+      ROS_INFO("Generation of the joint trajectory was terminated.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      joint_trajectory.clear();
+      return false;
+    }
+
     tf::transformKDLToEigen(trajectory.Pos(*time_iter), pose_sample);
 
-    if(!computePoseIK(robot_model,
+    if(!computePoseIK(rstate,
                       group_name,
                       link_name,
                       pose_sample,
                       robot_model->getModelFrame(),
                       ik_solution_last,
                       ik_solution,
-                      check_self_collision))
+                      options.check_self_collision,
+                      DEFAULT_IK_TIMEOUT,
+                      options.ik_statistics))
     {
       ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
       error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
     }
 
@@ -255,62 +466,62 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
       duration_current_sample = *time_iter;
     }
 
+    // fill the point with joint values
+    for(std::size_t i = 0; i < joint_names.size(); ++i)
+    {
+      positions[i] = ik_solution.at(joint_names[i]);
+    }
+
+    sample_stop_watch.lap(STAGE_SAMPLING);
+
     // skip the first sample with zero time from start for limits checking
-    if(time_iter!=time_samples.begin() && !verifySampleJointLimits(ik_solution_last,
-                                                                   joint_velocity_last,
-                                                                   ik_solution,
-                                                                   sampling_time,
-                                                                   duration_current_sample,
-                                                                   joint_limits))
+    const bool limits_valid {time_iter==time_samples.begin() || verifySampleJointLimits(limits_table,
+                                                                                        variable_indices,
+                                                                                        joint_names,
+                                                                                        position_last,
+                                                                                        velocity_last,
+                                                                                        positions,
+                                                                                        sampling_time,
+                                                                                        duration_current_sample)};
+    sample_stop_watch.lap(STAGE_LIMIT_CHECKS);
+    if(!limits_valid)
     {
       ROS_ERROR_STREAM("Inverse kinematics solution at " << *time_iter
                        << "s violates the joint velocity/acceleration/deceleration limits.");
       error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
     }
 
-    // fill the point with joint values
-    trajectory_msgs::JointTrajectoryPoint point;
-
-    // set joint names
-    joint_trajectory.joint_names.clear();
-    for(const auto& start_joint : initial_joint_position)
+    for(std::size_t i = 0; i < joint_names.size(); ++i)
     {
-      joint_trajectory.joint_names.push_back(start_joint.first);
-    }
-
-    point.time_from_start =  ros::Duration(*time_iter);
-    for(const auto& joint_name : joint_trajectory.joint_names)
-    {
-      point.positions.push_back(ik_solution.at(joint_name));
-
       if(time_iter!=time_samples.begin() && time_iter!=time_samples.end()-1)
       {
-        double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name))/duration_current_sample;
-        point.velocities.push_back(joint_velocity);
-        point.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name))/(duration_current_sample
-                                                                                             +sampling_time)*2);
-        joint_velocity_last[joint_name] = joint_velocity;
+        double joint_velocity = (positions[i] - position_last[i])/duration_current_sample;
+        velocities[i] = joint_velocity;
+        accelerations[i] = (joint_velocity - velocity_last[i])/(duration_current_sample + sampling_time)*2;
+        velocity_last[i] = joint_velocity;
       }
       else
       {
-        point.velocities.push_back(0.);
-        point.accelerations.push_back(0.);
-        joint_velocity_last[joint_name] = 0.;
+        velocities[i] = 0.;
+        accelerations[i] = 0.;
+        velocity_last[i] = 0.;
       }
     }
 
     // update joint trajectory
-    joint_trajectory.points.push_back(point);
-    ik_solution_last = ik_solution;
+    joint_trajectory.addPoint(*time_iter, positions, velocities, accelerations);
+    position_last.swap(positions);
+    ik_solution_last.swap(ik_solution);
+    sample_stop_watch.lap(STAGE_SAMPLING);
   }
 
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   double duration_ms = (ros::Time::now() - generation_begin).toSec() * 1000;
-  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.points.size()
+  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.size()
                   << ") took " << duration_ms << " ms | "
-                  << duration_ms / joint_trajectory.points.size() << " ms per Point");
+                  << duration_ms / joint_trajectory.size() << " ms per Point");
 
   return true;
 }
@@ -322,39 +533,72 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                                    const std::string &link_name,
                                    const std::map<std::string, double> &initial_joint_position,
                                    const std::map<std::string, double> &initial_joint_velocity,
-                                   trajectory_msgs::JointTrajectory &joint_trajectory,
+                                   JointTrajectoryColumns &joint_trajectory,
                                    moveit_msgs::MoveItErrorCodes &error_code,
-                                   bool check_self_collision)
+                                   const JointTrajectoryGenerationOptions& options)
 {
   ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
+  TraceSpan span("generateJointTrajectory");
 
   ros::Time generation_begin = ros::Time::now();
+  StageStopWatch no_stop_watch(nullptr);
+  StageStopWatch& sample_stop_watch = options.stop_watch ? *options.stop_watch : no_stop_watch;
+
+  // resolve the joints once, the samples are handled by index
+  const JointLimitsTable limits_table(robot_model, joint_limits);
+  std::vector<std::string> joint_names;
+  std::vector<std::size_t> variable_indices;
+  getJointNamesAndIndices(robot_model, initial_joint_position, joint_names, variable_indices);
+
+  std::vector<double> position_last, velocity_last;
+  position_last.reserve(joint_names.size());
+  velocity_last.reserve(joint_names.size());
+  for(const auto& joint_name : joint_names)
+  {
+    position_last.push_back(initial_joint_position.at(joint_name));
+    velocity_last.push_back(initial_joint_velocity.at(joint_name));
+  }
 
-  std::map<std::string, double> ik_solution_last = initial_joint_position;
-  std::map<std::string, double> joint_velocity_last = initial_joint_velocity;
-  double duration_last = 0;
-  double duration_current = 0;
-  joint_trajectory.joint_names.clear();
-  for(const auto& joint_position:ik_solution_last)
+  joint_trajectory.setJointNames(joint_names);
+  joint_trajectory.reserve(trajectory.points.size());
+
+  // the robot state and the point buffers are reused for all samples
+  std::map<std::string, double> ik_solution_last {initial_joint_position}, ik_solution;
+  // the joints outside the group and the attached bodies are the ones of the start state for all samples
+  robot_state::RobotState rstate(options.start_state ? *options.start_state : robot_state::RobotState(robot_model));
+  if(!options.start_state)
   {
-    joint_trajectory.joint_names.push_back(joint_position.first);
+    rstate.setToDefaultValues();
   }
-  std::map<std::string, double> ik_solution;
+  std::vector<double> positions(joint_names.size()), velocities(joint_names.size()),
+      accelerations(joint_names.size());
+  double duration_last = 0;
+  double duration_current = 0;
   for(size_t i=0; i<trajectory.points.size(); ++i)
   {
+    if(isTerminated(options.terminated))
+    {
+      ROS_INFO("Generation of the joint trajectory was terminated.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      joint_trajectory.clear();
+      return false;
+    }
+
     // compute inverse kinematics
-    if(!computePoseIK(robot_model,
+    if(!computePoseIK(rstate,
                       group_name,
                       link_name,
                       trajectory.points.at(i).pose,
                       robot_model->getModelFrame(),
                       ik_solution_last,
                       ik_solution,
-                      check_self_collision))
+                      options.check_self_collision,
+                      DEFAULT_IK_TIMEOUT,
+                      options.ik_statistics))
     {
       ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
       error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
     }
 
@@ -370,53 +614,92 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
           - trajectory.points.at(i-1).time_from_start.toSec();
     }
 
-    if(!verifySampleJointLimits(ik_solution_last,
-                                joint_velocity_last,
-                                ik_solution,
-                                duration_last,
-                                duration_current,
-                                joint_limits))
+    for(std::size_t j = 0; j < joint_names.size(); ++j)
+    {
+      positions[j] = ik_solution.at(joint_names[j]);
+    }
+
+    sample_stop_watch.lap(STAGE_SAMPLING);
+
+    const bool limits_valid {verifySampleJointLimits(limits_table,
+                                                     variable_indices,
+                                                     joint_names,
+                                                     position_last,
+                                                     velocity_last,
+                                                     positions,
+                                                     duration_last,
+                                                     duration_current)};
+    sample_stop_watch.lap(STAGE_LIMIT_CHECKS);
+    if(!limits_valid)
     {
       // LCOV_EXCL_START since the same code was captured in a test in the other overload generateJointTrajectory(..., KDL::Trajectory, ...)
       // TODO: refactor to avoid code duplication.
       ROS_ERROR_STREAM("Inverse kinematics solution of the " << i
                        << "th sample violates the joint velocity/acceleration/deceleration limits.");
       error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
       // LCOV_EXCL_STOP
     }
 
     // compute the waypoint
-    trajectory_msgs::JointTrajectoryPoint waypoint_joint;
-    waypoint_joint.time_from_start =  ros::Duration(trajectory.points.at(i).time_from_start);
-    for(const auto& joint_name : joint_trajectory.joint_names)
-    {
-      waypoint_joint.positions.push_back(ik_solution.at(joint_name));
-      double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name))/duration_current;
-      waypoint_joint.velocities.push_back(joint_velocity);
-      waypoint_joint.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name))/(duration_current
-                                                                                                    +duration_last)*2);
+    for(std::size_t j = 0; j < joint_names.size(); ++j)
+    {
+      double joint_velocity = (positions[j] - position_last[j])/duration_current;
+      velocities[j] = joint_velocity;
+      accelerations[j] = (joint_velocity - velocity_last[j])/(duration_current + duration_last)*2;
       //update the joint velocity
-      joint_velocity_last[joint_name] = joint_velocity;
+      velocity_last[j] = joint_velocity;
     }
 
     // update joint trajectory
-    joint_trajectory.points.push_back(waypoint_joint);
-    ik_solution_last = ik_solution;
+    joint_trajectory.addPoint(trajectory.points.at(i).time_from_start.toSec(), positions, velocities, accelerations);
+    position_last.swap(positions);
+    ik_solution_last.swap(ik_solution);
     duration_last = duration_current;
+    sample_stop_watch.lap(STAGE_SAMPLING);
   }
 
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
 
   double duration_ms = (ros::Time::now() - generation_begin).toSec() * 1000;
-  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.points.size()
+  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.size()
                   << ") took " << duration_ms << " ms | "
-                  << duration_ms / joint_trajectory.points.size() << " ms per Point");
+                  << duration_ms / joint_trajectory.size() << " ms per Point");
 
   return true;
 }
 
+namespace
+{
+/**
+ * @brief Checks that all durations of a trajectory except the last one are equal to the sampling time
+ * @param name: name of the trajectory in the error messages
+ */
+bool checkSamplingTime(const robot_trajectory::RobotTrajectory& trajectory,
+                       double sampling_time,
+                       double epsilon,
+                       const std::string& name)
+{
+  // The last sample is ignored because it is allowed to violate the sampling time.
+  const std::size_t N {trajectory.getWayPointCount() - 1};
+  if(N < 2)
+  {
+    return true;
+  }
+
+  for(std::size_t i = 1; i < N; ++i)
+  {
+    if(fabs(sampling_time - trajectory.getWayPointDurationFromPrevious(i)) > epsilon)
+    {
+      ROS_ERROR_STREAM(name << " trajectory violates sampline time " << sampling_time << " between points "
+                       << (i-1) << "and " << i << " (indices).");
+      return false;
+    }
+  }
+  return true;
+}
+}
 
 bool pilz::determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectoryPtr& first_trajectory,
                                          const robot_trajectory::RobotTrajectoryPtr& second_trajectory,
@@ -441,31 +724,22 @@ bool pilz::determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectory
     sampling_time = second_trajectory->getWayPointDurationFromPrevious(1);
   }
 
-  for(std::size_t i = 1; i < std::max(N1, N2); ++i)
-  {
-    if (i < N1)
-    {
-      if ( fabs(sampling_time - first_trajectory->getWayPointDurationFromPrevious(i)) > EPSILON )
-      {
-        ROS_ERROR_STREAM("First trajectory violates sampline time " << sampling_time
-                         << " between points "
-                         << (i-1) << "and " << i << " (indices).");
-        return false;
-      }
-    }
+  return checkSamplingTime(*first_trajectory, sampling_time, EPSILON, "First")
+      && checkSamplingTime(*second_trajectory, sampling_time, EPSILON, "Second");
+}
 
-    if (i < N2)
-    {
-      if ( fabs(sampling_time - second_trajectory->getWayPointDurationFromPrevious(i)) > EPSILON )
-      {
-        ROS_ERROR_STREAM("Second trajectory violates sampline time " << sampling_time << " between points "
-                         << (i-1) << "and " << i << " (indices).");
-        return false;
-      }
-    }
+bool pilz::determineSamplingTime(const robot_trajectory::RobotTrajectory& trajectory,
+                                double epsilon,
+                                double& sampling_time)
+{
+  // The last sample is ignored because it is allowed to violate the sampling time.
+  if(trajectory.getWayPointCount() < 3)
+  {
+    return false;
   }
 
-  return true;
+  sampling_time = trajectory.getWayPointDurationFromPrevious(1);
+  return checkSamplingTime(trajectory, sampling_time, epsilon, "The");
 }
 
 bool pilz::isRobotStateEqual(const moveit::core::RobotStatePtr &state1,
@@ -477,50 +751,76 @@ bool pilz::isRobotStateEqual(const moveit::core::RobotStatePtr &state1,
   return isRobotStateEqual(*state1, *state2, joint_group_name, epsilon);
 }
 
+namespace
+{
+/**
+ * @brief Returns the Euclidean distance between the given variables of two variable arrays
+ */
+double getVariableDistance(const double* values1, const double* values2, const std::vector<int>& variable_indices)
+{
+  double squared_distance {0.};
+  for(const int index : variable_indices)
+  {
+    const double difference {values1[index] - values2[index]};
+    squared_distance += difference * difference;
+  }
+  return std::sqrt(squared_distance);
+}
+}
+
 bool pilz::isRobotStateEqual(const moveit::core::RobotState &state1,
                              const moveit::core::RobotState &state2,
                              const std::string &joint_group_name,
                              double epsilon)
 {
-  Eigen::VectorXd joint_position_1, joint_position_2;
-
-  state1.copyJointGroupPositions(joint_group_name, joint_position_1);
-  state2.copyJointGroupPositions(joint_group_name, joint_position_2);
+  // the variables are compared in place, this is called for every merged trajectory
+  const moveit::core::JointModelGroup* group {state1.getJointModelGroup(joint_group_name)};
+  if(!group)
+  {
+    // no variables to compare, the robot model reports the unknown group
+    return true;
+  }
+  const std::vector<int>& variable_indices {group->getVariableIndexList()};
 
-  if( (joint_position_1 - joint_position_2).norm() > epsilon)
+  const double position_distance {getVariableDistance(state1.getVariablePositions(), state2.getVariablePositions(),
+                                                      variable_indices)};
+  if(position_distance > epsilon)
   {
-    ROS_DEBUG_STREAM("Joint positions of the two states are different. state1: " << joint_position_1 << " state2: "
-                     << joint_position_2);
+    ROS_DEBUG_STREAM("Joint positions of the two states are different by " << position_distance << ".");
     return false;
   }
 
-  Eigen::VectorXd joint_velocity_1, joint_velocity_2;
-
-  state1.copyJointGroupVelocities(joint_group_name, joint_velocity_1);
-  state2.copyJointGroupVelocities(joint_group_name, joint_velocity_2);
-
-  if( (joint_velocity_1 - joint_velocity_2).norm() > epsilon)
+  const double velocity_distance {getVariableDistance(state1.getVariableVelocities(), state2.getVariableVelocities(),
+                                                      variable_indices)};
+  if(velocity_distance > epsilon)
   {
-    ROS_DEBUG_STREAM("Joint velocities of the two states are different. state1: " << joint_velocity_1 << " state2: "
-                     << joint_velocity_2);
+    ROS_DEBUG_STREAM("Joint velocities of the two states are different by " << velocity_distance << ".");
     return false;
   }
 
-  Eigen::VectorXd joint_acc_1, joint_acc_2;
-
-  state1.copyJointGroupAccelerations(joint_group_name, joint_acc_1);
-  state2.copyJointGroupAccelerations(joint_group_name, joint_acc_2);
-
-  if( (joint_acc_1 - joint_acc_2).norm() > epsilon)
+  const double acceleration_distance {getVariableDistance(state1.getVariableAccelerations(),
+                                                          state2.getVariableAccelerations(),
+                                                          variable_indices)};
+  if(acceleration_distance > epsilon)
   {
-    ROS_DEBUG_STREAM("Joint accelerations of the two states are different. state1: " << joint_acc_1 << " state2: "
-                     << joint_acc_2);
+    ROS_DEBUG_STREAM("Joint accelerations of the two states are different by " << acceleration_distance << ".");
     return false;
   }
 
   return true;
 }
 
+std::size_t pilz::getTrajectoryMemoryBytes(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  const moveit::core::RobotModelConstPtr& robot_model {trajectory.getRobotModel()};
+  const std::size_t state_bytes {sizeof(robot_state::RobotState)
+        + sizeof(double) * 3 * robot_model->getVariableCount()
+        + sizeof(Eigen::Isometry3d) * (robot_model->getJointModelCount() + robot_model->getLinkModelCount()
+                                       + robot_model->getLinkGeometryCount())
+        + sizeof(unsigned char) * robot_model->getJointModelCount()};
+  return trajectory.getWayPointCount() * (state_bytes + sizeof(robot_state::RobotStatePtr) + sizeof(double));
+}
+
 bool pilz::isRobotStateStationary(const moveit::core::RobotStatePtr &state,
                                   const std::string &group,
                                   double EPSILON)
@@ -592,6 +892,28 @@ bool pilz::intersectionFound(const Eigen::Vector3d &p_center,
   return ((p_current - p_center).norm() <= r) && ((p_next - p_center).norm() >= r);
 }
 
+planning_scene::PlanningSceneConstPtr pilz::getSelfCollisionScene(const moveit::core::RobotModelConstPtr &robot_model)
+{
+  // the scenes are owned by their users, so the cache keeps neither a scene nor its model alive
+  static std::mutex scenes_mutex;
+  static std::map<const moveit::core::RobotModel*, std::weak_ptr<const planning_scene::PlanningScene> > scenes;
+
+  std::lock_guard<std::mutex> lock(scenes_mutex);
+  planning_scene::PlanningSceneConstPtr scene {scenes[robot_model.get()].lock()};
+  if(scene)
+  {
+    return scene;
+  }
+
+  for(auto it = scenes.begin(); it != scenes.end();)
+  {
+    it = it->second.expired() ? scenes.erase(it) : std::next(it);
+  }
+  scene = std::make_shared<const planning_scene::PlanningScene>(robot_model);
+  scenes[robot_model.get()] = scene;
+  return scene;
+}
+
 bool pilz::isStateColliding(const bool test_for_self_collision,
                             const moveit::core::RobotModelConstPtr &robot_model,
                             robot_state::RobotState* rstate,
@@ -608,11 +930,48 @@ bool pilz::isStateColliding(const bool test_for_self_collision,
   collision_detection::CollisionRequest collision_req;
   collision_req.group_name = group->getName();
   collision_detection::CollisionResult collision_res;
-  planning_scene::PlanningScene(robot_model).checkSelfCollision(collision_req, collision_res, *rstate);
+  getSelfCollisionScene(robot_model)->checkSelfCollision(collision_req, collision_res, *rstate);
 
   return !collision_res.collision;
 }
 
+static constexpr double WARM_UP_IK_TIMEOUT {0.1};
+
+std::size_t pilz::warmUpKinematics(const moveit::core::RobotModelConstPtr &robot_model, std::size_t iterations)
+{
+  robot_state::RobotState rstate(robot_model);
+  rstate.setToDefaultValues();
+
+  std::size_t warmed_up_groups {0};
+  for(const auto& group : robot_model->getJointModelGroups())
+  {
+    if(!group->getSolverInstance() || group->getLinkModelNames().empty())
+    {
+      continue;
+    }
+    const std::string& link_name {group->getLinkModelNames().back()};
+    if(!group->canSetStateFromIK(link_name))
+    {
+      continue;
+    }
+
+    const moveit::core::GroupStateValidityCallbackFn ik_constraint_function {
+      boost::bind(&pilz::isStateColliding, true, robot_model, _1, _2, _3)};
+
+    for(std::size_t i = 0; i < iterations; ++i)
+    {
+      rstate.setToRandomPositions(group);
+      rstate.update();
+      const Eigen::Isometry3d pose {rstate.getFrameTransform(link_name)};
+
+      // The result is irrelevant, a random state might e.g. be in self collision
+      rstate.setFromIK(group, pose, link_name, WARM_UP_IK_TIMEOUT, ik_constraint_function);
+    }
+    ++warmed_up_groups;
+  }
+  return warmed_up_groups;
+}
+
 void normalizeQuaternion(geometry_msgs::Quaternion & quat){
   tf::Quaternion q;
   quaternionMsgToTF(quat, q);
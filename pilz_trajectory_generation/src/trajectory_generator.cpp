@@ -22,6 +22,7 @@
 #include <kdl/velocityprofile_trap.hpp>
 
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/trajectory_decimator.h"
 
 namespace pilz{
 
@@ -223,9 +224,10 @@ bool TrajectoryGenerator::validateStartState(const planning_interface::MotionPla
 
 bool TrajectoryGenerator::setResponse(const planning_interface::MotionPlanRequest &req,
                                       planning_interface::MotionPlanResponse &res,
-                                      const trajectory_msgs::JointTrajectory &joint_trajectory,
+                                      const JointTrajectoryColumns &joint_trajectory,
                                       const moveit_msgs::MoveItErrorCodes &err_code,
-                                      const ros::Time& planning_start) const
+                                      const ros::Time& planning_start,
+                                      const robot_state::RobotStateConstPtr& start_state) const
 {
   // if invalid, return empty trajectory
   if(err_code.val != moveit_msgs::MoveItErrorCodes::SUCCESS)
@@ -240,12 +242,9 @@ bool TrajectoryGenerator::setResponse(const planning_interface::MotionPlanReques
   }
   else
   {
-    // convert trajectory_msgs::JointTrajectory to robot_trajectory::RobotTrajectory
+    // convert the joint trajectory to robot_trajectory::RobotTrajectory, the only conversion of the samples
     robot_trajectory::RobotTrajectoryPtr rt(new robot_trajectory::RobotTrajectory(robot_model_, req.group_name));
-    moveit::core::RobotState start_rs(robot_model_);
-    start_rs.setToDefaultValues();
-    moveit::core::robotStateMsgToRobotState(req.start_state, start_rs, false);
-    rt->setRobotTrajectoryMsg(start_rs,joint_trajectory);
+    joint_trajectory.toRobotTrajectory(start_state ? *start_state : *createStartState(req), *rt);
     res.trajectory_ = rt;
     res.error_code_.val = err_code.val;
     res.planning_time_ = (ros::Time::now() - planning_start).toSec();
@@ -253,6 +252,44 @@ bool TrajectoryGenerator::setResponse(const planning_interface::MotionPlanReques
   }
 }
 
+void TrajectoryGenerator::fitSpline(JointTrajectoryColumns& joint_trajectory, StageStopWatch& stop_watch) const
+{
+  if(spline_tolerance_ <= 0.)
+  {
+    return;
+  }
+
+  const DecimationStatistics statistics {TrajectoryDecimator(spline_tolerance_, TrajectoryDecimator::QUINTIC)
+                                         .decimate(joint_trajectory)};
+  stop_watch.lap(STAGE_SPLINE_FIT);
+  ROS_DEBUG_STREAM("Fitted a spline with " << statistics.output_points << " knots through "
+                   << statistics.input_points << " samples.");
+}
+
+robot_state::RobotStatePtr TrajectoryGenerator::createStartState(const planning_interface::MotionPlanRequest &req) const
+{
+  robot_state::RobotStatePtr start_state(new robot_state::RobotState(robot_model_));
+  start_state->setToDefaultValues();
+  moveit::core::robotStateMsgToRobotState(req.start_state, *start_state);
+  return start_state;
+}
+
+void TrajectoryGenerator::setStartState(const planning_interface::MotionPlanRequest& req, MotionPlanInfo& info) const
+{
+  info.start_state = createStartState(req);
+  if(planner_limits_.hasJointLimitsProvider())
+  {
+    info.start_state_joint_limits = std::make_shared<const JointLimitsContainer>(
+          planner_limits_.getJointLimitsProvider()->getLimits(planner_limits_.getJointLimitContainer(),
+                                                              *info.start_state));
+  }
+}
+
+const JointLimitsContainer& TrajectoryGenerator::getJointLimits(const MotionPlanInfo& info) const
+{
+  return info.start_state_joint_limits ? *info.start_state_joint_limits : planner_limits_.getJointLimitContainer();
+}
+
 std::unique_ptr<KDL::VelocityProfile> TrajectoryGenerator::cartesianTrapVelocityProfile(
     const planning_interface::MotionPlanRequest &req,
     const MotionPlanInfo& plan_info,
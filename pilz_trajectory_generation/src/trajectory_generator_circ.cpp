@@ -17,6 +17,8 @@
 
 #include "pilz_trajectory_generation/trajectory_generator_circ.h"
 #include "pilz_trajectory_generation/path_circle_generator.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
 
 #include <ros/ros.h>
 #include <eigen_conversions/eigen_msg.h>
@@ -47,23 +49,32 @@ TrajectoryGeneratorCIRC::~TrajectoryGeneratorCIRC()
 
 bool TrajectoryGeneratorCIRC::generate(const planning_interface::MotionPlanRequest &req,
                                        planning_interface::MotionPlanResponse &res,
-                                       double sampling_time)
+                                       double sampling_time,
+                                       StageTimes* stage_times,
+                                       IKStatistics* ik_statistics)
 {
   ROS_INFO("Start generation of CIRC trajectory!");
+  TraceSpan span("TrajectoryGeneratorCIRC::generate");
+  ScopedPlanMetrics metrics(PlanningMetricsSnapshot::CIRC, res);
 
   ros::Time planning_begin = ros::Time::now();
+  StageStopWatch stop_watch(stage_times);
   moveit_msgs::MoveItErrorCodes error_code;
   MotionPlanInfo plan_info;
-  trajectory_msgs::JointTrajectory joint_trajectory;
+  JointTrajectoryColumns joint_trajectory;
 
   // validate the common requirements of motion plan request
-  if(!validateRequest(req, error_code))
+  const bool valid_request {validateRequest(req, error_code)};
+  stop_watch.lap(STAGE_REQUEST_VALIDATION);
+  if(!valid_request)
   {
     ROS_ERROR("Failed to validate the planning request of a CIRC command.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
   // extract planning information from the motion plan request
-  if(!extractMotionPlanInfo(req, plan_info, error_code))
+  const bool extracted {extractMotionPlanInfo(req, plan_info, error_code, stop_watch, ik_statistics)};
+  stop_watch.lap(STAGE_INFO_EXTRACTION);
+  if(!extracted)
   {
     ROS_ERROR("Cannot extract needed information from motion plan request.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
@@ -84,28 +95,39 @@ bool TrajectoryGeneratorCIRC::generate(const planning_interface::MotionPlanReque
   // with the third parameter set to false, KDL::Trajectory_Segment does not take
   // the ownship of Path and Velocity Profile
   KDL::Trajectory_Segment cart_trajectory(path.get(), vp.get(), false);
+  stop_watch.lap(STAGE_PATH_SETUP);
 
   // sample the Cartesian trajectory and compute joint trajectory using inverse kinematics
+  JointTrajectoryGenerationOptions options;
+  options.terminated = terminated_;
+  options.stop_watch = &stop_watch;
+  options.ik_statistics = ik_statistics;
+  options.start_state = plan_info.start_state.get();
   if(!generateJointTrajectory(robot_model_,
-                              planner_limits_.getJointLimitContainer(),
+                              getJointLimits(plan_info),
                               cart_trajectory,
                               plan_info.group_name,
                               plan_info.link_name,
                               plan_info.start_joint_position,
                               sampling_time,
                               joint_trajectory,
-                              error_code))
+                              error_code,
+                              options))
   {
     ROS_ERROR("Failed to generate valid joint trajectory from the Cartesian path.");
   }
   else
   {
-    ROS_INFO_STREAM("CIRC Trajectory with " << joint_trajectory.points.size() << " Points generated. Took "
+    ROS_INFO_STREAM("CIRC Trajectory with " << joint_trajectory.size() << " Points generated. Took "
                     << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
+
+    fitSpline(joint_trajectory, stop_watch);
   }
 
 
-  return setResponse(req, res, joint_trajectory, error_code, planning_begin);
+  const bool result {setResponse(req, res, joint_trajectory, error_code, planning_begin, plan_info.start_state)};
+  stop_watch.lap(STAGE_CONVERSION);
+  return result;
 }
 
 bool TrajectoryGeneratorCIRC::validateRequest(const planning_interface::MotionPlanRequest &req,
@@ -144,7 +166,9 @@ bool TrajectoryGeneratorCIRC::validateRequest(const planning_interface::MotionPl
 
 bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
                                                     TrajectoryGenerator::MotionPlanInfo &info,
-                                                    moveit_msgs::MoveItErrorCodes &error_code) const
+                                                    moveit_msgs::MoveItErrorCodes &error_code,
+                                                    StageStopWatch& stop_watch,
+                                                    IKStatistics* ik_statistics) const
 {
   ROS_DEBUG("Extract necessary information from motion plan request.");
 
@@ -176,13 +200,6 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
     {
       info.goal_joint_position[joint_item.joint_name] = joint_item.position;
     }
-
-
-      computeLinkFK(robot_model_,
-                    info.link_name,
-                    info.goal_joint_position,
-                    info.goal_pose);
-
   }
   // goal given in Cartesian space
   else
@@ -206,30 +223,42 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
     tf::poseMsgToEigen(goal_pose_msg, info.goal_pose);
   }
 
-  // copy start state only with the joint
-  robot_state::RobotState start_state(robot_model_);
-  start_state.setToDefaultValues();
-  moveit::core::robotStateMsgToRobotState(req.start_state, start_state, false);
+  // parse the start state once, it is used for the kinematics, the joint limits and the response
+  setStartState(req, info);
 
   for(const auto& joint_name : robot_model_->getJointModelGroup(req.group_name)->getActiveJointModelNames())
   {
-    info.start_joint_position[joint_name] = start_state.getVariablePosition(joint_name);
+    info.start_joint_position[joint_name] = info.start_state->getVariablePosition(joint_name);
   }
 
-    computeLinkFK(robot_model_,
+    computeLinkFK(*info.start_state,
                   info.link_name,
                   info.start_joint_position,
                   info.start_pose);
+    stop_watch.lap(STAGE_INFO_EXTRACTION);
+
+    // the goal kinematics are computed on a copy, the start state must stay unchanged
+    robot_state::RobotState goal_state(*info.start_state);
+    if(!info.goal_joint_position.empty())
+    {
+      computeLinkFK(goal_state,
+                    info.link_name,
+                    info.goal_joint_position,
+                    info.goal_pose);
+    }
 
     //check goal pose ik before Cartesian motion plan starts
     std::map<std::string, double> ik_solution;
-    if(!computePoseIK(robot_model_,
+    if(!computePoseIK(goal_state,
                       info.group_name,
                       info.link_name,
                       info.goal_pose,
                       frame_id,
                       info.start_joint_position,
-                      ik_solution))
+                      ik_solution,
+                      true,
+                      DEFAULT_IK_TIMEOUT,
+                      ik_statistics))
     {
       // LCOV_EXCL_START
       ROS_ERROR_STREAM("Failed to compute inverse kinematics for link: " << info.link_name << " of goal pose.");
@@ -237,6 +266,7 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
       return false;
       // LCOV_EXCL_STOP // not able to trigger here since lots of checks before are in place
     }
+    stop_watch.lap(STAGE_GOAL_KINEMATICS);
 
 
   Eigen::Vector3d circ_path_point;
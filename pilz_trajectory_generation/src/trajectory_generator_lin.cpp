@@ -16,6 +16,8 @@
  */
 
 #include "pilz_trajectory_generation/trajectory_generator_lin.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
 #include "ros/ros.h"
 #include "eigen_conversions/eigen_msg.h"
 #include "moveit/robot_state/conversions.h"
@@ -44,23 +46,32 @@ TrajectoryGeneratorLIN::~TrajectoryGeneratorLIN()
 
 bool TrajectoryGeneratorLIN::generate(const planning_interface::MotionPlanRequest &req,
                                       planning_interface::MotionPlanResponse &res,
-                                      double sampling_time)
+                                      double sampling_time,
+                                      StageTimes* stage_times,
+                                      IKStatistics* ik_statistics)
 {
   ROS_INFO("Starting generation of LIN Trajectory!");
+  TraceSpan span("TrajectoryGeneratorLIN::generate");
+  ScopedPlanMetrics metrics(PlanningMetricsSnapshot::LIN, res);
 
   ros::Time planning_begin = ros::Time::now();
+  StageStopWatch stop_watch(stage_times);
   moveit_msgs::MoveItErrorCodes error_code;
   MotionPlanInfo plan_info;
-  trajectory_msgs::JointTrajectory joint_trajectory;
+  JointTrajectoryColumns joint_trajectory;
 
   // validate the common requirements of motion plan request
-  if(!validateRequest(req, error_code))
+  const bool valid_request {validateRequest(req, error_code)};
+  stop_watch.lap(STAGE_REQUEST_VALIDATION);
+  if(!valid_request)
   {
     ROS_ERROR("Failed to validate the planning request of a LIN command.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
   // extract planning information from the motion plan request
-  if(!extractMotionPlanInfo(req, plan_info, error_code))
+  const bool extracted {extractMotionPlanInfo(req, plan_info, error_code, stop_watch, ik_statistics)};
+  stop_watch.lap(STAGE_INFO_EXTRACTION);
+  if(!extracted)
   {
     ROS_ERROR("Failed to extract planning information of a LIN command.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
@@ -76,29 +87,44 @@ bool TrajectoryGeneratorLIN::generate(const planning_interface::MotionPlanReques
   // with the third parameter set to false, KDL::Trajectory_Segment does not take
   // the ownship of Path and Velocity Profile
   KDL::Trajectory_Segment cart_trajectory(path.get(), vp.get(), false);
+  stop_watch.lap(STAGE_PATH_SETUP);
 
   // sample the Cartesian trajectory and compute joint trajectory using inverse kinematics
+  JointTrajectoryGenerationOptions options;
+  options.terminated = terminated_;
+  options.stop_watch = &stop_watch;
+  options.ik_statistics = ik_statistics;
+  options.start_state = plan_info.start_state.get();
   if(!generateJointTrajectory(robot_model_,
-                              planner_limits_.getJointLimitContainer(),
+                              getJointLimits(plan_info),
                               cart_trajectory,
                               plan_info.group_name,
                               plan_info.link_name,
                               plan_info.start_joint_position,
                               sampling_time,
                               joint_trajectory,
-                              error_code))
+                              error_code,
+                              options))
   {
     ROS_ERROR("Failed to generate valid joint trajectory from the Cartesian path.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
 
-  ROS_INFO_STREAM("LIN Trajectory with " << joint_trajectory.points.size() << " Points generated. Took "
+  ROS_INFO_STREAM("LIN Trajectory with " << joint_trajectory.size() << " Points generated. Took "
                   << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
 
-  return setResponse(req, res, joint_trajectory, error_code, planning_begin);
+  fitSpline(joint_trajectory, stop_watch);
+
+  const bool result {setResponse(req, res, joint_trajectory, error_code, planning_begin, plan_info.start_state)};
+  stop_watch.lap(STAGE_CONVERSION);
+  return result;
 }
 
-bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req, TrajectoryGenerator::MotionPlanInfo &info, moveit_msgs::MoveItErrorCodes &error_code) const
+bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
+                                                   TrajectoryGenerator::MotionPlanInfo &info,
+                                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                                   StageStopWatch& stop_watch,
+                                                   IKStatistics* ik_statistics) const
 {
   ROS_DEBUG("Extract necessary information from motion plan request.");
 
@@ -122,9 +148,6 @@ bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
     {
       info.goal_joint_position[joint_item.joint_name] = joint_item.position;
     }
-
-    // Ignored return value because at this point the function should always return 'true'.
-    computeLinkFK(robot_model_, info.link_name, info.goal_joint_position, info.goal_pose);
   }
   // goal given in Cartesian space
   else
@@ -148,33 +171,44 @@ bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
     tf::poseMsgToEigen(goal_pose_msg, info.goal_pose);
   }
 
-  // copy start state only with the joint
-  robot_state::RobotState start_state(robot_model_);
-  start_state.setToDefaultValues();
-  moveit::core::robotStateMsgToRobotState(req.start_state, start_state, false);
+  // parse the start state once, it is used for the kinematics, the joint limits and the response
+  setStartState(req, info);
 
   for(const auto& joint_name : robot_model_->getJointModelGroup(req.group_name)->getActiveJointModelNames())
   {
-    info.start_joint_position[joint_name] = start_state.getVariablePosition(joint_name);
+    info.start_joint_position[joint_name] = info.start_state->getVariablePosition(joint_name);
   }
 
   // Ignored return value because at this point the function should always return 'true'.
-  computeLinkFK(robot_model_, info.link_name, info.start_joint_position, info.start_pose);
+  computeLinkFK(*info.start_state, info.link_name, info.start_joint_position, info.start_pose);
+  stop_watch.lap(STAGE_INFO_EXTRACTION);
+
+  // the goal kinematics are computed on a copy, the start state must stay unchanged
+  robot_state::RobotState goal_state(*info.start_state);
+  if(!info.goal_joint_position.empty())
+  {
+    // Ignored return value because at this point the function should always return 'true'.
+    computeLinkFK(goal_state, info.link_name, info.goal_joint_position, info.goal_pose);
+  }
 
   //check goal pose ik before Cartesian motion plan starts
   std::map<std::string, double> ik_solution;
-  if(!computePoseIK(robot_model_,
+  if(!computePoseIK(goal_state,
                     info.group_name,
                     info.link_name,
                     info.goal_pose,
                     frame_id,
                     info.start_joint_position,
-                    ik_solution))
+                    ik_solution,
+                    true,
+                    DEFAULT_IK_TIMEOUT,
+                    ik_statistics))
   {
     ROS_ERROR_STREAM("Failed to compute inverse kinematics for link: " << info.link_name << " of goal pose.");
     error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
     return false;
   }
+  stop_watch.lap(STAGE_GOAL_KINEMATICS);
 
   return true;
 }
@@ -16,18 +16,25 @@
  */
 
 #include "pilz_trajectory_generation/trajectory_generator_ptp.h"
+#include "pilz_trajectory_generation/planning_metrics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
 #include "ros/ros.h"
 #include "eigen_conversions/eigen_msg.h"
 #include "moveit/robot_state/conversions.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
 namespace pilz {
 
 TrajectoryGeneratorPTP::TrajectoryGeneratorPTP(const robot_model::RobotModelConstPtr& robot_model,
-                                               const LimitsContainer &planner_limits)
-  :TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits)
+                                               const LimitsContainer &planner_limits,
+                                               const MostStrictLimitsConstPtr& most_strict_limits)
+  :TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits),
+    most_strict_limits_(most_strict_limits ? most_strict_limits
+                                           : computeMostStrictLimits(robot_model,
+                                                                     planner_limits.getJointLimitContainer()))
 {
 
   if(!planner_limits_.hasJointLimits())
@@ -35,95 +42,177 @@ TrajectoryGeneratorPTP::TrajectoryGeneratorPTP(const robot_model::RobotModelCons
     throw TrajectoryGeneratorInvalidLimitsException("joint limit not set");
   }
 
-  joint_limits_ = planner_limits_.getJointLimitContainer();
+  ROS_INFO("Initialized Point-to-Point Trajectory Generator.");
+}
+
+TrajectoryGeneratorPTP::~TrajectoryGeneratorPTP()
+{
+}
 
-  // collect most strict joint limits for each group in robot model
+MostStrictLimitsConstPtr TrajectoryGeneratorPTP::computeMostStrictLimits(
+    const robot_model::RobotModelConstPtr& robot_model,
+    const JointLimitsContainer& joint_limits)
+{
+  std::shared_ptr<MostStrictLimits> most_strict_limits {std::make_shared<MostStrictLimits>()};
   for(const auto& jmg : robot_model->getJointModelGroups())
   {
-    pilz_extensions::JointLimit most_strict_limit = joint_limits_.getCommonLimit(jmg->getActiveJointModelNames());
-
-    if(!most_strict_limit.has_velocity_limits)
+    try
     {
-      ROS_ERROR_STREAM("velocity limit not set for group " << jmg->getName());
-      throw TrajectoryGeneratorInvalidLimitsException("velocity limit not set for group " + jmg->getName());
+      most_strict_limits->insert(std::make_pair(jmg->getName(),
+                                                computeMostStrictLimit(robot_model, joint_limits, jmg->getName())));
     }
-    if(!most_strict_limit.has_acceleration_limits)
+    catch(const TrajectoryGeneratorInvalidLimitsException& ex)
     {
-      ROS_ERROR_STREAM("acceleration limit not set for group " << jmg->getName());
-      throw TrajectoryGeneratorInvalidLimitsException("acceleration limit not set for group " + jmg->getName());
-    }
-    if(!most_strict_limit.has_deceleration_limits)
-    {
-      ROS_ERROR_STREAM("deceleration limit not set for group " << jmg->getName());
-      throw TrajectoryGeneratorInvalidLimitsException("deceleration limit not set for group " + jmg->getName());
+      ROS_DEBUG_STREAM("No PTP planning for group " << jmg->getName() << ": " << ex.what());
     }
+  }
+  return most_strict_limits;
+}
+
+pilz_extensions::JointLimit TrajectoryGeneratorPTP::computeMostStrictLimit(
+    const robot_model::RobotModelConstPtr& robot_model,
+    const JointLimitsContainer& joint_limits,
+    const std::string& group_name)
+{
+  pilz_extensions::JointLimit most_strict_limit;
+  try
+  {
+    most_strict_limit = joint_limits.getCommonLimit(
+          robot_model->getJointModelGroup(group_name)->getActiveJointModelNames());
+  }
+  catch(const std::out_of_range&)
+  {
+    throw TrajectoryGeneratorInvalidLimitsException("joint limits missing for joints of group " + group_name);
+  }
 
-    most_strict_limits_.insert(std::pair<std::string, pilz_extensions::JointLimit>(jmg->getName(), most_strict_limit));
+  if(!most_strict_limit.has_velocity_limits)
+  {
+    throw TrajectoryGeneratorInvalidLimitsException("velocity limit not set for group " + group_name);
+  }
+  if(!most_strict_limit.has_acceleration_limits)
+  {
+    throw TrajectoryGeneratorInvalidLimitsException("acceleration limit not set for group " + group_name);
+  }
+  if(!most_strict_limit.has_deceleration_limits)
+  {
+    throw TrajectoryGeneratorInvalidLimitsException("deceleration limit not set for group " + group_name);
   }
 
-  ROS_INFO("Initialized Point-to-Point Trajectory Generator.");
+  return most_strict_limit;
 }
 
-TrajectoryGeneratorPTP::~TrajectoryGeneratorPTP()
+pilz_extensions::JointLimit TrajectoryGeneratorPTP::getMostStrictLimit(const MotionPlanInfo& info) const
 {
+  const std::string& group_name {info.group_name};
+  if(info.start_state_joint_limits)
+  {
+    // the limits depend on the start state, the shared limits only hold for the static joint limits
+    return computeMostStrictLimit(robot_model_, *info.start_state_joint_limits, group_name);
+  }
+
+  const auto it = most_strict_limits_->find(group_name);
+  if(it == most_strict_limits_->end())
+  {
+    // throws the reason why the group was left out
+    computeMostStrictLimit(robot_model_, planner_limits_.getJointLimitContainer(), group_name);
+    throw TrajectoryGeneratorInvalidLimitsException("no most strict limit for group " + group_name);
+  }
+  return it->second;
 }
 
 bool TrajectoryGeneratorPTP::generate(const planning_interface::MotionPlanRequest &req,
                                       planning_interface::MotionPlanResponse& res,
-                                      double sampling_time)
+                                      double sampling_time,
+                                      StageTimes* stage_times,
+                                      IKStatistics* ik_statistics)
 {
   ROS_INFO("Starting generation of PTP Trajectory!");
+  TraceSpan span("TrajectoryGeneratorPTP::generate");
+  ScopedPlanMetrics metrics(PlanningMetricsSnapshot::PTP, res);
 
   // planning data
   ros::Time planning_begin = ros::Time::now();
+  StageStopWatch stop_watch(stage_times);
   MotionPlanInfo plan_info;
   moveit_msgs::MoveItErrorCodes error_code;
 
 
   // validate the common requirements of motion plan request
-  if(!validateRequest(req, error_code) )
+  const bool valid_request {validateRequest(req, error_code)};
+  stop_watch.lap(STAGE_REQUEST_VALIDATION);
+  if(!valid_request)
   {
-    trajectory_msgs::JointTrajectory joint_trajectory_empty;
-    setResponse(req, res, joint_trajectory_empty, error_code, planning_begin);
+    setResponse(req, res, JointTrajectoryColumns(), error_code, planning_begin);
     return false;
   }
 
   // extract planning information from the motion plan request
-  if(!extractMotionPlanInfo(req, plan_info, error_code))
+  const bool extracted {extractMotionPlanInfo(req, plan_info, error_code, stop_watch, ik_statistics)};
+  stop_watch.lap(STAGE_INFO_EXTRACTION);
+  if(!extracted)
   {
     res.error_code_ = error_code;
-    trajectory_msgs::JointTrajectory joint_trajectory_empty;
-    setResponse(req, res, joint_trajectory_empty, error_code, planning_begin);
+    setResponse(req, res, JointTrajectoryColumns(), error_code, planning_begin);
+    return false;
+  }
+
+  // obtain the most strict limit of the planning group
+  pilz_extensions::JointLimit most_strict_limit;
+  try
+  {
+    most_strict_limit = getMostStrictLimit(plan_info);
+  }
+  catch(const TrajectoryGeneratorInvalidLimitsException& ex)
+  {
+    ROS_ERROR_STREAM(ex.what());
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    setResponse(req, res, JointTrajectoryColumns(), error_code, planning_begin);
     return false;
   }
 
+  stop_watch.lap(STAGE_PATH_SETUP);
+
   // plan the ptp trajectory
-  trajectory_msgs::JointTrajectory joint_trajectory;
-  planPTP(plan_info.start_joint_position, plan_info.goal_joint_position, joint_trajectory, plan_info.group_name,
-          req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor, sampling_time);
+  JointTrajectoryColumns joint_trajectory;
+  const bool planned {planPTP(plan_info.start_joint_position, plan_info.goal_joint_position, joint_trajectory,
+                              most_strict_limit, req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor,
+                              sampling_time)};
+  stop_watch.lap(STAGE_SAMPLING);
+  if(!planned)
+  {
+    ROS_INFO("Generation of the PTP trajectory was terminated.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+    joint_trajectory.clear();
+    setResponse(req, res, joint_trajectory, error_code, planning_begin);
+    return false;
+  }
 
-  ROS_INFO_STREAM("PTP Trajectory with " << joint_trajectory.points.size() << " Points generated. Took "
+  ROS_INFO_STREAM("PTP Trajectory with " << joint_trajectory.size() << " Points generated. Took "
                   << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
 
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
-  setResponse(req, res, joint_trajectory, error_code, planning_begin);
+  setResponse(req, res, joint_trajectory, error_code, planning_begin, plan_info.start_state);
+  stop_watch.lap(STAGE_CONVERSION);
   return true;
 }
 
 
-void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_pos,
+bool TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_pos,
                                      const std::map<std::string, double>& goal_pos,
-                                     trajectory_msgs::JointTrajectory &joint_trajectory,
-                                     const std::string &group_name,
+                                     JointTrajectoryColumns &joint_trajectory,
+                                     const pilz_extensions::JointLimit &most_strict_limit,
                                      const double &velocity_scaling_factor,
                                      const double &acceleration_scaling_factor,
                                      const double &sampling_time)
 {
   // initialize joint names
+  std::vector<std::string> joint_names;
+  joint_names.reserve(goal_pos.size());
   for(const auto& item : goal_pos)
   {
-    joint_trajectory.joint_names.push_back(item.first);
+    joint_names.push_back(item.first);
   }
+  joint_trajectory.setJointNames(joint_names);
 
   // check if goal already reached
   bool goal_reached = true;
@@ -138,35 +227,31 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   if(goal_reached)
   {
     ROS_INFO_STREAM("Goal already reached, set one goal point explicitly.");
-    if(joint_trajectory.points.empty())
+    std::vector<double> positions;
+    positions.reserve(joint_names.size());
+    for(const std::string & joint_name : joint_names)
     {
-      trajectory_msgs::JointTrajectoryPoint point;
-      point.time_from_start =  ros::Duration(sampling_time);
-      for(const std::string & joint_name : joint_trajectory.joint_names)
-      {
-        point.positions.push_back(start_pos.at(joint_name));
-        point.velocities.push_back(0);
-        point.accelerations.push_back(0);
-      }
-      joint_trajectory.points.push_back(point);
+      positions.push_back(start_pos.at(joint_name));
     }
-    return;
+    const std::vector<double> zeros(joint_names.size(), 0.0);
+    joint_trajectory.addPoint(sampling_time, positions, zeros, zeros);
+    return true;
   }
 
   // compute the fastest trajectory and choose the slowest joint as leading axis
-  std::string leading_axis = joint_trajectory.joint_names.front();
+  std::string leading_axis = joint_names.front();
   double max_duration = -1.0;
 
   std::map<std::string, VelocityProfile_ATrap> velocity_profile;
-  for(const auto& joint_name : joint_trajectory.joint_names)
+  for(const auto& joint_name : joint_names)
   {
     // create vecocity profile if necessary
     velocity_profile.insert(std::make_pair(
                               joint_name,
                               VelocityProfile_ATrap(
-                                velocity_scaling_factor * most_strict_limits_.at(group_name).max_velocity,
-                                acceleration_scaling_factor * most_strict_limits_.at(group_name).max_acceleration,
-                                acceleration_scaling_factor * most_strict_limits_.at(group_name).max_deceleration)));
+                                velocity_scaling_factor * most_strict_limit.max_velocity,
+                                acceleration_scaling_factor * most_strict_limit.max_acceleration,
+                                acceleration_scaling_factor * most_strict_limit.max_deceleration)));
 
     velocity_profile.at(joint_name).SetProfile(start_pos.at(joint_name), goal_pos.at(joint_name));
     if(velocity_profile.at(joint_name).Duration() > max_duration)
@@ -183,7 +268,7 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   double const_time = velocity_profile.at(leading_axis).SecondPhaseDuration();
   double dec_time = velocity_profile.at(leading_axis).ThirdPhaseDuration();
 
-  for(const auto& joint_name : joint_trajectory.joint_names)
+  for(const auto& joint_name : joint_names)
   {
     if(joint_name != leading_axis)
     {
@@ -203,45 +288,91 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
     }
   }
 
-  // first generate the time samples
+  // first generate the time samples, only the knots of the phases if the spline output is enabled
   std::vector<double> time_samples;
-  for(double t_sample=0.0; t_sample<max_duration; t_sample+=sampling_time)
+  if(spline_tolerance_ > 0.)
+  {
+    time_samples = getSplineKnotTimes(acc_time, const_time, dec_time);
+  }
+  else
   {
-    time_samples.push_back(t_sample);
+    for(double t_sample=0.0; t_sample<max_duration; t_sample+=sampling_time)
+    {
+      time_samples.push_back(t_sample);
+    }
+    // add last time
+    time_samples.push_back(max_duration);
   }
-  // add last time
-  time_samples.push_back(max_duration);
 
-  // construct joint trajectory point
+  // construct joint trajectory point, the profiles are resolved once and the point buffers are reused
+  std::vector<const VelocityProfile_ATrap*> joint_profiles;
+  joint_profiles.reserve(joint_names.size());
+  for(const auto& joint_name : joint_names)
+  {
+    joint_profiles.push_back(&velocity_profile.at(joint_name));
+  }
+  std::vector<double> positions(joint_names.size()), velocities(joint_names.size()),
+      accelerations(joint_names.size());
+  joint_trajectory.reserve(time_samples.size());
   for(double time_stamp : time_samples)
   {
-    trajectory_msgs::JointTrajectoryPoint point;
-    point.time_from_start =  ros::Duration(time_stamp);
-    for(std::string & joint_name : joint_trajectory.joint_names)
+    if(isTerminated(terminated_))
+    {
+      return false;
+    }
+
+    for(std::size_t i = 0; i < joint_profiles.size(); ++i)
     {
-      point.positions.push_back(velocity_profile.at(joint_name).Pos(time_stamp));
-      point.velocities.push_back(velocity_profile.at(joint_name).Vel(time_stamp));
-      point.accelerations.push_back(velocity_profile.at(joint_name).Acc(time_stamp));
+      positions[i] = joint_profiles[i]->Pos(time_stamp);
+      velocities[i] = joint_profiles[i]->Vel(time_stamp);
+      accelerations[i] = joint_profiles[i]->Acc(time_stamp);
     }
-    joint_trajectory.points.push_back(point);
+    joint_trajectory.addPoint(time_stamp, positions, velocities, accelerations);
   }
 
   // Set last point velocity and acceleration to zero
-  std::fill(joint_trajectory.points.back().velocities.begin(),
-            joint_trajectory.points.back().velocities.end(),
-            0.0);
-  std::fill(joint_trajectory.points.back().accelerations.begin(),
-            joint_trajectory.points.back().accelerations.end(),
-            0.0);
+  joint_trajectory.setLastPointAtRest();
+  return true;
 }
 
 
+std::vector<double> TrajectoryGeneratorPTP::getSplineKnotTimes(double acc_time, double const_time, double dec_time)
+{
+  // Each phase is a polynomial of at most second order, which a quintic segment between two knots of the same phase
+  // reproduces exactly. The acceleration jumps between the phases, so the phases are connected by short transition
+  // segments with one knot on each side of the phase boundary.
+  std::vector<double> knot_times {0.0};
+  double phase_start {0.0};
+  for(const double phase_duration : {acc_time, const_time, dec_time})
+  {
+    if(phase_duration <= 0.0)
+    {
+      continue;
+    }
+    const double margin {std::min(SPLINE_TRANSITION_TIME / 2.0, phase_duration / 4.0)};
+    if(phase_start > 0.0)
+    {
+      knot_times.push_back(phase_start + margin);
+    }
+    knot_times.push_back(phase_start + phase_duration - margin);
+    phase_start += phase_duration;
+  }
+  // the last knot is at rest, so the deceleration is ended by a transition segment as well
+  knot_times.push_back(phase_start);
+  return knot_times;
+}
+
 bool TrajectoryGeneratorPTP::extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
                                                    MotionPlanInfo& info,
-                                                   moveit_msgs::MoveItErrorCodes& error_code) const
+                                                   moveit_msgs::MoveItErrorCodes& error_code,
+                                                   StageStopWatch& stop_watch,
+                                                   IKStatistics* ik_statistics) const
 {
   info.group_name = req.group_name;
 
+  // parse the start state once, it is used for the kinematics, the joint limits and the response
+  setStartState(req, info);
+
   // extract start state information
   info.start_joint_position.clear();
   for(std::size_t i=0; i<req.start_state.joint_state.name.size(); ++i)
@@ -274,18 +405,25 @@ bool TrajectoryGeneratorPTP::extractMotionPlanInfo(const planning_interface::Mot
     Eigen::Isometry3d pose_eigen;
     normalizeQuaternion(pose.orientation);
     tf::poseMsgToEigen(pose,pose_eigen);
-    if(!computePoseIK(robot_model_,
+    stop_watch.lap(STAGE_INFO_EXTRACTION);
+    // the inverse kinematics are computed on a copy, the start state must stay unchanged
+    robot_state::RobotState goal_state(*info.start_state);
+    if(!computePoseIK(goal_state,
                       req.group_name,
                       req.goal_constraints.at(0).position_constraints.at(0).link_name,
                       pose_eigen,
                       robot_model_->getModelFrame(),
                       info.start_joint_position,
-                      info.goal_joint_position))
+                      info.goal_joint_position,
+                      true,
+                      DEFAULT_IK_TIMEOUT,
+                      ik_statistics))
     {
       ROS_ERROR("No IK solution for goal pose.");
       error_code.val =  moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
       return false;
     }
+    stop_watch.lap(STAGE_GOAL_KINEMATICS);
   }
 
   return true;
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "allocation_counter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+namespace
+{
+
+/// Counts of the current thread, only incremented while an AllocationCounter is active
+struct ThreadAllocations
+{
+  bool active {false};
+  std::size_t allocations {0};
+  std::size_t bytes {0};
+  /// Usable bytes allocated minus usable bytes freed, negative if memory allocated before was freed
+  std::int64_t live_bytes {0};
+  std::int64_t peak_bytes {0};
+};
+
+// Trivially constructible, so that it is usable in operator new at any time
+thread_local ThreadAllocations thread_allocations;
+
+void* allocate(std::size_t size)
+{
+  if(thread_allocations.active)
+  {
+    ++thread_allocations.allocations;
+    thread_allocations.bytes += size;
+  }
+
+  // malloc(0) may return nullptr, but operator new has to return a unique pointer
+  void* ptr {std::malloc(size == 0 ? 1 : size)};
+  if(thread_allocations.active && ptr)
+  {
+    thread_allocations.live_bytes += static_cast<std::int64_t>(malloc_usable_size(ptr));
+    thread_allocations.peak_bytes = std::max(thread_allocations.peak_bytes, thread_allocations.live_bytes);
+  }
+  return ptr;
+}
+
+void deallocate(void* ptr)
+{
+  if(thread_allocations.active && ptr)
+  {
+    thread_allocations.live_bytes -= static_cast<std::int64_t>(malloc_usable_size(ptr));
+  }
+  std::free(ptr);
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+  void* ptr {allocate(size)};
+  if(!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+  void* ptr {allocate(size)};
+  if(!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  deallocate(ptr);
+}
+
+namespace testutils
+{
+
+AllocationCounter::AllocationCounter()
+{
+  thread_allocations = ThreadAllocations();
+  thread_allocations.active = true;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+  stop();
+}
+
+void AllocationCounter::stop()
+{
+  if(stopped_)
+  {
+    return;
+  }
+  thread_allocations.active = false;
+  allocations_ = thread_allocations.allocations;
+  bytes_ = thread_allocations.bytes;
+  peak_bytes_ = static_cast<std::size_t>(thread_allocations.peak_bytes);
+  stopped_ = true;
+}
+
+std::size_t AllocationCounter::getAllocations() const
+{
+  return stopped_ ? allocations_ : thread_allocations.allocations;
+}
+
+std::size_t AllocationCounter::getBytes() const
+{
+  return stopped_ ? bytes_ : thread_allocations.bytes;
+}
+
+std::size_t AllocationCounter::getPeakBytes() const
+{
+  return stopped_ ? peak_bytes_ : static_cast<std::size_t>(thread_allocations.peak_bytes);
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+namespace testutils
+{
+
+/**
+ * @brief Counts the heap allocations of the current thread during its lifetime.
+ *
+ * Counting requires the replacement of the global operator new in allocation_counter.cpp, which has to be compiled
+ * into the test executable (not into a library, the replacement affects the whole process). Allocations of other
+ * threads are not counted. Counters can not be nested.
+ * Besides the allocations the counter tracks the peak of the bytes allocated and not yet freed by the current thread.
+ */
+class AllocationCounter
+{
+public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  /**
+   * @brief Stops counting, the counts are kept.
+   */
+  void stop();
+
+  /**
+   * @return the number of calls of operator new since the construction
+   */
+  std::size_t getAllocations() const;
+
+  /**
+   * @return the number of bytes requested from operator new since the construction
+   */
+  std::size_t getBytes() const;
+
+  /**
+   * @return the highest number of bytes (as usable size of the blocks) allocated by operator new and not yet freed by
+   * operator delete since the construction. Freeing memory allocated before the construction lowers the count.
+   */
+  std::size_t getPeakBytes() const;
+
+private:
+  bool stopped_ {false};
+  std::size_t allocations_ {0};
+  std::size_t bytes_ {0};
+  std::size_t peak_bytes_ {0};
+};
+
+}
+
+#endif // ALLOCATION_COUNTER_H
@@ -27,6 +27,7 @@
 #include <tf2_eigen/tf2_eigen.h>
 #include "test_utils.h"
 
+#include "pilz_trajectory_generation/capability_names.h"
 #include "pilz_trajectory_generation/command_list_manager.h"
 
 #include "motion_plan_request_builder.h"
@@ -320,6 +321,58 @@ TEST_P(IntegrationTestCommandListManager, blendTwoSegments)
   pub.publish(displayTrajectory);
 }
 
+/**
+ * @brief Checks that the limits can be reloaded at runtime and that invalid limits are rejected.
+ *
+ *  - Test Sequence:
+ *    1. Reload the unchanged limits.
+ *    2. Set a velocity limit exceeding the bounds of the robot model and reload the limits. Blend two segments.
+ *    3. Restore the velocity limit and reload the limits.
+ *
+ *  - Expected Results:
+ *    1. Reloading succeeds.
+ *    2. Reloading fails, blending succeeds with the previous limits.
+ *    3. Reloading succeeds.
+ */
+TEST_P(IntegrationTestCommandListManager, reloadLimits)
+{
+  EXPECT_TRUE(manager_->reloadLimits());
+
+  const std::string joint_name {
+    robot_model_->getJointModelGroup(planning_group_)->getActiveJointModelNames().front()};
+  ros::NodeHandle limits_nh {"robot_description_planning/joint_limits/" + joint_name};
+  bool has_velocity_limits {false};
+  double max_velocity {0.};
+  const bool has_velocity_limits_param {limits_nh.getParam("has_velocity_limits", has_velocity_limits)};
+  const bool max_velocity_param {limits_nh.getParam("max_velocity", max_velocity)};
+
+  limits_nh.setParam("has_velocity_limits", true);
+  limits_nh.setParam("max_velocity", 1.0e6);
+  EXPECT_FALSE(manager_->reloadLimits());
+
+  planning_interface::MotionPlanResponse res;
+  EXPECT_TRUE(manager_->solve(scene_, blend_command_lin_lin_, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val);
+
+  if(has_velocity_limits_param)
+  {
+    limits_nh.setParam("has_velocity_limits", has_velocity_limits);
+  }
+  else
+  {
+    limits_nh.deleteParam("has_velocity_limits");
+  }
+  if(max_velocity_param)
+  {
+    limits_nh.setParam("max_velocity", max_velocity);
+  }
+  else
+  {
+    limits_nh.deleteParam("max_velocity");
+  }
+  EXPECT_TRUE(manager_->reloadLimits());
+}
+
 // ------------------
 // FAILURE cases
 // ------------------
@@ -343,6 +396,85 @@ TEST_P(IntegrationTestCommandListManager, emptyList)
   EXPECT_EQ(0u, res.trajectory_->getWayPointCount());
 }
 
+/**
+ * @brief Checks that a terminate() before solve() aborts the solve, but not the following ones
+ *
+ *  - Test Sequence:
+ *    1. Terminate, then solve a sequence.
+ *    2. Solve the sequence again.
+ *    3. Terminate, withdraw the termination, then solve the sequence.
+ *
+ *  - Expected Results:
+ *    1. solving fails with PREEMPTED
+ *    2. solving is successful
+ *    3. solving is successful
+ */
+TEST_P(IntegrationTestCommandListManager, terminateBeforeSolve)
+{
+  planning_interface::MotionPlanResponse res;
+  manager_->terminate();
+  EXPECT_FALSE(manager_->solve(scene_, blend_command_lin_lin_, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PREEMPTED, res.error_code_.val);
+
+  planning_interface::MotionPlanResponse second_res;
+  EXPECT_TRUE(manager_->solve(scene_, blend_command_lin_lin_, second_res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, second_res.error_code_.val);
+
+  manager_->terminate();
+  manager_->resetTermination();
+  planning_interface::MotionPlanResponse third_res;
+  EXPECT_TRUE(manager_->solve(scene_, blend_command_lin_lin_, third_res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, third_res.error_code_.val);
+}
+
+/**
+ * @brief Checks that the sequences are planned from uniform samples, even if the planner is configured
+ * to emit splines.
+ *
+ *  - Test Sequence:
+ *    1. Configure a spline output tolerance for the planner and create a new manager.
+ *    2. Solve a sequence with a single command.
+ *    3. Solve a sequence with a blend.
+ *
+ *  - Expected Results:
+ *    1. -
+ *    2. solving is successful, all durations except the last one are equal
+ *    3. solving is successful
+ */
+TEST_P(IntegrationTestCommandListManager, splineOutputForcedToSamples)
+{
+  /**********/
+  /* Step 1 */
+  /**********/
+  ph_.setParam(pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME, 0.01);
+  pilz_trajectory_generation::CommandListManager manager(ph_, robot_model_);
+  ph_.deleteParam(pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME);
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  MotionSequenceRequestBuilder seq_request_builder;
+  planning_interface::MotionPlanResponse res_single;
+  ASSERT_TRUE(manager.solve(scene_, seq_request_builder.build({ {req_lin1_, 0} }), res_single));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res_single.error_code_.val);
+
+  const robot_trajectory::RobotTrajectory& samples {*res_single.trajectory_};
+  ASSERT_GT(samples.getWayPointCount(), 3u);
+  const double sampling_time {samples.getWayPointDurationFromPrevious(1)};
+  for(std::size_t i = 2; i < samples.getWayPointCount() - 1; ++i)
+  {
+    EXPECT_NEAR(sampling_time, samples.getWayPointDurationFromPrevious(i), 1e-9) << "Waypoint " << i;
+  }
+
+  /**********/
+  /* Step 3 */
+  /**********/
+  planning_interface::MotionPlanResponse res_blend;
+  EXPECT_TRUE(manager.solve(scene_, blend_command_lin_lin_, res_blend));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res_blend.error_code_.val);
+  EXPECT_GT(res_blend.trajectory_->getWayPointCount(), 0u);
+}
+
 /**
  * @brief
  * Sends a blending request. Checks if response is obtained and
@@ -431,6 +431,68 @@ TEST_F(IntegrationTestSequenceAction, TestPlanOnlyFlag)
 }
 
 
+/**
+ * @brief Tests that the result contains the durations of the planning stages.
+ *
+ * Test Sequence:
+ *    1. Send a plan only goal with two commands.
+ *    2. Evaluate the result.
+ *
+ * Expected Results:
+ *    1. Goal is sent to the action server.
+ *    2. Error code of the result is success, the planning stage is reported.
+ */
+TEST_F(IntegrationTestSequenceAction, TestProcessingTimes)
+{
+  Sequence seq {data_loader_->getSequence("ComplexSequence")};
+  seq.erase(2, seq.size());
+
+  pilz_msgs::MoveGroupSequenceGoal seq_goal;
+  seq_goal.planning_options.plan_only = true;
+  seq_goal.request = seq.toRequest();
+
+  ac_.sendGoalAndWait(seq_goal);
+  pilz_msgs::MoveGroupSequenceResultConstPtr res = ac_.getResult();
+  EXPECT_EQ(res->error_code.val, moveit_msgs::MoveItErrorCodes::SUCCESS) << "Sequence planning failed.";
+
+  ASSERT_EQ(res->processing_stages.size(), res->processing_times.size());
+  EXPECT_THAT(res->processing_stages, ::testing::Contains("planning"));
+  EXPECT_THAT(res->processing_times, ::testing::Each(::testing::Ge(0.)));
+}
+
+/**
+ * @brief Tests that the result contains the resources used by the planning.
+ *
+ * Test Sequence:
+ *    1. Send a plan only goal with two commands.
+ *    2. Evaluate the result.
+ *
+ * Expected Results:
+ *    1. Goal is sent to the action server.
+ *    2. Error code of the result is success, CPU time is reported, the trajectory holds at least the positions,
+ *       velocities and accelerations of all points, no point is removed by the decimation.
+ */
+TEST_F(IntegrationTestSequenceAction, TestResourceUsage)
+{
+  Sequence seq {data_loader_->getSequence("ComplexSequence")};
+  seq.erase(2, seq.size());
+
+  pilz_msgs::MoveGroupSequenceGoal seq_goal;
+  seq_goal.planning_options.plan_only = true;
+  seq_goal.request = seq.toRequest();
+
+  ac_.sendGoalAndWait(seq_goal);
+  pilz_msgs::MoveGroupSequenceResultConstPtr res = ac_.getResult();
+  EXPECT_EQ(res->error_code.val, moveit_msgs::MoveItErrorCodes::SUCCESS) << "Sequence planning failed.";
+
+  EXPECT_GT(res->planning_cpu_time, 0.);
+  const trajectory_msgs::JointTrajectory& trajectory {res->planned_trajectory.joint_trajectory};
+  ASSERT_FALSE(trajectory.points.empty());
+  EXPECT_GE(res->trajectory_bytes, trajectory.points.size() * trajectory.joint_names.size() * 3 * sizeof(double));
+  // the decimation is disabled in the test configuration
+  EXPECT_EQ(1., res->trajectory_compression_ratio);
+}
+
 /**
  * @brief  Tests that robot state in planning_scene_diff is
  * ignored (Mainly for full coverage) in case "plan only" flag is set.
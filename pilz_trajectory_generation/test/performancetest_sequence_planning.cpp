@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include <ros/ros.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include <pilz_industrial_motion_testutils/xml_testdata_loader.h>
+#include <pilz_industrial_motion_testutils/sequence.h>
+
+#include "pilz_msgs/GetMotionSequence.h"
+#include "pilz_trajectory_generation/capability_names.h"
+
+#include "benchmark_utils.h"
+
+// Parameters from parameter server
+const std::string TEST_DATA_FILE_NAME("testdata_file_name");
+const std::string PARAM_SEQUENCES("sequences");
+const std::string PARAM_LATENCY_BUDGETS("latency_budgets");
+const std::string PARAM_THROUGHPUT_BUDGETS("throughput_budgets");
+const std::string PARAM_BUDGET_TOLERANCE("budget_tolerance");
+const std::string PARAM_REPETITIONS("repetitions");
+
+// Iterations of one calibration run and number of calibration runs
+static constexpr unsigned int CALIBRATION_ITERATIONS {200000};
+static constexpr unsigned int CALIBRATION_RUNS {7};
+
+using namespace pilz_industrial_motion_testutils;
+
+/**
+ * @brief Guards the planning latency of the sequence service against regressions.
+ *
+ * The times are measured in calibration units, the median duration of a fixed CPU bound loop on the same machine.
+ * This way the budgets stored in the .test file of the robot model hold on faster and slower machines alike.
+ */
+class PerformanceTestSequencePlanning : public ::testing::Test
+{
+protected:
+  void SetUp() override;
+
+  /**
+   * @brief Runs the calibration loop several times.
+   * @return the median duration of a run in seconds
+   */
+  static double calibrate();
+
+protected:
+  ros::NodeHandle ph_ {"~"};
+  ros::ServiceClient client_;
+  robot_model::RobotModelPtr robot_model_;
+  TestdataLoaderUPtr data_loader_;
+
+  std::vector<std::string> sequences_;
+  std::map<std::string, double> latency_budgets_;
+  std::map<std::string, double> throughput_budgets_;
+  double budget_tolerance_ {1.};
+  int repetitions_ {11};
+};
+
+void PerformanceTestSequencePlanning::SetUp()
+{
+  std::string test_data_file_name;
+  ASSERT_TRUE(ph_.getParam(TEST_DATA_FILE_NAME, test_data_file_name));
+  ASSERT_TRUE(ph_.getParam(PARAM_SEQUENCES, sequences_));
+  ASSERT_FALSE(sequences_.empty()) << "No sequences to measure.";
+  // sequences without budget fail and report their measured values
+  ph_.getParam(PARAM_LATENCY_BUDGETS, latency_budgets_);
+  ph_.getParam(PARAM_THROUGHPUT_BUDGETS, throughput_budgets_);
+  ph_.param(PARAM_BUDGET_TOLERANCE, budget_tolerance_, budget_tolerance_);
+  ph_.param(PARAM_REPETITIONS, repetitions_, repetitions_);
+  ASSERT_GT(budget_tolerance_, 0.);
+  ASSERT_GT(repetitions_, 0);
+
+  robot_model_loader::RobotModelLoader model_loader;
+  robot_model_ = model_loader.getModel();
+
+  data_loader_.reset(new XmlTestdataLoader(test_data_file_name, robot_model_));
+  ASSERT_NE(nullptr, data_loader_) << "Failed to load test data by provider.";
+
+  ASSERT_TRUE(ros::service::waitForService(pilz_trajectory_generation::SEQUENCE_SERVICE_NAME, ros::Duration(10)))
+      << "Service not available.";
+  ros::NodeHandle nh; // connect to service in global namespace, not in ph_
+  client_ = nh.serviceClient<pilz_msgs::GetMotionSequence>(pilz_trajectory_generation::SEQUENCE_SERVICE_NAME, true);
+}
+
+double PerformanceTestSequencePlanning::calibrate()
+{
+  // Pose products, trigonometry and vector appends, like the sampling of a trajectory
+  std::vector<double> durations;
+  double sink {0.};
+  for(unsigned int run = 0; run < CALIBRATION_RUNS; ++run)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    Eigen::Isometry3d pose {Eigen::Isometry3d::Identity()};
+    std::vector<double> values;
+    for(unsigned int i = 0; i < CALIBRATION_ITERATIONS; ++i)
+    {
+      pose = pose * Eigen::AngleAxisd(std::sin(1.0e-3 * i), Eigen::Vector3d::UnitZ())
+          * Eigen::Translation3d(1.0e-4, 0., 0.);
+      values.push_back(pose.translation().x());
+      if(values.size() == 1000)
+      {
+        sink += values.back();
+        values = std::vector<double>();
+      }
+    }
+    durations.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  // keep the loop from being optimized away
+  EXPECT_TRUE(std::isfinite(sink));
+  return pilz_benchmark::median(durations);
+}
+
+/**
+ * @brief Plans the sequences of the test data repeatedly and compares the median latency and the point throughput to
+ * the budgets of the sequence.
+ *
+ * Test Sequence:
+ *    1. Measure the calibration unit.
+ *    2. Plan each sequence once to warm up the planner, then plan it repeatedly and measure the latency.
+ *
+ * Expected Results:
+ *    1. The calibration unit is positive.
+ *    2. All plannings succeed, every sequence has budgets, its median latency is within the latency budget and the
+ *       number of planned points per calibration unit of latency reaches the throughput budget.
+ */
+TEST_F(PerformanceTestSequencePlanning, LatencyWithinBudget)
+{
+  const double calibration_unit {calibrate()};
+  ASSERT_GT(calibration_unit, 0.);
+  RecordProperty("calibration_unit_ms", std::to_string(calibration_unit * 1000.));
+  ROS_INFO_STREAM("Calibration unit: " << calibration_unit * 1000. << "ms");
+
+  for(const auto& sequence : sequences_)
+  {
+    pilz_msgs::GetMotionSequence srv;
+    srv.request.commands = data_loader_->getSequence(sequence).toRequest();
+
+    ASSERT_TRUE(client_.call(srv));
+    ASSERT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, srv.response.plan_response.error_code.val)
+        << "Planning of " << sequence << " failed.";
+    const std::size_t points {srv.response.plan_response.trajectory.joint_trajectory.points.size()};
+
+    std::vector<double> latencies;
+    for(int i = 0; i < repetitions_; ++i)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      ASSERT_TRUE(client_.call(srv));
+      latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+      ASSERT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, srv.response.plan_response.error_code.val)
+          << "Planning of " << sequence << " failed.";
+    }
+
+    const double median_latency {pilz_benchmark::median(latencies) / calibration_unit};
+    const double throughput {static_cast<double>(points) / median_latency};
+    RecordProperty(sequence + "_latency_units", std::to_string(median_latency));
+    RecordProperty(sequence + "_points_per_unit", std::to_string(throughput));
+    ROS_INFO_STREAM(sequence << ": median latency " << median_latency << " units, " << points << " points, "
+                    << throughput << " points per unit");
+
+    const auto latency_budget = latency_budgets_.find(sequence);
+    if(latency_budget == latency_budgets_.end())
+    {
+      ADD_FAILURE() << "No latency budget for " << sequence << ", the median latency is " << median_latency
+                    << " calibration units.";
+    }
+    else
+    {
+      EXPECT_LE(median_latency, latency_budget->second * budget_tolerance_)
+          << "Median planning latency of " << sequence << " exceeds the budget.";
+    }
+
+    const auto throughput_budget = throughput_budgets_.find(sequence);
+    if(throughput_budget == throughput_budgets_.end())
+    {
+      ADD_FAILURE() << "No throughput budget for " << sequence << ", the throughput is " << throughput
+                    << " points per calibration unit.";
+    }
+    else
+    {
+      EXPECT_GE(throughput, throughput_budget->second / budget_tolerance_)
+          << "Point throughput of " << sequence << " is below the budget.";
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "performancetest_sequence_planning");
+  ros::NodeHandle nh;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
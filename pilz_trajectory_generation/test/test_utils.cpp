@@ -17,10 +17,13 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 #include "test_utils.h"
 #include <eigen_conversions/eigen_msg.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/planning_interface/planning_interface.h>
+#include "pilz_trajectory_generation/trajectory_decimator.h"
 
 pilz::JointLimitsContainer testutils::createFakeLimits(const std::vector<std::string>& joint_names)
 {
@@ -482,6 +485,53 @@ bool testutils::checkJointTrajectory(const trajectory_msgs::JointTrajectory &tra
   return ::testing::AssertionSuccess();
 }
 
+::testing::AssertionResult testutils::isSplineThroughSamples(const robot_trajectory::RobotTrajectory& samples,
+                                                             const robot_trajectory::RobotTrajectory& spline,
+                                                             const std::string& group_name,
+                                                             double tolerance)
+{
+  if(spline.getWayPointCount() < 2)
+  {
+    return ::testing::AssertionFailure() << "The spline has less than 2 waypoints.";
+  }
+
+  const std::vector<int>& variable_indices {
+    samples.getRobotModel()->getJointModelGroup(group_name)->getVariableIndexList()};
+  std::size_t segment {1};
+  for(std::size_t i = 0; i < samples.getWayPointCount(); ++i)
+  {
+    const double time {samples.getWayPointDurationFromStart(i)};
+    while(segment < spline.getWayPointCount() - 1 && spline.getWayPointDurationFromStart(segment) < time)
+    {
+      ++segment;
+    }
+    const robot_state::RobotState& start {spline.getWayPoint(segment - 1)};
+    const robot_state::RobotState& end {spline.getWayPoint(segment)};
+    const double start_time {spline.getWayPointDurationFromStart(segment - 1)};
+    for(const int index : variable_indices)
+    {
+      const double interpolated {pilz::TrajectoryDecimator::interpolate(pilz::TrajectoryDecimator::QUINTIC,
+                                                                         spline.getWayPointDurationFromPrevious(segment),
+                                                                         time - start_time,
+                                                                         start.getVariablePosition(index),
+                                                                         start.getVariableVelocity(index),
+                                                                         start.getVariableAcceleration(index),
+                                                                         end.getVariablePosition(index),
+                                                                         end.getVariableVelocity(index),
+                                                                         end.getVariableAcceleration(index))};
+      if(std::abs(samples.getWayPoint(i).getVariablePosition(index) - interpolated) > tolerance)
+      {
+        return ::testing::AssertionFailure() << "The spline deviates by "
+                                             << std::abs(samples.getWayPoint(i).getVariablePosition(index)
+                                                         - interpolated)
+                                             << " from sample " << i << " in variable " << index << ".";
+      }
+    }
+  }
+
+  return ::testing::AssertionSuccess();
+}
+
 void testutils::createDummyRequest(const moveit::core::RobotModelConstPtr &robot_model,
                                    const std::string &planning_group, planning_interface::MotionPlanRequest &req)
 {
@@ -31,6 +31,7 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit_msgs/MoveGroupAction.h>
+#include "pilz_trajectory_generation/capability_names.h"
 #include "pilz_trajectory_generation/limits_container.h"
 #include "pilz_trajectory_generation/trajectory_blend_response.h"
 #include "pilz_trajectory_generation/trajectory_blend_request.h"
@@ -70,6 +71,21 @@ inline std::string demangel(char const * name)
   return boost::core::demangle(name);
 }
 
+/**
+ * @brief Returns the sampling time which the planner reports in its configurations, -1 if it reports none
+ */
+inline double getReportedSamplingTime(const planning_interface::PlannerManager& planner)
+{
+  const auto settings = planner.getPlannerConfigurations().find(
+        pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME);
+  if(settings == planner.getPlannerConfigurations().end())
+  {
+    return -1.;
+  }
+  const auto sampling_time = settings->second.config.find(pilz_trajectory_generation::SAMPLING_TIME_PARAM_NAME);
+  return sampling_time == settings->second.config.end() ? -1. : std::stod(sampling_time->second);
+}
+
 //********************************************
 // Motion plan requests
 //********************************************
@@ -241,6 +257,17 @@ bool checkJointTrajectory(const trajectory_msgs::JointTrajectory& trajectory,
  */
 ::testing::AssertionResult hasStrictlyIncreasingTime(const robot_trajectory::RobotTrajectoryPtr &trajectory);
 
+/**
+ * @brief Checks that the quintic spline through the waypoints of the spline trajectory passes every waypoint of the
+ * sampled trajectory within the tolerance, see pilz::TrajectoryDecimator::interpolate()
+ *
+ * Only the variables of the group are compared.
+ */
+::testing::AssertionResult isSplineThroughSamples(const robot_trajectory::RobotTrajectory& samples,
+                                                  const robot_trajectory::RobotTrajectory& spline,
+                                                  const std::string& group_name,
+                                                  double tolerance);
+
 /**
  * @brief check if the sizes of the joint position/veloicty/acceleration are correct
  * @param trajectory
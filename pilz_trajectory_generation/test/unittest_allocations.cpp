@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/conversions.h>
+
+#include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
+#include "pilz_trajectory_generation/trajectory_generator_circ.h"
+#include "pilz_trajectory_generation/trajectory_generator_lin.h"
+#include "pilz_trajectory_generation/trajectory_generator_ptp.h"
+#include "pilz_industrial_motion_testutils/xml_testdata_loader.h"
+
+#include "allocation_counter.h"
+
+// parameters from parameter server
+const std::string TEST_DATA_FILE_NAME("testdata_file_name");
+const std::string PARAM_ALLOCATIONS_MARGIN("allocations_margin");
+
+// the slow request scales the velocity of the request down by this factor to get more points
+const double SLOW_VELOCITY_SCALE {0.5};
+
+using namespace pilz;
+using namespace pilz_industrial_motion_testutils;
+
+/**
+ * @brief Heap allocations of one planning
+ */
+struct PlanningAllocations
+{
+  double allocations {0.};
+  double bytes {0.};
+  std::size_t points {0};
+};
+
+/**
+ * @brief Guards the heap allocations per trajectory point of the trajectory generators and of
+ * CommandListManager::solve().
+ *
+ * The allocations per point are measured as the difference between the plannings of a request and of the same request
+ * with a lower velocity, divided by the difference of their points, so the allocations of the setup cancel out.
+ * The bounds are calibrated at runtime from the allocations of the work which is unavoidable for every point, measured
+ * in the same process: the copy of a robot state for the waypoint and, for the Cartesian commands, one IK call.
+ * They are exceeded if a point allocates more than this work plus the margin "allocations_margin".
+ */
+class AllocationsTest : public testing::Test
+{
+protected:
+  void SetUp() override;
+
+  /**
+   * @brief Plans the request twice and counts the allocations of the second planning, so that the lazy
+   * initialization (IK solver, limit caches) is not counted
+   */
+  template <typename RequestT>
+  PlanningAllocations countPlanning(
+      const std::function<bool(const RequestT&, planning_interface::MotionPlanResponse&)>& plan, const RequestT& req);
+
+  /**
+   * @brief Checks that the allocations per point do not exceed the reference by more than the margin
+   */
+  template <typename RequestT>
+  void checkAllocationsPerPoint(
+      const std::function<bool(const RequestT&, planning_interface::MotionPlanResponse&)>& plan,
+      const RequestT& req, const RequestT& slow_req, const PlanningAllocations& reference);
+
+  /**
+   * @return the allocations of the copy of a robot state for a waypoint
+   */
+  PlanningAllocations countWayPointAllocations(const moveit_msgs::RobotState& start_state) const;
+
+  /**
+   * @return the allocations of a waypoint and one IK call for the tip of the group
+   */
+  PlanningAllocations countCartesianPointAllocations(const std::string& group_name,
+                                                     const moveit_msgs::RobotState& start_state) const;
+
+protected:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_ {robot_model_loader::RobotModelLoader("robot_description").getModel()};
+  std::unique_ptr<TestdataLoader> data_loader_;
+  LimitsContainer planner_limits_;
+
+  double allocations_margin_ {0.};
+};
+
+void AllocationsTest::SetUp()
+{
+  std::string test_data_file_name;
+  ASSERT_TRUE(ph_.getParam(TEST_DATA_FILE_NAME, test_data_file_name));
+  ASSERT_TRUE(ph_.getParam(PARAM_ALLOCATIONS_MARGIN, allocations_margin_));
+
+  ASSERT_TRUE(robot_model_ != nullptr) << "Failed to load the robot model.";
+  data_loader_.reset(new XmlTestdataLoader(test_data_file_name, robot_model_));
+
+  JointLimitsContainer joint_limits {JointLimitsAggregator::getAggregatedLimits(ph_,
+                                                                                robot_model_->getActiveJointModels())};
+  CartesianLimit cart_limits;
+  cart_limits.setMaxRotationalVelocity(0.5*M_PI);
+  cart_limits.setMaxTranslationalAcceleration(2);
+  cart_limits.setMaxTranslationalDeceleration(2);
+  cart_limits.setMaxTranslationalVelocity(1);
+  planner_limits_.setJointLimits(joint_limits);
+  planner_limits_.setCartesianLimits(cart_limits);
+}
+
+template <typename RequestT>
+PlanningAllocations AllocationsTest::countPlanning(
+    const std::function<bool(const RequestT&, planning_interface::MotionPlanResponse&)>& plan, const RequestT& req)
+{
+  PlanningAllocations result;
+  planning_interface::MotionPlanResponse warm_up_res;
+  EXPECT_TRUE(plan(req, warm_up_res));
+
+  planning_interface::MotionPlanResponse res;
+  testutils::AllocationCounter counter;
+  const bool success {plan(req, res)};
+  counter.stop();
+
+  EXPECT_TRUE(success);
+  result.allocations = static_cast<double>(counter.getAllocations());
+  result.bytes = static_cast<double>(counter.getBytes());
+  result.points = (success && res.trajectory_) ? res.trajectory_->getWayPointCount() : 0;
+  return result;
+}
+
+template <typename RequestT>
+void AllocationsTest::checkAllocationsPerPoint(
+    const std::function<bool(const RequestT&, planning_interface::MotionPlanResponse&)>& plan,
+    const RequestT& req, const RequestT& slow_req, const PlanningAllocations& reference)
+{
+  const PlanningAllocations fast {countPlanning(plan, req)};
+  const PlanningAllocations slow {countPlanning(plan, slow_req)};
+  ASSERT_GT(slow.points, fast.points) << "The slow request must result in more points.";
+
+  const double additional_points {static_cast<double>(slow.points - fast.points)};
+  const double allocations_per_point {(slow.allocations - fast.allocations) / additional_points};
+  const double bytes_per_point {(slow.bytes - fast.bytes) / additional_points};
+
+  RecordProperty("points", std::to_string(slow.points));
+  RecordProperty("allocations_per_point", std::to_string(allocations_per_point));
+  RecordProperty("bytes_per_point", std::to_string(bytes_per_point));
+  RecordProperty("reference_allocations_per_point", std::to_string(reference.allocations));
+  RecordProperty("reference_bytes_per_point", std::to_string(reference.bytes));
+
+  EXPECT_LE(allocations_per_point, (1. + allocations_margin_) * reference.allocations);
+  EXPECT_LE(bytes_per_point, (1. + allocations_margin_) * reference.bytes);
+}
+
+PlanningAllocations AllocationsTest::countWayPointAllocations(const moveit_msgs::RobotState& start_state) const
+{
+  robot_state::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  moveit::core::robotStateMsgToRobotState(start_state, state);
+
+  PlanningAllocations result;
+  testutils::AllocationCounter counter;
+  // like JointTrajectoryColumns::toRobotTrajectory() creates a waypoint
+  robot_state::RobotStatePtr way_point {new robot_state::RobotState(state)};
+  counter.stop();
+
+  result.allocations = static_cast<double>(counter.getAllocations());
+  result.bytes = static_cast<double>(counter.getBytes());
+  return result;
+}
+
+PlanningAllocations AllocationsTest::countCartesianPointAllocations(const std::string& group_name,
+                                                                    const moveit_msgs::RobotState& start_state) const
+{
+  robot_state::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  moveit::core::robotStateMsgToRobotState(start_state, state);
+
+  const robot_model::JointModelGroup* group {robot_model_->getJointModelGroup(group_name)};
+  const std::string& link_name {group->getSolverInstance()->getTipFrame()};
+  const Eigen::Isometry3d pose {state.getFrameTransform(link_name)};
+  std::map<std::string, double> seed;
+  for(const auto& joint_name : group->getActiveJointModelNames())
+  {
+    seed[joint_name] = state.getVariablePosition(joint_name);
+  }
+  // the solution already contains the joints, like the solution of the previous sample in generateJointTrajectory()
+  std::map<std::string, double> solution {seed};
+
+  // like the first sample, warms up the IK solver
+  EXPECT_TRUE(computePoseIK(state, group_name, link_name, pose, robot_model_->getModelFrame(), seed, solution, false));
+
+  PlanningAllocations result {countWayPointAllocations(start_state)};
+  testutils::AllocationCounter counter;
+  const bool found {computePoseIK(state, group_name, link_name, pose, robot_model_->getModelFrame(), seed, solution,
+                                   false)};
+  counter.stop();
+
+  EXPECT_TRUE(found);
+  result.allocations += static_cast<double>(counter.getAllocations());
+  result.bytes += static_cast<double>(counter.getBytes());
+  return result;
+}
+
+/**
+ * @brief Check that the counter counts the allocations of the current thread only while it is active
+ */
+TEST_F(AllocationsTest, CounterCountsOnlyWhileActive)
+{
+  testutils::AllocationCounter counter;
+  std::unique_ptr<std::vector<double> > values {new std::vector<double>(100)};
+  counter.stop();
+  values.reset(new std::vector<double>(100));
+
+  EXPECT_EQ(2u, counter.getAllocations());
+  EXPECT_EQ(sizeof(std::vector<double>) + 100 * sizeof(double), counter.getBytes());
+}
+
+/**
+ * @brief Check that the peak contains memory which is freed again and that freed memory lowers the count
+ */
+TEST_F(AllocationsTest, CounterTracksPeak)
+{
+  std::unique_ptr<std::vector<double> > previous {new std::vector<double>(1000)};
+  testutils::AllocationCounter counter;
+  std::unique_ptr<std::vector<double> > values {new std::vector<double>(100000)};
+  values.reset();
+  previous.reset();
+  values.reset(new std::vector<double>(100000));
+  counter.stop();
+
+  EXPECT_GE(counter.getPeakBytes(), 100000 * sizeof(double));
+  EXPECT_LT(counter.getPeakBytes(), 2 * 100000 * sizeof(double));
+}
+
+/**
+ * @brief Check the allocations of a PTP command, which only creates a waypoint per point
+ */
+TEST_F(AllocationsTest, PTP)
+{
+  TrajectoryGeneratorPTP ptp(robot_model_, planner_limits_);
+  const planning_interface::MotionPlanRequest req {data_loader_->getPtpJoint("Ptp1").toRequest()};
+  planning_interface::MotionPlanRequest slow_req {req};
+  slow_req.max_velocity_scaling_factor *= SLOW_VELOCITY_SCALE;
+
+  checkAllocationsPerPoint<planning_interface::MotionPlanRequest>(
+        [&ptp](const planning_interface::MotionPlanRequest& r, planning_interface::MotionPlanResponse& res)
+  { return ptp.generate(r, res); }, req, slow_req, countWayPointAllocations(req.start_state));
+}
+
+/**
+ * @brief Check the allocations of a LIN command, which solves the IK and creates a waypoint per point
+ */
+TEST_F(AllocationsTest, LIN)
+{
+  TrajectoryGeneratorLIN lin(robot_model_, planner_limits_);
+  const planning_interface::MotionPlanRequest req {data_loader_->getLinJoint("lin2").toRequest()};
+  planning_interface::MotionPlanRequest slow_req {req};
+  slow_req.max_velocity_scaling_factor *= SLOW_VELOCITY_SCALE;
+
+  checkAllocationsPerPoint<planning_interface::MotionPlanRequest>(
+        [&lin](const planning_interface::MotionPlanRequest& r, planning_interface::MotionPlanResponse& res)
+  { return lin.generate(r, res); }, req, slow_req, countCartesianPointAllocations(req.group_name, req.start_state));
+}
+
+/**
+ * @brief Check the allocations of a CIRC command, which solves the IK and creates a waypoint per point
+ */
+TEST_F(AllocationsTest, CIRC)
+{
+  TrajectoryGeneratorCIRC circ(robot_model_, planner_limits_);
+  const planning_interface::MotionPlanRequest req {data_loader_->getCircJointCenterCart("circ1_center_2").toRequest()};
+  planning_interface::MotionPlanRequest slow_req {req};
+  slow_req.max_velocity_scaling_factor *= SLOW_VELOCITY_SCALE;
+
+  checkAllocationsPerPoint<planning_interface::MotionPlanRequest>(
+        [&circ](const planning_interface::MotionPlanRequest& r, planning_interface::MotionPlanResponse& res)
+  { return circ.generate(r, res); }, req, slow_req, countCartesianPointAllocations(req.group_name, req.start_state));
+}
+
+/**
+ * @brief Check the allocations of a blended sequence of PTP, LIN and CIRC commands
+ *
+ * The merging shares the waypoints of the commands, so a point of the sequence needs at most the work of a point of
+ * a Cartesian command.
+ */
+TEST_F(AllocationsTest, Sequence)
+{
+  const planning_scene::PlanningSceneConstPtr scene {std::make_shared<planning_scene::PlanningScene>(robot_model_)};
+  pilz_trajectory_generation::CommandListManager manager(ph_, robot_model_);
+  const pilz_msgs::MotionSequenceRequest req {data_loader_->getSequence("ComplexSequence").toRequest()};
+  ASSERT_FALSE(req.items.empty());
+  pilz_msgs::MotionSequenceRequest slow_req {req};
+  for(auto& item : slow_req.items)
+  {
+    item.req.max_velocity_scaling_factor *= SLOW_VELOCITY_SCALE;
+  }
+
+  const planning_interface::MotionPlanRequest& first_req {req.items.front().req};
+  checkAllocationsPerPoint<pilz_msgs::MotionSequenceRequest>(
+        [&manager, &scene](const pilz_msgs::MotionSequenceRequest& r, planning_interface::MotionPlanResponse& res)
+  { return manager.solve(scene, r, res); }, req, slow_req,
+        countCartesianPointAllocations(first_req.group_name, first_req.start_state));
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "unittest_allocations");
+  ros::NodeHandle nh;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -19,11 +19,14 @@
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <geometric_shapes/shapes.h>
 
 #include "pilz_extensions/joint_limits_extension.h"
 #include "pilz_extensions/joint_limits_interface_extension.h"
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/xmlrpc_utils.h"
 
 using namespace pilz_extensions;
 
@@ -152,6 +155,79 @@ TEST_F(JointLimitsAggregator, CorrectSettingAccelerationAndDeceleration)
   }
 }
 
+/**
+ * @brief Check that the limits parsed from the prefetched parameter namespace equal the limits read per parameter
+ * with pilz_extensions::joint_limits_interface::getJointLimits()
+ */
+TEST_F(JointLimitsAggregator, PrefetchedParametersEqualNodeHandle)
+{
+  ros::NodeHandle nh("~/valid_1");
+
+  pilz::JointLimitsContainer container
+        = pilz::JointLimitsAggregator::getAggregatedLimits(pilz::getParamNamespace(nh),
+                                                           robot_model_->getActiveJointModels());
+
+  ASSERT_EQ(robot_model_->getActiveJointModels().size(), container.getCount());
+  for(const auto& joint_model : robot_model_->getActiveJointModels())
+  {
+    const std::string& name {joint_model->getName()};
+    JointLimit expected;
+    const bool defined {pilz_extensions::joint_limits_interface::getJointLimits(name, nh, expected)};
+    const JointLimit& actual {container.getLimit(name)};
+
+    // position and velocity limits which are not defined on the parameter server come from the robot model
+    if(defined && expected.has_position_limits)
+    {
+      EXPECT_TRUE(actual.has_position_limits) << name;
+      EXPECT_EQ(expected.min_position, actual.min_position) << name;
+      EXPECT_EQ(expected.max_position, actual.max_position) << name;
+    }
+    if(defined && expected.has_velocity_limits)
+    {
+      EXPECT_TRUE(actual.has_velocity_limits) << name;
+      EXPECT_EQ(expected.max_velocity, actual.max_velocity) << name;
+    }
+
+    EXPECT_EQ(expected.has_acceleration_limits, actual.has_acceleration_limits) << name;
+    if(expected.has_acceleration_limits)
+    {
+      EXPECT_EQ(expected.max_acceleration, actual.max_acceleration) << name;
+    }
+    if(expected.has_deceleration_limits)
+    {
+      EXPECT_TRUE(actual.has_deceleration_limits) << name;
+      EXPECT_EQ(expected.max_deceleration, actual.max_deceleration) << name;
+    }
+    else if(expected.has_acceleration_limits)
+    {
+      EXPECT_TRUE(actual.has_deceleration_limits) << name;
+      EXPECT_EQ(-expected.max_acceleration, actual.max_deceleration) << name;
+    }
+    else
+    {
+      EXPECT_FALSE(actual.has_deceleration_limits) << name;
+    }
+  }
+}
+
+/**
+ * @brief Check that a missing parameter namespace leaves the limits of the robot model untouched
+ */
+TEST_F(JointLimitsAggregator, PrefetchedParametersMissingNamespace)
+{
+  XmlRpc::XmlRpcValue params {pilz::getParamNamespace(ros::NodeHandle("~/not_existing"))};
+  EXPECT_EQ(XmlRpc::XmlRpcValue::TypeStruct, params.getType());
+
+  pilz::JointLimitsContainer container
+        = pilz::JointLimitsAggregator::getAggregatedLimits(params, robot_model_->getActiveJointModels());
+
+  for(const auto& lim : container)
+  {
+    EXPECT_EQ(robot_model_->getJointModel(lim.first)->getVariableBounds()[0].max_velocity_,
+              lim.second.max_velocity) << lim.first;
+  }
+}
+
 /**
  * @brief Check that position limit violations are detected properly
  */
@@ -180,6 +256,78 @@ TEST_F(JointLimitsAggregator, LimitsViolationVelocity)
                pilz::AggregationBoundsViolationException);
 }
 
+/**
+ * @brief Check that no payload provider is created without a payload model
+ */
+TEST_F(JointLimitsAggregator, NoPayloadLimitsProvider)
+{
+  ros::NodeHandle nh("~/valid_1");
+
+  pilz::JointLimitsContainer container
+      = pilz::JointLimitsAggregator::getAggregatedLimits(nh, robot_model_->getActiveJointModels());
+
+  EXPECT_EQ(nullptr, pilz::JointLimitsAggregator::getPayloadLimitsProvider(nh, container));
+}
+
+/**
+ * @brief Check that the acceleration limits are scaled with the attached payload
+ *
+ *  - Test Sequence:
+ *    1. Get the limits without attached body.
+ *    2. Attach a body of half the maximal payload.
+ *    3. Attach an additional body of unknown mass.
+ *
+ *  - Expected Results:
+ *    1. The unloaded limits are returned.
+ *    2. The limits are halfway between the unloaded and the aggregated limits.
+ *    3. The aggregated limits are returned.
+ */
+TEST_F(JointLimitsAggregator, PayloadLimitsProvider)
+{
+  ros::NodeHandle nh("~/payload");
+
+  pilz::JointLimitsContainer container
+      = pilz::JointLimitsAggregator::getAggregatedLimits(nh, robot_model_->getActiveJointModels());
+  pilz::JointLimitsProviderConstPtr provider = pilz::JointLimitsAggregator::getPayloadLimitsProvider(nh, container);
+  ASSERT_NE(nullptr, provider);
+
+  robot_state::RobotState state(robot_model_);
+  state.setToDefaultValues();
+
+  pilz::JointLimitsContainer limits {provider->getLimits(container, state)};
+  EXPECT_DOUBLE_EQ(7.5, limits.getLimit("prbt_joint_4").max_acceleration);
+  EXPECT_DOUBLE_EQ(-9.5, limits.getLimit("prbt_joint_4").max_deceleration);
+  EXPECT_EQ(0, limits.getLimit("prbt_joint_3").max_acceleration);
+
+  const std::vector<shapes::ShapeConstPtr> shapes {shapes::ShapeConstPtr(new shapes::Box(0.1, 0.1, 0.1))};
+  const EigenSTL::vector_Isometry3d poses {Eigen::Isometry3d::Identity()};
+  const std::string link_name {robot_model_->getLinkModelNames().back()};
+
+  state.attachBody("box", shapes, poses, std::set<std::string>(), link_name);
+  limits = provider->getLimits(container, state);
+  EXPECT_DOUBLE_EQ(6.5, limits.getLimit("prbt_joint_4").max_acceleration);
+  EXPECT_DOUBLE_EQ(-7.5, limits.getLimit("prbt_joint_4").max_deceleration);
+
+  state.attachBody("unknown", shapes, poses, std::set<std::string>(), link_name);
+  limits = provider->getLimits(container, state);
+  EXPECT_DOUBLE_EQ(5.5, limits.getLimit("prbt_joint_4").max_acceleration);
+  EXPECT_DOUBLE_EQ(-5.5, limits.getLimit("prbt_joint_4").max_deceleration);
+}
+
+/**
+ * @brief Check that unloaded limits stricter than the aggregated limits are rejected
+ */
+TEST_F(JointLimitsAggregator, PayloadLimitsViolation)
+{
+  ros::NodeHandle nh("~/payload_stricter");
+
+  pilz::JointLimitsContainer container
+      = pilz::JointLimitsAggregator::getAggregatedLimits(nh, robot_model_->getActiveJointModels());
+
+  EXPECT_THROW(pilz::JointLimitsAggregator::getPayloadLimitsProvider(nh, container),
+               pilz::AggregationBoundsViolationException);
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_joint_limits_aggregator");
@@ -212,6 +212,18 @@ TEST_F(JointLimitsContainerTest, CheckVerifyPositionLimits)
                std::out_of_range);
 }
 
+/**
+ * @brief Check that findLimit returns the stored limit or nullptr
+ */
+TEST_F(JointLimitsContainerTest, CheckFindLimit)
+{
+  const pilz_extensions::JointLimit* limit {container_.findLimit("joint6")};
+  ASSERT_NE(nullptr, limit);
+  EXPECT_EQ(&container_.getLimit("joint6"), limit);
+  EXPECT_EQ(2, limit->max_velocity);
+  EXPECT_EQ(nullptr, container_.findLimit("unknown_joint"));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -22,7 +22,11 @@
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/robot_model/robot_model.h>
 
+#include "pilz_trajectory_generation/capability_names.h"
 #include "pilz_trajectory_generation/pilz_command_planner.h"
+#include "pilz_trajectory_generation/trajectory_generator.h"
+
+#include "test_utils.h"
 
 const std::string PARAM_MODEL_NO_GRIPPER_NAME {"robot_description"};
 const std::string PARAM_MODEL_WITH_GRIPPER_NAME {"robot_description_pg70"};
@@ -211,6 +215,31 @@ TEST_P(CommandPlannerTest, CheckPlanningContextDescriptionNotEmptyAndStable)
   EXPECT_GT(desc.length(), 0u);
 }
 
+/**
+ * @brief Check that the planner reports the sampling time of its trajectories, also after the configurations are
+ * replaced, and reports 0 while the spline output is enabled
+ */
+TEST_P(CommandPlannerTest, ReportSamplingTime)
+{
+  const double default_sampling_time {pilz::TrajectoryGenerator::DEFAULT_SAMPLING_TIME};
+  EXPECT_DOUBLE_EQ(default_sampling_time, testutils::getReportedSamplingTime(*planner_instance_));
+
+  planning_interface::PlannerConfigurationMap configurations;
+  planning_interface::PlannerConfigurationSettings& settings
+  {configurations[pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME]};
+  settings.name = pilz_trajectory_generation::SPLINE_OUTPUT_CONFIGURATION_NAME;
+  settings.config[pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME] = "0.001";
+  planner_instance_->setPlannerConfigurations(configurations);
+  EXPECT_DOUBLE_EQ(0., testutils::getReportedSamplingTime(*planner_instance_));
+
+  settings.config[pilz_trajectory_generation::SPLINE_OUTPUT_TOLERANCE_PARAM_NAME] = "0";
+  planner_instance_->setPlannerConfigurations(configurations);
+  EXPECT_DOUBLE_EQ(default_sampling_time, testutils::getReportedSamplingTime(*planner_instance_));
+
+  planner_instance_->setPlannerConfigurations(planning_interface::PlannerConfigurationMap());
+  EXPECT_DOUBLE_EQ(default_sampling_time, testutils::getReportedSamplingTime(*planner_instance_));
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_pilz_command_planner");
@@ -15,12 +15,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 #include <boost/core/demangle.hpp>
 
 #include <moveit_msgs/MoveItErrorCodes.h>
 
 #include <moveit/planning_interface/planning_interface.h>
+#include <pluginlib/class_loader.h>
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/robot_model/robot_model.h>
@@ -40,6 +43,7 @@ const std::string PARAM_MODEL_WITH_GRIPPER_NAME {"robot_description_pg70"};
 //parameters from parameter server
 const std::string PARAM_PLANNING_GROUP_NAME("planning_group");
 const std::string PARAM_TARGET_LINK_NAME("target_link");
+const std::string PARAM_PLANNING_PLUGIN_NAME("planning_plugin");
 
 
 /**
@@ -209,7 +213,46 @@ TYPED_TEST(PlanningContextTest, SolveValidRequest)
 }
 
 /**
- * @brief Solve a valid request. Expect a detailed response.
+ * @brief Solve a valid request with a planning context of the planner plugin. Expect the waypoints to be equally
+ * spaced, only the last waypoint may be closer to its predecessor, and expect the spacing to be the sampling time
+ * the planner reports in its configurations.
+ */
+TYPED_TEST(PlanningContextTest, SolveSamplingTime)
+{
+  std::string planner_plugin_name;
+  ASSERT_TRUE(this->ph_.getParam(PARAM_PLANNING_PLUGIN_NAME, planner_plugin_name));
+  pluginlib::ClassLoader<planning_interface::PlannerManager> planner_plugin_loader(
+        "moveit_core", "planning_interface::PlannerManager");
+  planning_interface::PlannerManagerPtr planner {planner_plugin_loader.createUnmanagedInstance(planner_plugin_name)};
+  ASSERT_TRUE(planner->initialize(this->robot_model_, this->ph_.getNamespace()));
+
+  planning_interface::MotionPlanRequest req  = this->getValidRequest(testutils::demangel(typeid(TypeParam).name()));
+  moveit_msgs::MoveItErrorCodes error_code;
+  planning_interface::PlanningContextPtr planning_context {
+    planner->getPlanningContext(this->planning_context_->getPlanningScene(), req, error_code)};
+  ASSERT_TRUE(planning_context) << testutils::demangel(typeid(TypeParam).name());
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(planning_context->solve(res)) << testutils::demangel(typeid(TypeParam).name());
+
+  const std::size_t waypoint_count {res.trajectory_->getWayPointCount()};
+  ASSERT_GE(waypoint_count, 3u) << testutils::demangel(typeid(TypeParam).name());
+  const double waypoint_spacing {res.trajectory_->getWayPointDurationFromPrevious(1)};
+  EXPECT_GT(waypoint_spacing, 0.) << testutils::demangel(typeid(TypeParam).name());
+  for(std::size_t i = 2; i < waypoint_count - 1; ++i)
+  {
+    ASSERT_NEAR(waypoint_spacing, res.trajectory_->getWayPointDurationFromPrevious(i), 1e-6)
+        << testutils::demangel(typeid(TypeParam).name()) << " waypoint " << i;
+  }
+  EXPECT_LE(res.trajectory_->getWayPointDurationFromPrevious(waypoint_count - 1), waypoint_spacing + 1e-6)
+      << testutils::demangel(typeid(TypeParam).name());
+
+  EXPECT_NEAR(testutils::getReportedSamplingTime(*planner), waypoint_spacing, 1e-6)
+      << testutils::demangel(typeid(TypeParam).name());
+}
+
+/**
+ * @brief Solve a valid request. Expect a detailed response with the durations of the stages.
  */
 TYPED_TEST(PlanningContextTest, SolveValidRequestDetailedResponse)
 {
@@ -222,6 +265,17 @@ TYPED_TEST(PlanningContextTest, SolveValidRequestDetailedResponse)
   EXPECT_TRUE(result) << testutils::demangel(typeid(TypeParam).name());
   EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val)
       << testutils::demangel(typeid(TypeParam).name());
+
+  ASSERT_EQ(res.description_.size(), res.processing_time_.size());
+  ASSERT_EQ(res.description_.size(), res.trajectory_.size());
+  EXPECT_EQ(pilz::STAGE_REQUEST_VALIDATION, res.description_.front());
+  EXPECT_EQ(pilz::STAGE_CONVERSION, res.description_.back());
+  EXPECT_NE(res.description_.end(),
+            std::find(res.description_.begin(), res.description_.end(), pilz::STAGE_SAMPLING));
+  for(const double processing_time : res.processing_time_)
+  {
+    EXPECT_GE(processing_time, 0.);
+  }
 }
 
 /**
@@ -145,6 +145,97 @@ TEST_P(PlanningContextLoadersTest, LoadContext)
   EXPECT_EQ(true, res) << "Context could not be loaded!";
 }
 
+/**
+ * @brief Check that idle contexts are reused by loadContext
+ *
+ *  - Test Sequence:
+ *    1. Load a context and keep a reference to it, load a second context.
+ *    2. Release all references and load a context again.
+ *
+ *  - Expected Results:
+ *    1. Two different contexts are returned, since the first one is still in use.
+ *    2. One of the previously created contexts is returned.
+ */
+TEST_P(PlanningContextLoadersTest, LoadContextReusesIdleContext)
+{
+  pilz::JointLimitsContainer joint_limits = testutils::createFakeLimits(robot_model_->getVariableNames());
+  pilz::LimitsContainer limits;
+  limits.setJointLimits(joint_limits);
+  pilz::CartesianLimit cart_limits;
+  cart_limits.setMaxRotationalVelocity(1*M_PI);
+  cart_limits.setMaxTranslationalAcceleration(2);
+  cart_limits.setMaxTranslationalDeceleration(2);
+  cart_limits.setMaxTranslationalVelocity(1);
+  limits.setCartesianLimits(cart_limits);
+
+  planning_context_loader_->setLimits(limits);
+  planning_context_loader_->setModel(robot_model_);
+
+  /**********/
+  /* Step 1 */
+  /**********/
+  planning_interface::PlanningContextPtr first_context, second_context;
+  ASSERT_TRUE(planning_context_loader_->loadContext(first_context, "test", "test"));
+  ASSERT_TRUE(planning_context_loader_->loadContext(second_context, "test", "test"));
+  EXPECT_NE(first_context.get(), second_context.get());
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  const planning_interface::PlanningContext* first_raw {first_context.get()};
+  const planning_interface::PlanningContext* second_raw {second_context.get()};
+  first_context.reset();
+  second_context.reset();
+
+  planning_interface::PlanningContextPtr reused_context;
+  ASSERT_TRUE(planning_context_loader_->loadContext(reused_context, "test", "test"));
+  EXPECT_TRUE(reused_context.get() == first_raw || reused_context.get() == second_raw);
+}
+
+/**
+ * @brief Check that the idle contexts are only dropped if the spline output tolerance changes
+ *
+ *  - Test Sequence:
+ *    1. Load a context, release it and set the unchanged tolerance.
+ *    2. Set a different tolerance.
+ *
+ *  - Expected Results:
+ *    1. The idle context is kept in the pool.
+ *    2. The idle context is dropped.
+ */
+TEST_P(PlanningContextLoadersTest, SplineToleranceDropsIdleContextsOnlyIfChanged)
+{
+  pilz::JointLimitsContainer joint_limits = testutils::createFakeLimits(robot_model_->getVariableNames());
+  pilz::LimitsContainer limits;
+  limits.setJointLimits(joint_limits);
+  pilz::CartesianLimit cart_limits;
+  cart_limits.setMaxRotationalVelocity(1*M_PI);
+  cart_limits.setMaxTranslationalAcceleration(2);
+  cart_limits.setMaxTranslationalDeceleration(2);
+  cart_limits.setMaxTranslationalVelocity(1);
+  limits.setCartesianLimits(cart_limits);
+
+  planning_context_loader_->setLimits(limits);
+  planning_context_loader_->setModel(robot_model_);
+
+  /**********/
+  /* Step 1 */
+  /**********/
+  planning_interface::PlanningContextPtr context;
+  ASSERT_TRUE(planning_context_loader_->loadContext(context, "test", "test"));
+  const planning_interface::PlanningContextWeakPtr idle_context {context};
+  context.reset();
+
+  planning_context_loader_->setSplineTolerance(0.);
+  EXPECT_FALSE(idle_context.expired());
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  planning_context_loader_->setSplineTolerance(0.01);
+  EXPECT_TRUE(idle_context.expired());
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_planning_context_loaders");
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pilz_trajectory_generation/planning_metrics.h"
+
+using namespace pilz;
+
+namespace
+{
+
+std::string getValue(const diagnostic_msgs::DiagnosticStatus& status, const std::string& key)
+{
+  const auto it = std::find_if(status.values.begin(), status.values.end(),
+                               [&key](const diagnostic_msgs::KeyValue& key_value){ return key_value.key == key; });
+  return it == status.values.end() ? "" : it->value;
+}
+
+}
+
+/**
+ * @brief Check that each value falls into a bucket whose upper bound is at most 12.5% larger
+ */
+TEST(LatencyHistogramTest, BucketPrecision)
+{
+  std::vector<std::uint64_t> values {0, 1, 7, 8, 9, 15, 16, 17, 100, 999, 1000, 123456789,
+                                     std::numeric_limits<std::uint64_t>::max()};
+  for(const auto value : values)
+  {
+    const std::size_t index {LatencyHistogram::getBucketIndex(value)};
+    ASSERT_LT(index, LatencyHistogram::BUCKET_COUNT) << "value: " << value;
+    const std::uint64_t upper_bound {LatencyHistogram::getBucketUpperBound(index)};
+    EXPECT_GE(upper_bound, value);
+    EXPECT_LE(static_cast<double>(upper_bound - value), 0.125 * static_cast<double>(value)) << "value: " << value;
+    if(index > 0)
+    {
+      EXPECT_LT(LatencyHistogram::getBucketUpperBound(index - 1), value) << "value: " << value;
+    }
+  }
+}
+
+/**
+ * @brief Check the quantiles, the maximum and the subtraction of an older state
+ */
+TEST(LatencyHistogramTest, Quantiles)
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.getQuantile(0.5));
+  EXPECT_EQ(0u, histogram.getMax());
+
+  for(std::uint64_t value = 1; value <= 100; ++value)
+  {
+    histogram.add(value);
+  }
+  const LatencyHistogram older {histogram};
+  histogram.add(5000);
+
+  EXPECT_EQ(101u, histogram.getCount());
+  EXPECT_NEAR(50., static_cast<double>(histogram.getQuantile(0.5)), 50. * 0.125);
+  EXPECT_NEAR(100., static_cast<double>(histogram.getQuantile(0.99)), 100. * 0.125);
+  EXPECT_NEAR(5000., static_cast<double>(histogram.getMax()), 5000. * 0.125);
+
+  histogram.subtract(older);
+  EXPECT_EQ(1u, histogram.getCount());
+  EXPECT_EQ(histogram.getMax(), histogram.getQuantile(0.5));
+}
+
+/**
+ * @brief Check that the metrics of several threads are summed up in the snapshot
+ */
+TEST(PlanningMetricsTest, SnapshotMergesThreads)
+{
+  PlanningMetrics metrics;
+
+  std::vector<std::thread> threads;
+  for(int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&metrics]()
+    {
+      for(int j = 0; j < 100; ++j)
+      {
+        metrics.recordPlan(PlanningMetrics::Algorithm::LIN, std::chrono::milliseconds(2), j % 10 != 0);
+        metrics.increment(PlanningMetrics::Counter::IK_CALLS, 3);
+      }
+    });
+  }
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+  metrics.increment(PlanningMetrics::Counter::BLENDS);
+
+  const PlanningMetricsSnapshot snapshot {metrics.getSnapshot()};
+  EXPECT_EQ(400u, snapshot.plans[PlanningMetricsSnapshot::LIN]);
+  EXPECT_EQ(40u, snapshot.plan_failures[PlanningMetricsSnapshot::LIN]);
+  EXPECT_EQ(0u, snapshot.plans[PlanningMetricsSnapshot::PTP]);
+  EXPECT_EQ(400u, snapshot.latencies_us[PlanningMetricsSnapshot::LIN].getCount());
+  EXPECT_NEAR(2000., static_cast<double>(snapshot.latencies_us[PlanningMetricsSnapshot::LIN].getQuantile(0.5)),
+              2000. * 0.125);
+  EXPECT_EQ(1200u, snapshot.counters[PlanningMetricsSnapshot::IK_CALLS]);
+  EXPECT_EQ(1u, snapshot.counters[PlanningMetricsSnapshot::BLENDS]);
+}
+
+/**
+ * @brief Check that ScopedPlanMetrics records the result and the number of points of the response
+ */
+TEST(PlanningMetricsTest, ScopedPlanMetrics)
+{
+  PlanningMetrics metrics;
+  {
+    planning_interface::MotionPlanResponse res;
+    ScopedPlanMetrics scoped_metrics(PlanningMetrics::Algorithm::PTP, res, metrics);
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+  }
+
+  const PlanningMetricsSnapshot snapshot {metrics.getSnapshot()};
+  EXPECT_EQ(1u, snapshot.plans[PlanningMetricsSnapshot::PTP]);
+  EXPECT_EQ(1u, snapshot.plan_failures[PlanningMetricsSnapshot::PTP]);
+  EXPECT_EQ(0u, snapshot.counters[PlanningMetricsSnapshot::POINTS]);
+}
+
+/**
+ * @brief Check that the status contains the totals of the counters and the quantiles of the interval
+ */
+TEST(PlanningMetricsTest, DiagnosticStatus)
+{
+  PlanningMetrics metrics;
+  metrics.recordPlan(PlanningMetrics::Algorithm::SEQUENCE, std::chrono::microseconds(100000), true);
+  const PlanningMetricsSnapshot older {metrics.getSnapshot()};
+  metrics.recordPlan(PlanningMetrics::Algorithm::SEQUENCE, std::chrono::microseconds(1000), true);
+  metrics.increment(PlanningMetrics::Counter::CONTEXT_CACHE_HITS, 2);
+  metrics.increment(PlanningMetrics::Counter::SEQUENCE_POINTS, 5);
+
+  const PlanningMetricsSnapshot total {metrics.getSnapshot()};
+  PlanningMetricsSnapshot interval {total};
+  interval.subtract(older);
+
+  const diagnostic_msgs::DiagnosticStatus status {toDiagnosticStatus(total, interval)};
+  EXPECT_EQ("2", getValue(status, "sequence_plans"));
+  EXPECT_EQ("0", getValue(status, "sequence_failures"));
+  EXPECT_EQ("2", getValue(status, "context_cache_hits"));
+  EXPECT_EQ("5", getValue(status, "sequence_points"));
+  EXPECT_EQ("0", getValue(status, "points"));
+  EXPECT_EQ("0", getValue(status, "ptp_latency_p99_us"));
+  EXPECT_NEAR(1000., std::stod(getValue(status, "sequence_latency_max_us")), 1000. * 0.125);
+  EXPECT_EQ(getValue(status, "sequence_latency_max_us"), getValue(status, "sequence_latency_p50_us"));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pilz_trajectory_generation/resource_usage.h"
+
+using namespace pilz;
+
+static constexpr std::size_t HEAP_BLOCK_BYTES {16 * 1024 * 1024};
+
+/**
+ * @brief Busy loop on the calling thread
+ */
+static double spin(std::chrono::milliseconds duration)
+{
+  double sum {0.};
+  const auto end = std::chrono::steady_clock::now() + duration;
+  while(std::chrono::steady_clock::now() < end)
+  {
+    sum += std::sqrt(sum + 1.);
+  }
+  return sum;
+}
+
+/**
+ * @brief Check that the CPU time of the calling thread is measured and sleeping does not count
+ */
+TEST(ResourceUsageTest, CpuTimeOfCallingThread)
+{
+  ResourceUsage usage;
+  {
+    ResourceMeter meter(&usage);
+    EXPECT_GT(spin(std::chrono::milliseconds(50)), 0.);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+  EXPECT_GE(usage.cpu_seconds, 0.03);
+  EXPECT_LT(usage.cpu_seconds, 0.2);
+}
+
+/**
+ * @brief Check that the CPU time of another thread is not measured
+ */
+TEST(ResourceUsageTest, CpuTimeOfOtherThreadsIsIgnored)
+{
+  ResourceUsage usage;
+  {
+    ResourceMeter meter(&usage);
+    std::thread other([](){ spin(std::chrono::milliseconds(200)); });
+    other.join();
+  }
+  EXPECT_LT(usage.cpu_seconds, 0.1);
+}
+
+/**
+ * @brief Check that the heap peak contains the memory which is still allocated at the end
+ */
+TEST(ResourceUsageTest, HeapPeakOfHeldMemory)
+{
+  ResourceUsage usage;
+  std::unique_ptr<std::vector<char> > block;
+  {
+    ResourceMeter meter(&usage);
+    block.reset(new std::vector<char>(HEAP_BLOCK_BYTES, 1));
+  }
+  EXPECT_GE(usage.heap_peak_bytes, HEAP_BLOCK_BYTES);
+}
+
+/**
+ * @brief Check that the heap peak contains memory which is freed after a sample
+ */
+TEST(ResourceUsageTest, HeapPeakOfSampledMemory)
+{
+  ResourceUsage usage;
+  {
+    ResourceMeter meter(&usage);
+    std::unique_ptr<std::vector<char> > block {new std::vector<char>(HEAP_BLOCK_BYTES, 1)};
+    meter.sampleHeap();
+  }
+  EXPECT_GE(usage.heap_peak_bytes, HEAP_BLOCK_BYTES);
+}
+
+/**
+ * @brief Check that freeing memory which was allocated before the measurement does not count
+ */
+TEST(ResourceUsageTest, HeapPeakIgnoresFreedMemory)
+{
+  ResourceUsage usage;
+  std::unique_ptr<std::vector<char> > block {new std::vector<char>(HEAP_BLOCK_BYTES, 1)};
+  {
+    ResourceMeter meter(&usage);
+    block.reset();
+  }
+  EXPECT_LT(usage.heap_peak_bytes, HEAP_BLOCK_BYTES);
+}
+
+/**
+ * @brief Check that the heap is not measured if disabled
+ */
+TEST(ResourceUsageTest, HeapNotMeasured)
+{
+  ResourceUsage usage;
+  {
+    ResourceMeter meter(&usage, false);
+    std::unique_ptr<std::vector<char> > block {new std::vector<char>(HEAP_BLOCK_BYTES, 1)};
+    meter.sampleHeap();
+  }
+  EXPECT_EQ(0u, usage.heap_peak_bytes);
+}
+
+/**
+ * @brief Check that the CPU times are summed up and the larger heap peak is kept
+ */
+TEST(ResourceUsageTest, Add)
+{
+  ResourceUsage usage;
+  usage.cpu_seconds = 1.;
+  usage.heap_peak_bytes = 100;
+
+  ResourceUsage other;
+  other.cpu_seconds = 2.;
+  other.heap_peak_bytes = 50;
+
+  usage.add(other);
+  EXPECT_DOUBLE_EQ(3., usage.cpu_seconds);
+  EXPECT_EQ(100u, usage.heap_peak_bytes);
+
+  other.heap_peak_bytes = 150;
+  usage.add(other);
+  EXPECT_EQ(150u, usage.heap_peak_bytes);
+}
+
+/**
+ * @brief Check that a meter without ResourceUsage can be used
+ */
+TEST(ResourceUsageTest, MeterWithoutUsage)
+{
+  ResourceMeter meter(nullptr);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include "pilz_trajectory_generation/sequence_recorder.h"
+
+using namespace pilz_trajectory_generation;
+
+static const std::string RECORD_FILE_NAME {"unittest_sequence_recorder.bag"};
+
+class SequenceRecorderTest : public testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    std::remove(RECORD_FILE_NAME.c_str());
+  }
+
+  static PlannedSequence createSequence(std::size_t items)
+  {
+    PlannedSequence sequence;
+    sequence.request.items.resize(items);
+    sequence.response.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+    sequence.response.planning_time_ = 0.1 * static_cast<double>(items);
+    return sequence;
+  }
+
+  static std::vector<pilz_msgs::MotionSequenceRecord> readRecords()
+  {
+    std::vector<pilz_msgs::MotionSequenceRecord> records;
+    rosbag::Bag bag(RECORD_FILE_NAME, rosbag::bagmode::Read);
+    rosbag::View view(bag, rosbag::TopicQuery(SEQUENCE_RECORD_TOPIC_NAME));
+    for(const rosbag::MessageInstance& message : view)
+    {
+      const auto record = message.instantiate<pilz_msgs::MotionSequenceRecord>();
+      EXPECT_TRUE(record != nullptr);
+      if(record)
+      {
+        records.push_back(*record);
+      }
+    }
+    return records;
+  }
+};
+
+/**
+ * @brief Check that the records are written in the order of recording when the recorder is destroyed
+ */
+TEST_F(SequenceRecorderTest, RecordsAreWrittenInOrder)
+{
+  {
+    SequenceRecorder recorder(RECORD_FILE_NAME);
+    for(std::size_t items = 1; items <= 3; ++items)
+    {
+      EXPECT_TRUE(recorder.record(createSequence(items)));
+    }
+  }
+
+  const std::vector<pilz_msgs::MotionSequenceRecord> records {readRecords()};
+  ASSERT_EQ(3u, records.size());
+  for(std::size_t i = 0; i < records.size(); ++i)
+  {
+    EXPECT_EQ(i + 1, records.at(i).request.items.size());
+    EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, records.at(i).response.error_code.val);
+    EXPECT_DOUBLE_EQ(0.1 * static_cast<double>(i + 1), records.at(i).response.planning_time);
+  }
+}
+
+/**
+ * @brief Check that flush() returns after all queued records are written and nothing is dropped
+ */
+TEST_F(SequenceRecorderTest, Flush)
+{
+  SequenceRecorder recorder(RECORD_FILE_NAME, 1000);
+  for(int i = 0; i < 100; ++i)
+  {
+    recorder.record(createSequence(2));
+  }
+  recorder.flush();
+  EXPECT_EQ(0u, recorder.getDroppedCount());
+}
+
+/**
+ * @brief Check that records are dropped instead of blocking if the queue is full
+ */
+TEST_F(SequenceRecorderTest, DropsRecordsIfQueueIsFull)
+{
+  std::size_t accepted {0};
+  {
+    SequenceRecorder recorder(RECORD_FILE_NAME, 0);
+    accepted += recorder.record(createSequence(1)) ? 1 : 0;
+    EXPECT_EQ(1u, recorder.getDroppedCount());
+  }
+  EXPECT_EQ(0u, accepted);
+  EXPECT_TRUE(readRecords().empty());
+}
+
+/**
+ * @brief Check that the users of the same file share one recorder
+ */
+TEST_F(SequenceRecorderTest, SharedRecorder)
+{
+  const std::shared_ptr<SequenceRecorder> recorder {SequenceRecorder::getSharedRecorder(RECORD_FILE_NAME)};
+  EXPECT_EQ(recorder, SequenceRecorder::getSharedRecorder(RECORD_FILE_NAME));
+}
+
+/**
+ * @brief Check that an invalid file is reported by an exception
+ */
+TEST_F(SequenceRecorderTest, InvalidFile)
+{
+  EXPECT_THROW(SequenceRecorder("/non/existing/directory/records.bag"), rosbag::BagException);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pilz_trajectory_generation/stage_times.h"
+
+using namespace pilz;
+
+/**
+ * @brief Check that the stages keep the order of their first report and repeated stages are summed up
+ */
+TEST(StageTimesTest, AddAccumulatesInOrder)
+{
+  StageTimes times;
+  times.add("b", 1.);
+  times.add("a", 2.);
+  times.add("b", 0.5);
+
+  ASSERT_EQ(2u, times.getStages().size());
+  EXPECT_EQ("b", times.getStages().at(0));
+  EXPECT_EQ("a", times.getStages().at(1));
+  EXPECT_DOUBLE_EQ(1.5, times.get("b"));
+  EXPECT_DOUBLE_EQ(2., times.get("a"));
+  EXPECT_DOUBLE_EQ(0., times.get("unknown"));
+  EXPECT_DOUBLE_EQ(3.5, times.total());
+
+  times.clear();
+  EXPECT_TRUE(times.getStages().empty());
+  EXPECT_TRUE(times.getDurations().empty());
+}
+
+/**
+ * @brief Check that the stop watch reports the time between the laps
+ */
+TEST(StageTimesTest, StopWatchLaps)
+{
+  StageTimes times;
+  StageStopWatch stop_watch(&times);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stop_watch.lap("first");
+  stop_watch.lap("second");
+
+  ASSERT_EQ(2u, times.getStages().size());
+  EXPECT_GE(times.get("first"), 0.01);
+  EXPECT_LT(times.get("second"), times.get("first"));
+}
+
+/**
+ * @brief Check that a stop watch without StageTimes can be used
+ */
+TEST(StageTimesTest, StopWatchWithoutTimes)
+{
+  StageStopWatch stop_watch(nullptr);
+  EXPECT_NO_THROW(stop_watch.lap("stage"));
+}
+
+/**
+ * @brief Check that each lap samples the heap peak of the resource meter, also without StageTimes
+ */
+TEST(StageTimesTest, StopWatchSamplesHeap)
+{
+  static constexpr std::size_t block_bytes {16 * 1024 * 1024};
+  ResourceUsage usage;
+  {
+    ResourceMeter meter(&usage);
+    StageStopWatch stop_watch(nullptr, &meter);
+    std::unique_ptr<std::vector<char> > block {new std::vector<char>(block_bytes, 1)};
+    stop_watch.lap("stage");
+  }
+  EXPECT_GE(usage.heap_peak_bytes, block_bytes);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
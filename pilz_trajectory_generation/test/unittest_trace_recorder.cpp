@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+using namespace pilz;
+
+namespace
+{
+
+std::size_t countOccurrences(const std::string& text, const std::string& pattern)
+{
+  std::size_t count {0};
+  for(std::size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+  {
+    ++count;
+  }
+  return count;
+}
+
+}
+
+/**
+ * @brief Check that nothing is recorded before the recorder is enabled
+ */
+TEST(TraceRecorderTest, DisabledRecordsNothing)
+{
+  TraceRecorder recorder;
+  {
+    TraceSpan span("disabled", recorder);
+  }
+
+  EXPECT_FALSE(recorder.isEnabled());
+  EXPECT_EQ(0u, recorder.getCapacity());
+  EXPECT_EQ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[]}", recorder.toChromeTraceJson());
+
+  recorder.enable(0);
+  EXPECT_FALSE(recorder.isEnabled());
+}
+
+/**
+ * @brief Check that nested spans are exported as complete events on the same thread
+ */
+TEST(TraceRecorderTest, NestedSpans)
+{
+  TraceRecorder recorder;
+  recorder.enable(10);
+  {
+    TraceSpan outer("outer", recorder);
+    TraceSpan inner("inner", recorder);
+  }
+
+  const std::string json {recorder.toChromeTraceJson()};
+  EXPECT_EQ(2u, countOccurrences(json, "\"ph\":\"X\""));
+  // the inner span finishes first
+  ASSERT_NE(std::string::npos, json.find("\"name\":\"inner\""));
+  ASSERT_NE(std::string::npos, json.find("\"name\":\"outer\""));
+  EXPECT_LT(json.find("\"name\":\"inner\""), json.find("\"name\":\"outer\""));
+}
+
+/**
+ * @brief Check that the ring buffer keeps the latest spans and that the capacity is kept by later enable() calls
+ */
+TEST(TraceRecorderTest, RingBufferOverwritesOldestSpans)
+{
+  TraceRecorder recorder;
+  recorder.enable(3);
+  recorder.enable(5);
+  EXPECT_EQ(3u, recorder.getCapacity());
+
+  recorder.record("first", 0, 1000);
+  for(int i = 0; i < 3; ++i)
+  {
+    recorder.record("later", 1000, 3000);
+  }
+
+  const std::string json {recorder.toChromeTraceJson()};
+  EXPECT_EQ(0u, countOccurrences(json, "\"name\":\"first\""));
+  EXPECT_EQ(3u, countOccurrences(json, "\"name\":\"later\""));
+  EXPECT_NE(std::string::npos, json.find("\"ts\":1.000,\"dur\":2.000"));
+}
+
+/**
+ * @brief Check that disable() stops recording and clear() removes the recorded spans
+ */
+TEST(TraceRecorderTest, DisableAndClear)
+{
+  TraceRecorder recorder;
+  recorder.enable(10);
+  recorder.record("recorded", 0, 1);
+  recorder.disable();
+  recorder.record("ignored", 0, 1);
+
+  std::string json {recorder.toChromeTraceJson()};
+  EXPECT_EQ(1u, countOccurrences(json, "\"name\":\"recorded\""));
+  EXPECT_EQ(0u, countOccurrences(json, "\"name\":\"ignored\""));
+
+  recorder.clear();
+  json = recorder.toChromeTraceJson();
+  EXPECT_EQ(0u, countOccurrences(json, "\"name\":"));
+}
+
+/**
+ * @brief Check that spans of concurrent threads are recorded with different thread ids
+ */
+TEST(TraceRecorderTest, ConcurrentThreads)
+{
+  TraceRecorder recorder;
+  recorder.enable(1000);
+
+  std::vector<std::thread> threads;
+  for(int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&recorder]()
+    {
+      for(int j = 0; j < 100; ++j)
+      {
+        TraceSpan span("worker", recorder);
+      }
+    });
+  }
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  const std::string json {recorder.toChromeTraceJson()};
+  EXPECT_EQ(400u, countOccurrences(json, "\"name\":\"worker\""));
+
+  std::vector<std::string> thread_ids;
+  for(std::size_t pos = json.find("\"tid\":"); pos != std::string::npos; pos = json.find("\"tid\":", pos + 1))
+  {
+    const std::string id {json.substr(pos, json.find('}', pos) - pos)};
+    if(std::find(thread_ids.begin(), thread_ids.end(), id) == thread_ids.end())
+    {
+      thread_ids.push_back(id);
+    }
+  }
+  EXPECT_EQ(4u, thread_ids.size());
+}
+
+/**
+ * @brief Check that the trace is written to the file and that invalid files are reported
+ */
+TEST(TraceRecorderTest, WriteChromeTrace)
+{
+  TraceRecorder recorder;
+  recorder.enable(10);
+  recorder.record("written", 0, 1);
+
+  const std::string file_name {"unittest_trace_recorder.json"};
+  ASSERT_TRUE(recorder.writeChromeTrace(file_name));
+
+  std::ifstream file(file_name);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_EQ(recorder.toChromeTraceJson() + "\n", content.str());
+  std::remove(file_name.c_str());
+
+  EXPECT_FALSE(recorder.writeChromeTrace("/non/existing/directory/trace.json"));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
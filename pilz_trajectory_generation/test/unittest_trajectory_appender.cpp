@@ -181,6 +181,54 @@ TEST_F(TrajectoryAppenderTest, testMergeWithDifferentFirstPoint)
   ASSERT_EQ(duration_from_previous, traj1.getWayPointDurationFromPrevious(3));
 }
 
+/**
+ * @brief Test that the appended waypoints share the states of the source trajectory.
+ *
+ * Test Sequence:
+ *  1. Create two trajectories where the last point of the first is equal to the first point of the second.
+ *  2. Call TrajectoryAppender::merge.
+ *
+ * Expected Results:
+ *  1. -
+ *  2. The appended waypoints point to the states of the source trajectory.
+ */
+TEST_F(TrajectoryAppenderTest, testMergeSharesStates)
+{
+  using moveit::core::RobotState;
+  using moveit::core::RobotStatePtr;
+  using robot_trajectory::RobotTrajectory;
+
+  const double duration_from_previous = 0.1;
+  std::vector<double> zeros;
+  zeros.resize(robot_model_->getVariableCount(), 0.0);
+
+  RobotStatePtr robot_state1 = std::make_shared<RobotState>(robot_model_);
+  robot_state1->setVariablePositions(zeros);
+  robot_state1->setVariableVelocities(zeros);
+  robot_state1->setVariableAccelerations(zeros);
+
+  RobotStatePtr robot_state2 = std::make_shared<RobotState>(*robot_state1);
+  robot_state2->setVariablePosition(0, 0.1);
+  RobotStatePtr robot_state3 = std::make_shared<RobotState>(*robot_state1);
+  robot_state3->setVariablePosition(0, 0.2);
+
+  RobotTrajectory traj1(robot_model_, planning_group_);
+  traj1.addSuffixWayPoint(robot_state1, duration_from_previous);
+
+  RobotTrajectory traj2(robot_model_, planning_group_);
+  traj2.addSuffixWayPoint(std::make_shared<RobotState>(*robot_state1), duration_from_previous);
+  traj2.addSuffixWayPoint(robot_state2, duration_from_previous);
+  traj2.addSuffixWayPoint(robot_state3, duration_from_previous);
+
+  appender_.merge(traj1, traj2);
+
+  ASSERT_EQ(3u, traj1.getWayPointCount());
+  EXPECT_EQ(robot_state1, traj1.getWayPointPtr(0));
+  EXPECT_EQ(robot_state2, traj1.getWayPointPtr(1));
+  EXPECT_EQ(robot_state3, traj1.getWayPointPtr(2));
+  EXPECT_EQ(3u, traj2.getWayPointCount());
+}
+
 }  // namespace pilz_trajectory_generation
 
 int main(int argc, char **argv)
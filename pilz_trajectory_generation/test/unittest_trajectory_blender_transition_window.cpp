@@ -533,6 +533,60 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testLinLinBlending)
                                           cartesian_angular_velocity_tolerance_));
 }
 
+/**
+ * @brief  Tests the blending of two linear trajectories with the sampling time given in the request.
+ *
+ * Test Sequence:
+ *    1. Generate two linear trajectories from the test data set.
+ *    2. Generate blending trajectory, with the sampling time passed in the request.
+ *    3. Generate blending trajectory, with the sampling time determined by the blender.
+ *
+ * Expected Results:
+ *    1. Two linear trajectories generated.
+ *    2. Blending trajectory generated, no bound is violated.
+ *    3. Blending trajectory generated, it equals the one of step 2.
+ */
+TEST_P(TrajectoryBlenderTransitionWindowTest, testLinLinBlendingGivenSamplingTime)
+{
+  Sequence seq {data_loader_->getSequence("SimpleSequence")};
+
+  std::vector<planning_interface::MotionPlanResponse> res {generateLinTrajs(seq, 2)};
+
+  pilz::TrajectoryBlendRequest blend_req;
+  pilz::TrajectoryBlendResponse blend_res;
+
+  blend_req.group_name = planning_group_;
+  blend_req.link_name = target_link_;
+  blend_req.blend_radius = seq.getBlendRadius(0);
+  blend_req.sampling_time = sampling_time_;
+
+  blend_req.first_trajectory = res.at(0).trajectory_;
+  blend_req.second_trajectory = res.at(1).trajectory_;
+
+  ASSERT_TRUE(blender_->blend(blend_req, blend_res));
+
+  EXPECT_TRUE(testutils::checkBlendResult(blend_req,
+                                          blend_res,
+                                          planner_limits_,
+                                          joint_velocity_tolerance_,
+                                          joint_acceleration_tolerance_,
+                                          cartesian_velocity_tolerance_,
+                                          cartesian_angular_velocity_tolerance_));
+
+  pilz::TrajectoryBlendResponse determined_blend_res;
+  blend_req.sampling_time = 0.;
+  ASSERT_TRUE(blender_->blend(blend_req, determined_blend_res));
+
+  ASSERT_EQ(determined_blend_res.blend_trajectory->getWayPointCount(), blend_res.blend_trajectory->getWayPointCount());
+  for(std::size_t i = 0; i < blend_res.blend_trajectory->getWayPointCount(); ++i)
+  {
+    EXPECT_NEAR(determined_blend_res.blend_trajectory->getWayPointDurationFromPrevious(i),
+                blend_res.blend_trajectory->getWayPointDurationFromPrevious(i), 1e-9);
+    EXPECT_TRUE(pilz::isRobotStateEqual(determined_blend_res.blend_trajectory->getWayPoint(i),
+                                        blend_res.blend_trajectory->getWayPoint(i), planning_group_, 1e-9));
+  }
+}
+
 /**
  * @brief  Tests the blending of two cartesian linear trajectories which have
  * an overlap in the blending sphere using robot model. To be precise,
@@ -619,7 +673,7 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testNonLinearBlending)
     auto lin_traj {res.at(traj_index).trajectory_};
 
     CartesianTrajectory cart_traj;
-    trajectory_msgs::JointTrajectory joint_traj;
+    pilz::JointTrajectoryColumns joint_traj;
     const double duration {lin_traj->getWayPointDurationFromStart(lin_traj->getWayPointCount())};
     // time from start zero does not work
     const double time_from_start_offset {TIME_SCALING_FACTOR*lin_traj->getWayPointDurations().back()};
@@ -666,6 +720,8 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testNonLinearBlending)
     }
 
     moveit_msgs::MoveItErrorCodes error_code;
+    JointTrajectoryGenerationOptions options;
+    options.check_self_collision = true;
     if (!generateJointTrajectory(robot_model_,
                                  planner_limits_.getJointLimitContainer(),
                                  cart_traj,
@@ -675,17 +731,15 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testNonLinearBlending)
                                  initial_joint_velocity,
                                  joint_traj,
                                  error_code,
-                                 true))
+                                 options))
     {
       std::runtime_error("Failed to generate trajectory.");
     }
 
-    joint_traj.points.back().velocities.assign(joint_traj.points.back().velocities.size(), 0.0);
-    joint_traj.points.back().accelerations.assign(joint_traj.points.back().accelerations.size(), 0.0);
+    joint_traj.setLastPointAtRest();
 
-    // convert trajectory_msgs::JointTrajectory to robot_trajectory::RobotTrajectory
     sine_trajs[traj_index] = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, planning_group_);
-    sine_trajs.at(traj_index)->setRobotTrajectoryMsg(lin_traj->getFirstWayPoint(), joint_traj);
+    joint_traj.toRobotTrajectory(lin_traj->getFirstWayPoint(), *sine_trajs.at(traj_index));
   }
 
   TrajectoryBlendRequest blend_req;
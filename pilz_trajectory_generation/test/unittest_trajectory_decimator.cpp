@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include "pilz_trajectory_generation/trajectory_decimator.h"
+
+const std::string PARAM_MODEL_NAME {"robot_description"};
+const std::string PARAM_PLANNING_GROUP_NAME("planning_group");
+
+static constexpr double SAMPLING_TIME {0.008};
+static constexpr double TOLERANCE {1e-4};
+
+class TrajectoryDecimatorTest : public testing::Test
+{
+protected:
+  virtual void SetUp();
+
+  /**
+   * @brief Adds a waypoint with the given position, velocity and acceleration of all joints of the group
+   */
+  void addWayPoint(robot_trajectory::RobotTrajectory& trajectory, double position, double velocity,
+                   double acceleration, double duration_from_previous);
+
+  /**
+   * @brief Creates a trajectory with a trapezoidal velocity profile of all joints, sampled with SAMPLING_TIME
+   */
+  robot_trajectory::RobotTrajectory createTrapezoidalTrajectory();
+
+protected:
+  ros::NodeHandle ph_ {"~"};
+  std::string planning_group_;
+  robot_model_loader::RobotModelLoader robot_model_loader_ {PARAM_MODEL_NAME};
+  robot_model::RobotModelConstPtr robot_model_ {robot_model_loader_.getModel()};
+};
+
+void TrajectoryDecimatorTest::SetUp()
+{
+  ASSERT_TRUE(ph_.getParam(PARAM_PLANNING_GROUP_NAME, planning_group_));
+  ASSERT_TRUE(robot_model_->hasJointModelGroup(planning_group_));
+}
+
+void TrajectoryDecimatorTest::addWayPoint(robot_trajectory::RobotTrajectory& trajectory, double position,
+                                          double velocity, double acceleration, double duration_from_previous)
+{
+  robot_state::RobotStatePtr state {new robot_state::RobotState(robot_model_)};
+  state->setToDefaultValues();
+  const std::size_t variable_count {robot_model_->getJointModelGroup(planning_group_)->getVariableCount()};
+  state->setJointGroupPositions(planning_group_, std::vector<double>(variable_count, position));
+  state->setJointGroupVelocities(planning_group_, std::vector<double>(variable_count, velocity));
+  state->setJointGroupAccelerations(planning_group_, std::vector<double>(variable_count, acceleration));
+  trajectory.addSuffixWayPoint(state, duration_from_previous);
+}
+
+robot_trajectory::RobotTrajectory TrajectoryDecimatorTest::createTrapezoidalTrajectory()
+{
+  // accelerate for 0.5s, move with constant velocity for 2s, decelerate for 0.5s
+  robot_trajectory::RobotTrajectory trajectory(robot_model_, planning_group_);
+  const std::size_t count {static_cast<std::size_t>(std::round(3. / SAMPLING_TIME)) + 1};
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    const double t {i * SAMPLING_TIME};
+    if(t < 0.5)
+    {
+      addWayPoint(trajectory, 0.5 * t * t, t, 1., i == 0 ? 0. : SAMPLING_TIME);
+    }
+    else if(t < 2.5)
+    {
+      addWayPoint(trajectory, 0.125 + 0.5 * (t - 0.5), 0.5, 0., SAMPLING_TIME);
+    }
+    else
+    {
+      const double r {t - 2.5};
+      addWayPoint(trajectory, 1.125 + 0.5 * r - 0.5 * r * r, 0.5 - r, -1., SAMPLING_TIME);
+    }
+  }
+  return trajectory;
+}
+
+/**
+ * @brief Checks that the interpolation passes the start and the end of the segment.
+ */
+TEST_F(TrajectoryDecimatorTest, testInterpolationBoundaries)
+{
+  for(const auto interpolation : {pilz::TrajectoryDecimator::CUBIC, pilz::TrajectoryDecimator::QUINTIC})
+  {
+    EXPECT_NEAR(0.3, pilz::TrajectoryDecimator::interpolate(interpolation, 0.7, 0., 0.3, -1.2, 2., 1.1, 0.4, -3.),
+                1e-12);
+    EXPECT_NEAR(1.1, pilz::TrajectoryDecimator::interpolate(interpolation, 0.7, 0.7, 0.3, -1.2, 2., 1.1, 0.4, -3.),
+                1e-12);
+  }
+}
+
+/**
+ * @brief Checks the names of the interpolations.
+ */
+TEST_F(TrajectoryDecimatorTest, testParseInterpolation)
+{
+  pilz::TrajectoryDecimator::Interpolation interpolation;
+  EXPECT_TRUE(pilz::TrajectoryDecimator::parseInterpolation("cubic", interpolation));
+  EXPECT_EQ(pilz::TrajectoryDecimator::CUBIC, interpolation);
+  EXPECT_TRUE(pilz::TrajectoryDecimator::parseInterpolation("quintic", interpolation));
+  EXPECT_EQ(pilz::TrajectoryDecimator::QUINTIC, interpolation);
+  EXPECT_FALSE(pilz::TrajectoryDecimator::parseInterpolation("linear", interpolation));
+}
+
+/**
+ * @brief Checks that a constant velocity motion is reduced to its first and last waypoint.
+ *
+ * Test Sequence:
+ *    1. Decimate a trajectory with constant velocity.
+ *
+ * Expected Results:
+ *    1. Only the first and the last waypoint remain with the original duration, the states are shared.
+ */
+TEST_F(TrajectoryDecimatorTest, testConstantVelocity)
+{
+  robot_trajectory::RobotTrajectory trajectory(robot_model_, planning_group_);
+  for(std::size_t i = 0; i < 100; ++i)
+  {
+    addWayPoint(trajectory, 0.01 * i, 0.01 / SAMPLING_TIME, 0., i == 0 ? 0. : SAMPLING_TIME);
+  }
+  const robot_state::RobotStatePtr first {trajectory.getFirstWayPointPtr()};
+  const robot_state::RobotStatePtr last {trajectory.getLastWayPointPtr()};
+  const double duration {trajectory.getWayPointDurationFromStart(trajectory.getWayPointCount() - 1)};
+
+  const pilz::DecimationStatistics statistics {
+    pilz::TrajectoryDecimator(TOLERANCE, pilz::TrajectoryDecimator::CUBIC).decimate(trajectory)};
+
+  EXPECT_EQ(100u, statistics.input_points);
+  EXPECT_EQ(2u, statistics.output_points);
+  EXPECT_DOUBLE_EQ(50., statistics.getCompressionRatio());
+  ASSERT_EQ(2u, trajectory.getWayPointCount());
+  EXPECT_EQ(first, trajectory.getFirstWayPointPtr());
+  EXPECT_EQ(last, trajectory.getLastWayPointPtr());
+  EXPECT_NEAR(duration, trajectory.getWayPointDurationFromStart(1), 1e-9);
+}
+
+/**
+ * @brief Checks that no waypoint is removed if none can be reconstructed or if the decimation is disabled.
+ *
+ * Test Sequence:
+ *    1. Decimate a zigzag trajectory.
+ *    2. Decimate a trajectory with a tolerance of zero.
+ *
+ * Expected Results:
+ *    1. All waypoints remain.
+ *    2. All waypoints remain.
+ */
+TEST_F(TrajectoryDecimatorTest, testNothingToRemove)
+{
+  robot_trajectory::RobotTrajectory zigzag(robot_model_, planning_group_);
+  for(std::size_t i = 0; i < 10; ++i)
+  {
+    addWayPoint(zigzag, (i % 2) * 0.1, 0., 0., i == 0 ? 0. : SAMPLING_TIME);
+  }
+  const pilz::DecimationStatistics statistics {
+    pilz::TrajectoryDecimator(TOLERANCE, pilz::TrajectoryDecimator::QUINTIC).decimate(zigzag)};
+  EXPECT_EQ(10u, statistics.output_points);
+  EXPECT_EQ(1., statistics.getCompressionRatio());
+  EXPECT_EQ(10u, zigzag.getWayPointCount());
+
+  robot_trajectory::RobotTrajectory trajectory {createTrapezoidalTrajectory()};
+  const std::size_t count {trajectory.getWayPointCount()};
+  pilz::TrajectoryDecimator(0., pilz::TrajectoryDecimator::QUINTIC).decimate(trajectory);
+  EXPECT_EQ(count, trajectory.getWayPointCount());
+}
+
+/**
+ * @brief Checks that the interpolation of the decimated trajectory passes all removed waypoints within the tolerance.
+ *
+ * Test Sequence:
+ *    1. Decimate a trajectory with a trapezoidal velocity profile for a cubic and a quintic interpolation.
+ *    2. Interpolate the decimated trajectory at the times of the original waypoints.
+ *
+ * Expected Results:
+ *    1. Most of the waypoints are removed, the duration is unchanged.
+ *    2. The interpolated positions deviate by at most the tolerance.
+ */
+TEST_F(TrajectoryDecimatorTest, testRemovedWayPointsWithinTolerance)
+{
+  const robot_trajectory::RobotTrajectory original {createTrapezoidalTrajectory()};
+  const std::vector<int>& variable_indices {
+    robot_model_->getJointModelGroup(planning_group_)->getVariableIndexList()};
+
+  for(const auto interpolation : {pilz::TrajectoryDecimator::CUBIC, pilz::TrajectoryDecimator::QUINTIC})
+  {
+    robot_trajectory::RobotTrajectory decimated {original};
+    const pilz::DecimationStatistics statistics {
+      pilz::TrajectoryDecimator(TOLERANCE, interpolation).decimate(decimated)};
+    EXPECT_GT(statistics.getCompressionRatio(), 10.);
+    EXPECT_NEAR(original.getWayPointDurationFromStart(original.getWayPointCount() - 1),
+                decimated.getWayPointDurationFromStart(decimated.getWayPointCount() - 1), 1e-9);
+
+    double segment_start {0.};
+    std::size_t segment {1};
+    double time {0.};
+    for(std::size_t i = 0; i < original.getWayPointCount(); ++i)
+    {
+      time += original.getWayPointDurationFromPrevious(i);
+      while(segment + 1 < decimated.getWayPointCount()
+            && segment_start + decimated.getWayPointDurationFromPrevious(segment) < time - 1e-9)
+      {
+        segment_start += decimated.getWayPointDurationFromPrevious(segment);
+        ++segment;
+      }
+      const robot_state::RobotState& start {decimated.getWayPoint(segment - 1)};
+      const robot_state::RobotState& end {decimated.getWayPoint(segment)};
+      for(const int index : variable_indices)
+      {
+        const double position {pilz::TrajectoryDecimator::interpolate(
+                interpolation, decimated.getWayPointDurationFromPrevious(segment), time - segment_start,
+                start.getVariablePosition(index), start.getVariableVelocity(index),
+                start.getVariableAcceleration(index), end.getVariablePosition(index),
+                end.getVariableVelocity(index), end.getVariableAcceleration(index))};
+        EXPECT_NEAR(original.getWayPoint(i).getVariablePosition(index), position, TOLERANCE) << "waypoint " << i;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Checks the decimation of a column-wise joint trajectory.
+ *
+ * Test Sequence:
+ *    1. Decimate a trapezoidal joint trajectory of two joints with a quintic interpolation.
+ *
+ * Expected Results:
+ *    1. Points are removed, the first and the last point are kept and the kept points are unchanged.
+ */
+TEST_F(TrajectoryDecimatorTest, testJointTrajectoryColumns)
+{
+  const robot_trajectory::RobotTrajectory original {createTrapezoidalTrajectory()};
+  const std::vector<std::string> joint_names {"joint_a", "joint_b"};
+  const int index {robot_model_->getJointModelGroup(planning_group_)->getVariableIndexList().front()};
+
+  pilz::JointTrajectoryColumns trajectory(joint_names);
+  double time {0.};
+  for(std::size_t i = 0; i < original.getWayPointCount(); ++i)
+  {
+    time += original.getWayPointDurationFromPrevious(i);
+    const robot_state::RobotState& state {original.getWayPoint(i)};
+    trajectory.addPoint(time,
+                        std::vector<double>(2, state.getVariablePosition(index)),
+                        std::vector<double>(2, state.getVariableVelocity(index)),
+                        std::vector<double>(2, state.getVariableAcceleration(index)));
+  }
+  const pilz::JointTrajectoryColumns samples {trajectory};
+
+  const pilz::DecimationStatistics statistics {
+    pilz::TrajectoryDecimator(TOLERANCE, pilz::TrajectoryDecimator::QUINTIC).decimate(trajectory)};
+
+  EXPECT_EQ(samples.size(), statistics.input_points);
+  EXPECT_EQ(trajectory.size(), statistics.output_points);
+  ASSERT_LT(trajectory.size(), samples.size());
+  ASSERT_GE(trajectory.size(), 2u);
+  EXPECT_EQ(0., trajectory.getTimeFromStart(0));
+  EXPECT_EQ(samples.getTimeFromStart(samples.size() - 1), trajectory.getTimeFromStart(trajectory.size() - 1));
+  EXPECT_EQ(samples.getPosition(1, samples.size() - 1), trajectory.getPosition(1, trajectory.size() - 1));
+
+  std::size_t sample {0};
+  for(std::size_t i = 0; i < trajectory.size(); ++i)
+  {
+    while(samples.getTimeFromStart(sample) < trajectory.getTimeFromStart(i))
+    {
+      ++sample;
+    }
+    ASSERT_EQ(samples.getTimeFromStart(sample), trajectory.getTimeFromStart(i));
+    for(std::size_t j = 0; j < joint_names.size(); ++j)
+    {
+      EXPECT_EQ(samples.getPosition(j, sample), trajectory.getPosition(j, i));
+      EXPECT_EQ(samples.getVelocity(j, sample), trajectory.getVelocity(j, i));
+      EXPECT_EQ(samples.getAcceleration(j, sample), trajectory.getAcceleration(j, i));
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "unittest_trajectory_decimator");
+  ros::NodeHandle nh;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
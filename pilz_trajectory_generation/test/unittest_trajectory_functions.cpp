@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <math.h>
 #include <vector>
 #include <string>
@@ -30,7 +31,9 @@
 #include <moveit_msgs/RobotState.h>
 #include <Eigen/Geometry>
 #include <eigen_conversions/eigen_msg.h>
+#include <geometric_shapes/shapes.h>
 
+#include <kdl/path_line.hpp>
 #include <kdl/path_roundedcomposite.hpp>
 #include <kdl/rotational_interpolation_sa.hpp>
 #include <kdl/frames.hpp>
@@ -39,6 +42,7 @@
 #include <kdl/trajectory_segment.hpp>
 
 #include "pilz_trajectory_generation/trajectory_functions.h"
+#include "pilz_trajectory_generation/joint_trajectory_columns.h"
 #include "pilz_trajectory_generation/limits_container.h"
 #include "pilz_trajectory_generation/cartesian_trajectory.h"
 #include "pilz_trajectory_generation/cartesian_trajectory_point.h"
@@ -359,6 +363,130 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testComputePoseIK)
   }
 }
 
+/**
+ * @brief Test the warm up of the kinematics
+ *
+ * Test Sequence:
+ *    1. Hold the scene of the self collision check and warm up the kinematics of all groups.
+ *    2. Compute IK of a reachable pose with the self collision check.
+ *
+ * Expected Results:
+ *    1. At least the tested planning group is warmed up, the held scene is the one of the robot model.
+ *    2. IK is still solvable after the warm up, the self collision check uses the held scene and keeps no copy.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testWarmUpKinematics)
+{
+  const planning_scene::PlanningSceneConstPtr scene {pilz::getSelfCollisionScene(robot_model_)};
+  ASSERT_NE(nullptr, scene);
+  EXPECT_EQ(robot_model_, scene->getRobotModel());
+  const long scene_users {scene.use_count()};
+
+  EXPECT_GE(pilz::warmUpKinematics(robot_model_, 3), 1u);
+  EXPECT_EQ(scene, pilz::getSelfCollisionScene(robot_model_));
+
+  // the pose is reached without self collision, the IK solution is the state itself
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToDefaultValues();
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  std::vector<double> positions;
+  do
+  {
+    rstate.setToRandomPositions(jmg, rng_);
+    rstate.copyJointGroupPositions(jmg, positions);
+  }
+  while(!pilz::isStateColliding(true, robot_model_, &rstate, jmg, positions.data()));
+  std::map<std::string, double> joint_state;
+  for(const auto& joint_name : jmg->getActiveJointModelNames())
+  {
+    joint_state[joint_name] = rstate.getVariablePosition(joint_name);
+  }
+
+  Eigen::Isometry3d pose;
+  ASSERT_TRUE(pilz::computeLinkFK(robot_model_, tcp_link_, joint_state, pose));
+
+  std::map<std::string, double> solution;
+  EXPECT_TRUE(pilz::computePoseIK(robot_model_, planning_group_, tcp_link_, pose, robot_model_->getModelFrame(),
+                                  joint_state, solution, true));
+  EXPECT_EQ(scene, pilz::getSelfCollisionScene(robot_model_));
+  EXPECT_EQ(scene_users, scene.use_count()) << "The self collision check kept a copy of the scene.";
+}
+
+/**
+ * @brief Test that the scenes of the self collision check are shared per robot model
+ *
+ * Test Sequence:
+ *    1. Get the scene of the robot model and of a second instance of the model.
+ *    2. Release the second model and its scene.
+ *
+ * Expected Results:
+ *    1. Each model has its own scene, the scene of the robot model is shared.
+ *    2. The second model is destroyed, the scene of the robot model is still shared.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testSelfCollisionScenePerModel)
+{
+  const planning_scene::PlanningSceneConstPtr scene {pilz::getSelfCollisionScene(robot_model_)};
+  robot_model::RobotModelConstPtr other_model {robot_model_loader::RobotModelLoader(GetParam()).getModel()};
+  ASSERT_NE(robot_model_, other_model);
+  planning_scene::PlanningSceneConstPtr other_scene {pilz::getSelfCollisionScene(other_model)};
+
+  EXPECT_NE(scene, other_scene);
+  EXPECT_EQ(other_model, other_scene->getRobotModel());
+  EXPECT_EQ(scene, pilz::getSelfCollisionScene(robot_model_));
+  EXPECT_EQ(other_scene, pilz::getSelfCollisionScene(other_model));
+
+  const std::weak_ptr<const robot_model::RobotModel> released_model {other_model};
+  other_scene.reset();
+  other_model.reset();
+  EXPECT_TRUE(released_model.expired());
+  EXPECT_EQ(scene, pilz::getSelfCollisionScene(robot_model_));
+}
+
+/**
+ * @brief Test that the kinematics computed with a reused robot state equal the ones computed with the robot model
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testComputeKinematicsReusedRobotState)
+{
+  robot_state::RobotState rstate(robot_model_);
+  robot_state::RobotState workspace(robot_model_);
+  workspace.setToDefaultValues();
+
+  const std::string frame_id = robot_model_->getModelFrame();
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+
+  while(random_test_number_>0)
+  {
+    // sample random robot state
+    rstate.setToRandomPositions(jmg, rng_);
+
+    std::map<std::string, double> joint_state, ik_seed;
+    for(const auto& joint_name : jmg->getActiveJointModelNames())
+    {
+      joint_state[joint_name] = rstate.getVariablePosition(joint_name);
+      ik_seed[joint_name] = rstate.getVariablePosition(joint_name)
+          + (rstate.getVariablePosition(joint_name)>0 ? -IK_SEED_OFFSET : IK_SEED_OFFSET);
+    }
+
+    // forward kinematics
+    Eigen::Isometry3d pose_expect, pose_actual;
+    ASSERT_TRUE(pilz::computeLinkFK(robot_model_, tcp_link_, joint_state, pose_expect));
+    ASSERT_TRUE(pilz::computeLinkFK(workspace, tcp_link_, joint_state, pose_actual));
+    EXPECT_TRUE(tfNear(pose_expect, pose_actual, EPSILON));
+
+    // inverse kinematics
+    std::map<std::string, double> ik_expect, ik_actual;
+    ASSERT_TRUE(pilz::computePoseIK(robot_model_, planning_group_, tcp_link_, pose_expect, frame_id,
+                                    ik_seed, ik_expect, false));
+    ASSERT_TRUE(pilz::computePoseIK(workspace, planning_group_, tcp_link_, pose_expect, frame_id,
+                                    ik_seed, ik_actual, false));
+    for(const auto& joint_pair : ik_expect)
+    {
+      EXPECT_NEAR(joint_pair.second, ik_actual.at(joint_pair.first), EPSILON);
+    }
+
+    --random_test_number_;
+  }
+}
+
 /**
  * @brief Test computePoseIK for invalid group_name
  */
@@ -559,6 +687,61 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testComputePoseIKSelfCollisionFo
                                   true));
 }
 
+/**
+ * @brief Test that the calls, the validity checks and the failures of computePoseIK are counted
+ *
+ * Test Sequence:
+ *    1. Compute the ik of a pose in self collision without and with collision check, passing the statistics.
+ *    2. Compute the ik for an invalid group and an invalid frame, passing the statistics.
+ *
+ * Expected Results:
+ *    1. Two solver calls, the solutions of the second call are rejected, which fails with NO_SOLUTION.
+ *    2. The failures are counted by reason without calling the solver.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testComputePoseIKStatistics)
+{
+  robot_state::RobotState rstate(robot_model_);
+  const std::string frame_id = robot_model_->getModelFrame();
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+
+  std::map<std::string, double> ik_seed;
+  for (auto joint_name: jmg->getActiveJointModelNames())
+  {
+    ik_seed[joint_name] = 0;
+  }
+  rstate.setJointGroupPositions(jmg, std::vector<double> {0, 2.3, -2.3, 0, 0, 0});
+  const Eigen::Isometry3d pose = rstate.getFrameTransform(tcp_link_);
+
+  pilz::IKStatistics statistics;
+  std::map<std::string, double> ik_actual;
+  EXPECT_TRUE(pilz::computePoseIK(robot_model_, planning_group_, tcp_link_, pose, frame_id, ik_seed, ik_actual,
+                                  false, pilz::DEFAULT_IK_TIMEOUT, &statistics));
+  EXPECT_EQ(1u, statistics.validity_checks);
+  EXPECT_EQ(0u, statistics.rejected_solutions);
+
+  EXPECT_FALSE(pilz::computePoseIK(robot_model_, planning_group_, tcp_link_, pose, frame_id, ik_seed, ik_actual,
+                                   true, pilz::DEFAULT_IK_TIMEOUT, &statistics));
+  EXPECT_EQ(2u, statistics.calls);
+  EXPECT_EQ(2u, statistics.solver_calls);
+  EXPECT_GE(statistics.rejected_solutions, 1u);
+  EXPECT_EQ(statistics.validity_checks, statistics.rejected_solutions + 1);
+  EXPECT_EQ(1u, statistics.failures[pilz::IKStatistics::NO_SOLUTION]);
+
+  EXPECT_FALSE(pilz::computePoseIK(robot_model_, "InvalidGroupName", tcp_link_, pose, frame_id, ik_seed, ik_actual,
+                                   false, pilz::DEFAULT_IK_TIMEOUT, &statistics));
+  EXPECT_FALSE(pilz::computePoseIK(robot_model_, planning_group_, tcp_link_, pose, "InvalidFrameId", ik_seed,
+                                   ik_actual, false, pilz::DEFAULT_IK_TIMEOUT, &statistics));
+  EXPECT_EQ(4u, statistics.calls);
+  EXPECT_EQ(2u, statistics.solver_calls);
+  EXPECT_EQ(1u, statistics.failures[pilz::IKStatistics::INVALID_GROUP]);
+  EXPECT_EQ(1u, statistics.failures[pilz::IKStatistics::INVALID_FRAME]);
+  EXPECT_EQ(3u, statistics.getFailureCount());
+
+  EXPECT_GT(statistics.validity_seconds, 0.);
+  EXPECT_GE(statistics.getSolverSeconds(), 0.);
+  EXPECT_LE(statistics.max_solver_call_seconds, statistics.ik_seconds);
+}
+
 /**
  * @brief Check that function VerifySampleJointLimits() returns 'false' in case
  * of very small sample duration.
@@ -691,6 +874,84 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testVerifySampleJointLimitsDecel
                                              duration_last, duration_current, joint_limits));
 }
 
+/**
+ * @brief Check that the JointLimitsTable addresses the limits by the variable index of the robot model.
+ *
+ * Test Sequence:
+ *    1. Create a table from limits of the first group joint and of a joint unknown to the model.
+ *
+ * Expected Results:
+ *    1. The limits of the first joint are found at its variable index, all other bounds are infinite
+ *       and the unknown joint is ignored.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testJointLimitsTableByVariableIndex)
+{
+  const std::string& test_joint_name {joint_names_.front()};
+
+  pilz_extensions::JointLimit test_joint_limits;
+  test_joint_limits.has_position_limits = true;
+  test_joint_limits.min_position = -1.0;
+  test_joint_limits.max_position = 1.0;
+  test_joint_limits.has_velocity_limits = true;
+  test_joint_limits.max_velocity = 2.0;
+  test_joint_limits.has_deceleration_limits = true;
+  test_joint_limits.max_deceleration = -3.0;
+
+  pilz::JointLimitsContainer joint_limits;
+  ASSERT_TRUE(joint_limits.addLimit(test_joint_name, test_joint_limits));
+  ASSERT_TRUE(joint_limits.addLimit("unknown_joint", test_joint_limits));
+
+  const pilz::JointLimitsTable table(robot_model_, joint_limits);
+  ASSERT_EQ(robot_model_->getVariableCount(), table.size());
+
+  const std::size_t index = robot_model_->getVariableIndex(test_joint_name);
+  EXPECT_TRUE(table.verifyPosition(index, 0.5));
+  EXPECT_FALSE(table.verifyPosition(index, 1.5));
+  EXPECT_TRUE(table.verifyVelocity(index, -2.0));
+  EXPECT_FALSE(table.verifyVelocity(index, -2.5));
+  EXPECT_TRUE(table.verifyAcceleration(index, 1.0e6));
+  EXPECT_TRUE(table.verifyDeceleration(index, -3.0));
+  EXPECT_FALSE(table.verifyDeceleration(index, -3.5));
+  EXPECT_EQ(3.0, table.getMaxDeceleration(index));
+
+  for(std::size_t i = 0; i < table.size(); ++i)
+  {
+    if(i != index)
+    {
+      EXPECT_TRUE(table.verifyVelocity(i, 1.0e6)) << "Unexpected velocity limit at index " << i;
+    }
+  }
+}
+
+/**
+ * @brief Check that the index based VerifySampleJointLimits() detects a velocity violation.
+ *
+ * Test Sequence:
+ *    1. Call function with a velocity violation of the first group joint.
+ *
+ * Expected Results:
+ *    1. Function returns 'false'.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testVerifySampleJointLimitsTableVelocityViolation)
+{
+  const std::vector<std::string> joint_names {joint_names_.front()};
+  const std::vector<std::size_t> variable_indices {
+    static_cast<std::size_t>(robot_model_->getVariableIndex(joint_names.front()))};
+
+  pilz_extensions::JointLimit test_joint_limits;
+  test_joint_limits.has_velocity_limits = true;
+  test_joint_limits.max_velocity = 1.0;
+  pilz::JointLimitsContainer joint_limits;
+  ASSERT_TRUE(joint_limits.addLimit(joint_names.front(), test_joint_limits));
+  const pilz::JointLimitsTable table(robot_model_, joint_limits);
+
+  const std::vector<double> position_last {0.0}, velocity_last {0.0};
+  EXPECT_TRUE(pilz::verifySampleJointLimits(table, variable_indices, joint_names,
+                                            position_last, velocity_last, {0.5}, 1.0, 1.0));
+  EXPECT_FALSE(pilz::verifySampleJointLimits(table, variable_indices, joint_names,
+                                             position_last, velocity_last, {2.0}, 1.0, 1.0));
+}
+
 /**
  * @brief Check that function generateJointTrajectory() returns 'false' if
  * a joint trajectory cannot be computed from a cartesian trajectory.
@@ -721,13 +982,14 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGenerateJointTrajectoryWithI
   std::string group_name {"invalid_group_name"};
   std::map<std::string, double> initial_joint_position;
   double sampling_time {0.1};
-  trajectory_msgs::JointTrajectory joint_trajectory;
+  pilz::JointTrajectoryColumns joint_trajectory;
   moveit_msgs::MoveItErrorCodes error_code;
-  bool check_self_collision {false};
+  pilz::JointTrajectoryGenerationOptions options;
+  options.check_self_collision = false;
 
   EXPECT_FALSE( pilz::generateJointTrajectory(robot_model_, joint_limits, kdl_trajectory, group_name, tcp_link_,
                                               initial_joint_position, sampling_time, joint_trajectory,
-                                              error_code, check_self_collision) );
+                                              error_code, options) );
 
   std::map<std::string, double> initial_joint_velocity;
 
@@ -739,10 +1001,62 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGenerateJointTrajectoryWithI
 
   EXPECT_FALSE( pilz::generateJointTrajectory(robot_model_, joint_limits, cartTraj, group_name, tcp_link_,
                                               initial_joint_position, initial_joint_velocity, joint_trajectory,
-                                              error_code, check_self_collision) );
+                                              error_code, options) );
 
 }
 
+/**
+ * @brief Check that function generateJointTrajectory() stops if the termination flag is set.
+ *
+ * Please note: Both function variants are tested in this test.
+ *
+ * Test Sequence:
+ *    1. Call function with a set termination flag.
+ *
+ * Expected Results:
+ *    1. Function returns 'false' with error code PREEMPTED and an empty joint trajectory.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGenerateJointTrajectoryTerminated)
+{
+  // Note: 'path' is deleted by KDL::Trajectory_Segment
+  KDL::Path_RoundedComposite* path = new KDL::Path_RoundedComposite(
+        0.2,0.01, new KDL::RotationalInterpolation_SingleAxis() );
+  path->Add(KDL::Frame(KDL::Rotation::RPY(0,0,0), KDL::Vector(-1,0,0)));
+  path->Finish();
+  // Note: 'velprof' is deleted by KDL::Trajectory_Segment
+  KDL::VelocityProfile* vel_prof = new KDL::VelocityProfile_Trap(0.5,0.1);
+  vel_prof->SetProfile(0,path->PathLength());
+  KDL::Trajectory_Segment kdl_trajectory(path, vel_prof);
+
+  pilz::JointLimitsContainer joint_limits;
+  std::map<std::string, double> initial_joint_position, initial_joint_velocity;
+  double sampling_time {0.1};
+  pilz::JointTrajectoryColumns joint_trajectory;
+  moveit_msgs::MoveItErrorCodes error_code;
+  std::atomic_bool terminated {true};
+  pilz::JointTrajectoryGenerationOptions options;
+  options.terminated = &terminated;
+
+  EXPECT_FALSE( pilz::generateJointTrajectory(robot_model_, joint_limits, kdl_trajectory, planning_group_, tcp_link_,
+                                              initial_joint_position, sampling_time, joint_trajectory,
+                                              error_code, options) );
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PREEMPTED, error_code.val);
+  EXPECT_EQ(0u, joint_trajectory.size());
+
+  pilz::CartesianTrajectory cartTraj;
+  cartTraj.group_name = planning_group_;
+  cartTraj.link_name = tcp_link_;
+  pilz::CartesianTrajectoryPoint cart_traj_point;
+  cartTraj.points.push_back(cart_traj_point);
+
+  error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  EXPECT_FALSE( pilz::generateJointTrajectory(robot_model_, joint_limits, cartTraj, planning_group_, tcp_link_,
+                                              initial_joint_position, initial_joint_velocity, joint_trajectory,
+                                              error_code, options) );
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PREEMPTED, error_code.val);
+  EXPECT_EQ(0u, joint_trajectory.size());
+}
+
 /**
  * @brief Check that function determineAndCheckSamplingTime() returns 'false' if
  * both of the needed vectors have an incorrect vector size.
@@ -841,6 +1155,300 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testDetermineAndCheckSamplingTim
   EXPECT_EQ(expected_sampling_time, sampling_time);
 }
 
+/**
+ * @brief Check that determineSamplingTime() detects the sampling time of a single trajectory.
+ *
+ * Test Sequence:
+ *    1. Call function with a uniformly sampled trajectory whose last duration is shorter.
+ *    2. Change an inner duration and call function again.
+ *    3. Call function with a trajectory of two points.
+ *
+ * Expected Results:
+ *    1. Function returns 'true' and the sampling time.
+ *    2. Function returns 'false'.
+ *    3. Function returns 'false'.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testDetermineSamplingTime)
+{
+  const double epsilon {0.0001};
+  const double expected_sampling_time {0.1};
+  robot_state::RobotState rstate(robot_model_);
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model_, planning_group_);
+  trajectory.addSuffixWayPoint(rstate, 0.0);
+  trajectory.addSuffixWayPoint(rstate, expected_sampling_time);
+  trajectory.addSuffixWayPoint(rstate, expected_sampling_time);
+  trajectory.addSuffixWayPoint(rstate, expected_sampling_time);
+  trajectory.addSuffixWayPoint(rstate, 0.5 * expected_sampling_time);
+
+  double sampling_time {0.0};
+  EXPECT_TRUE(pilz::determineSamplingTime(trajectory, epsilon, sampling_time));
+  EXPECT_EQ(expected_sampling_time, sampling_time);
+
+  trajectory.setWayPointDurationFromPrevious(3, expected_sampling_time + 1.0);
+  EXPECT_FALSE(pilz::determineSamplingTime(trajectory, epsilon, sampling_time));
+
+  robot_trajectory::RobotTrajectory short_trajectory(robot_model_, planning_group_);
+  short_trajectory.addSuffixWayPoint(rstate, 0.0);
+  short_trajectory.addSuffixWayPoint(rstate, expected_sampling_time);
+  EXPECT_FALSE(pilz::determineSamplingTime(short_trajectory, epsilon, sampling_time));
+}
+
+/**
+ * @brief Check that JointTrajectoryColumns converts a joint trajectory message without loss.
+ *
+ * Test Sequence:
+ *    1. Convert a message into columns.
+ *    2. Convert the columns back into a message.
+ *
+ * Expected Results:
+ *    1. The columns hold all points, missing velocities and accelerations are zero.
+ *    2. The message equals the original, except the filled velocities and accelerations.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testJointTrajectoryColumnsMsgConversion)
+{
+  trajectory_msgs::JointTrajectory msg;
+  msg.joint_names = joint_names_;
+  for(std::size_t i = 0; i < 3; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint point;
+    point.time_from_start = ros::Duration(0.1 * i);
+    point.positions.assign(joint_names_.size(), 0.2 * i);
+    if(i > 0)
+    {
+      point.velocities.assign(joint_names_.size(), 0.3 * i);
+      point.accelerations.assign(joint_names_.size(), 0.4 * i);
+    }
+    msg.points.push_back(point);
+  }
+
+  pilz::JointTrajectoryColumns columns;
+  columns.fromMsg(msg);
+  ASSERT_EQ(msg.points.size(), columns.size());
+  ASSERT_EQ(joint_names_, columns.getJointNames());
+  for(std::size_t j = 0; j < columns.getJointCount(); ++j)
+  {
+    EXPECT_EQ(0., columns.getVelocity(j, 0));
+    EXPECT_EQ(0., columns.getAcceleration(j, 0));
+    EXPECT_NEAR(0.4, columns.getPosition(j, 2), EPSILON);
+    EXPECT_NEAR(0.6, columns.getVelocity(j, 2), EPSILON);
+    EXPECT_NEAR(0.8, columns.getAcceleration(j, 2), EPSILON);
+  }
+  EXPECT_GE(columns.getMemoryBytes(), sizeof(double) * msg.points.size() * (1 + 3 * joint_names_.size()));
+
+  trajectory_msgs::JointTrajectory converted;
+  columns.toMsg(converted);
+  ASSERT_EQ(msg.points.size(), converted.points.size());
+  EXPECT_EQ(msg.joint_names, converted.joint_names);
+  for(std::size_t i = 0; i < msg.points.size(); ++i)
+  {
+    EXPECT_EQ(msg.points[i].time_from_start, converted.points[i].time_from_start);
+    EXPECT_EQ(msg.points[i].positions, converted.points[i].positions);
+  }
+  EXPECT_EQ(msg.points[2].velocities, converted.points[2].velocities);
+  EXPECT_EQ(msg.points[2].accelerations, converted.points[2].accelerations);
+
+  columns.setLastPointAtRest();
+  EXPECT_EQ(0., columns.getVelocity(0, 2));
+  columns.clear();
+  EXPECT_TRUE(columns.empty());
+  EXPECT_EQ(joint_names_, columns.getJointNames());
+}
+
+/**
+ * @brief Check that JointTrajectoryColumns::toRobotTrajectory() creates the same robot trajectory as
+ * RobotTrajectory::setRobotTrajectoryMsg().
+ *
+ * Test Sequence:
+ *    1. Generate a joint trajectory as columns and convert it into a message.
+ *    2. Convert both into robot trajectories with the same reference state.
+ *
+ * Expected Results:
+ *    1. The generation succeeds.
+ *    2. All waypoints and durations are equal.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testJointTrajectoryColumnsToRobotTrajectory)
+{
+  // no joint limits, the trajectory is only used for the conversion
+  pilz::JointLimitsContainer joint_limits;
+  robot_state::RobotState reference_state(robot_model_);
+  reference_state.setToDefaultValues();
+  reference_state.setJointGroupPositions(planning_group_, std::vector<double> {0, 0.5, -0.5, 0, 0.5, 0});
+  reference_state.update();
+  std::map<std::string, double> initial_joint_position;
+  for(const auto& joint_name : joint_names_)
+  {
+    initial_joint_position[joint_name] = reference_state.getVariablePosition(joint_name);
+  }
+
+  KDL::Frame start_pose, goal_pose;
+  tf::transformEigenToKDL(reference_state.getFrameTransform(tcp_link_), start_pose);
+  goal_pose = start_pose;
+  goal_pose.p[2] -= 0.05;
+  KDL::RotationalInterpolation_SingleAxis* rot_interpo = new KDL::RotationalInterpolation_SingleAxis();
+  // Note: 'path' and 'vel_prof' are deleted by KDL::Trajectory_Segment
+  KDL::Path_Line* path = new KDL::Path_Line(start_pose, goal_pose, rot_interpo, 0.1, true);
+  KDL::VelocityProfile* vel_prof = new KDL::VelocityProfile_Trap(0.5, 0.1);
+  vel_prof->SetProfile(0, path->PathLength());
+  KDL::Trajectory_Segment kdl_trajectory(path, vel_prof);
+
+  pilz::JointTrajectoryColumns columns;
+  trajectory_msgs::JointTrajectory msg;
+  moveit_msgs::MoveItErrorCodes error_code;
+  ASSERT_TRUE(pilz::generateJointTrajectory(robot_model_, joint_limits, kdl_trajectory, planning_group_, tcp_link_,
+                                            initial_joint_position, 0.01, columns, error_code));
+  ASSERT_GT(columns.size(), 2u);
+  columns.toMsg(msg);
+
+  robot_trajectory::RobotTrajectory expected(robot_model_, planning_group_);
+  expected.setRobotTrajectoryMsg(reference_state, msg);
+  robot_trajectory::RobotTrajectory actual(robot_model_, planning_group_);
+  columns.toRobotTrajectory(reference_state, actual);
+
+  ASSERT_EQ(expected.getWayPointCount(), actual.getWayPointCount());
+  for(std::size_t i = 0; i < expected.getWayPointCount(); ++i)
+  {
+    EXPECT_EQ(expected.getWayPointDurationFromPrevious(i), actual.getWayPointDurationFromPrevious(i));
+    EXPECT_TRUE(pilz::isRobotStateEqual(expected.getWayPoint(i), actual.getWayPoint(i), planning_group_, 0.));
+    for(std::size_t v = 0; v < robot_model_->getVariableCount(); ++v)
+    {
+      EXPECT_EQ(expected.getWayPoint(i).getVariablePosition(v), actual.getWayPoint(i).getVariablePosition(v));
+    }
+  }
+}
+
+/**
+ * @brief Check that the samples of generateJointTrajectory() are checked for collisions in the given start state
+ *
+ * Test Sequence:
+ *    1. Generate a short line with collision check without start state.
+ *    2. Generate the line with collision check, the start state carries a large box attached to the tcp.
+ *
+ * Expected Results:
+ *    1. The generation succeeds.
+ *    2. The generation fails with NO_IK_SOLUTION since the box collides with the robot.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGenerateJointTrajectoryStartStateCollision)
+{
+  pilz::JointLimitsContainer joint_limits;
+  robot_state::RobotState start_state(robot_model_);
+  start_state.setToDefaultValues();
+  start_state.setJointGroupPositions(planning_group_, std::vector<double> {0, 0.5, -0.5, 0, 0.5, 0});
+  start_state.update();
+  std::map<std::string, double> initial_joint_position;
+  for(const auto& joint_name : joint_names_)
+  {
+    initial_joint_position[joint_name] = start_state.getVariablePosition(joint_name);
+  }
+
+  KDL::Frame start_pose, goal_pose;
+  tf::transformEigenToKDL(start_state.getFrameTransform(tcp_link_), start_pose);
+  goal_pose = start_pose;
+  goal_pose.p[2] -= 0.05;
+  KDL::RotationalInterpolation_SingleAxis* rot_interpo = new KDL::RotationalInterpolation_SingleAxis();
+  // Note: 'path' and 'vel_prof' are deleted by KDL::Trajectory_Segment
+  KDL::Path_Line* path = new KDL::Path_Line(start_pose, goal_pose, rot_interpo, 0.1, true);
+  KDL::VelocityProfile* vel_prof = new KDL::VelocityProfile_Trap(0.5, 0.1);
+  vel_prof->SetProfile(0, path->PathLength());
+  KDL::Trajectory_Segment kdl_trajectory(path, vel_prof);
+
+  /**********/
+  /* Step 1 */
+  /**********/
+  pilz::JointTrajectoryColumns columns;
+  moveit_msgs::MoveItErrorCodes error_code;
+  pilz::JointTrajectoryGenerationOptions options;
+  options.check_self_collision = true;
+  EXPECT_TRUE(pilz::generateJointTrajectory(robot_model_, joint_limits, kdl_trajectory, planning_group_, tcp_link_,
+                                            initial_joint_position, 0.01, columns, error_code, options));
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  start_state.attachBody("box", std::vector<shapes::ShapeConstPtr> {std::make_shared<shapes::Box>(1., 1., 1.)},
+                         EigenSTL::vector_Isometry3d {Eigen::Isometry3d::Identity()},
+                         std::set<std::string> {tcp_link_}, tcp_link_);
+  options.start_state = &start_state;
+  EXPECT_FALSE(pilz::generateJointTrajectory(robot_model_, joint_limits, kdl_trajectory, planning_group_, tcp_link_,
+                                             initial_joint_position, 0.01, columns, error_code, options));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION, error_code.val);
+}
+
+/**
+ * @brief Check that both overloads of generateJointTrajectory() report their stages to the stop watch of the options
+ *
+ * Test Sequence:
+ *    1. Generate a joint trajectory from a KDL trajectory with a stop watch.
+ *    2. Generate a joint trajectory from a Cartesian trajectory with a stop watch.
+ *
+ * Expected Results:
+ *    1. The generation succeeds, the sampling and the limit checks are reported.
+ *    2. The generation succeeds, the sampling and the limit checks are reported.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGenerateJointTrajectoryStageTimes)
+{
+  pilz::JointLimitsContainer joint_limits;
+  robot_state::RobotState start_state(robot_model_);
+  start_state.setToDefaultValues();
+  start_state.setJointGroupPositions(planning_group_, std::vector<double> {0, 0.5, -0.5, 0, 0.5, 0});
+  start_state.update();
+  std::map<std::string, double> initial_joint_position, initial_joint_velocity;
+  for(const auto& joint_name : joint_names_)
+  {
+    initial_joint_position[joint_name] = start_state.getVariablePosition(joint_name);
+    initial_joint_velocity[joint_name] = 0.;
+  }
+
+  /**********/
+  /* Step 1 */
+  /**********/
+  KDL::Frame start_pose, goal_pose;
+  tf::transformEigenToKDL(start_state.getFrameTransform(tcp_link_), start_pose);
+  goal_pose = start_pose;
+  goal_pose.p[2] -= 0.05;
+  KDL::RotationalInterpolation_SingleAxis* rot_interpo = new KDL::RotationalInterpolation_SingleAxis();
+  // Note: 'path' and 'vel_prof' are deleted by KDL::Trajectory_Segment
+  KDL::Path_Line* path = new KDL::Path_Line(start_pose, goal_pose, rot_interpo, 0.1, true);
+  KDL::VelocityProfile* vel_prof = new KDL::VelocityProfile_Trap(0.5, 0.1);
+  vel_prof->SetProfile(0, path->PathLength());
+  KDL::Trajectory_Segment kdl_trajectory(path, vel_prof);
+
+  pilz::StageTimes kdl_stage_times;
+  pilz::StageStopWatch kdl_stop_watch(&kdl_stage_times);
+  pilz::JointTrajectoryGenerationOptions options;
+  options.stop_watch = &kdl_stop_watch;
+  pilz::JointTrajectoryColumns columns;
+  moveit_msgs::MoveItErrorCodes error_code;
+  ASSERT_TRUE(pilz::generateJointTrajectory(robot_model_, joint_limits, kdl_trajectory, planning_group_, tcp_link_,
+                                            initial_joint_position, 0.01, columns, error_code, options));
+  EXPECT_GT(kdl_stage_times.get(pilz::STAGE_SAMPLING), 0.);
+  EXPECT_GT(kdl_stage_times.get(pilz::STAGE_LIMIT_CHECKS), 0.);
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  pilz::CartesianTrajectory cart_trajectory;
+  cart_trajectory.group_name = planning_group_;
+  cart_trajectory.link_name = tcp_link_;
+  for(std::size_t i = 1; i <= 3; ++i)
+  {
+    pilz::CartesianTrajectoryPoint point;
+    tf::poseEigenToMsg(start_state.getFrameTransform(tcp_link_), point.pose);
+    point.time_from_start = ros::Duration(0.1 * i);
+    cart_trajectory.points.push_back(point);
+  }
+
+  pilz::StageTimes cartesian_stage_times;
+  pilz::StageStopWatch cartesian_stop_watch(&cartesian_stage_times);
+  options.stop_watch = &cartesian_stop_watch;
+  pilz::JointTrajectoryColumns cartesian_columns;
+  ASSERT_TRUE(pilz::generateJointTrajectory(robot_model_, joint_limits, cart_trajectory, planning_group_, tcp_link_,
+                                            initial_joint_position, initial_joint_velocity, cartesian_columns,
+                                            error_code, options));
+  EXPECT_GT(cartesian_stage_times.get(pilz::STAGE_SAMPLING), 0.);
+  EXPECT_GT(cartesian_stage_times.get(pilz::STAGE_LIMIT_CHECKS), 0.);
+}
+
 /**
  * @brief Check that function isRobotStateEqual() returns 'false' if
  * the positions of the robot states are not equal.
@@ -934,6 +1542,46 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testIsRobotStateEqualAcceleratio
   EXPECT_FALSE( pilz::isRobotStateEqual(rstate_1, rstate_2, planning_group_, epsilon) );
 }
 
+/**
+ * @brief Check that function isRobotStateEqual() only compares the variables of the given group.
+ *
+ * Test Sequence:
+ *    1. Call function with robot states which only differ in a variable outside of the group.
+ *    2. Call function with robot states which differ in a variable of the group by less than epsilon.
+ *
+ * Expected Results:
+ *    1. Function returns 'true'.
+ *    2. Function returns 'true'.
+ */
+TEST_P(TrajectoryFunctionsTestOnlyGripper, testIsRobotStateEqualIgnoresOtherGroups)
+{
+  robot_state::RobotState rstate_1(robot_model_);
+  rstate_1.setToDefaultValues();
+  std::vector<double> zeros(robot_model_->getVariableCount(), 0.0);
+  rstate_1.setVariableVelocities(zeros);
+  rstate_1.setVariableAccelerations(zeros);
+  robot_state::RobotState rstate_2(rstate_1);
+
+  const std::vector<std::string>& group_variables {
+    robot_model_->getJointModelGroup(planning_group_)->getVariableNames()};
+  const auto other_variable = std::find_if(robot_model_->getVariableNames().begin(),
+                                           robot_model_->getVariableNames().end(),
+                                           [&group_variables](const std::string& name)
+  {
+    return std::find(group_variables.begin(), group_variables.end(), name) == group_variables.end();
+  });
+  ASSERT_NE(robot_model_->getVariableNames().end(), other_variable);
+
+  double epsilon {0.0001};
+  rstate_2.setVariablePosition(*other_variable, rstate_1.getVariablePosition(*other_variable) + 1.0);
+  rstate_2.setVariableVelocity(*other_variable, 1.0);
+  EXPECT_TRUE( pilz::isRobotStateEqual(rstate_1, rstate_2, planning_group_, epsilon) );
+
+  rstate_2.setVariablePosition(group_variables.front(),
+                               rstate_1.getVariablePosition(group_variables.front()) + epsilon / 2.);
+  EXPECT_TRUE( pilz::isRobotStateEqual(rstate_1, rstate_2, planning_group_, epsilon) );
+}
+
 /**
  * @brief Check that function isRobotStateStationary() returns 'false' if
  * the joint velocities are not equal to zero.
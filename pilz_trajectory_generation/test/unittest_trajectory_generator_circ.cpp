@@ -234,6 +234,46 @@ TEST_P(TrajectoryGeneratorCIRCTest, ValidCommand)
   EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
 }
 
+/**
+ * @brief Checks that the spline output reduces the samples to the knots needed to reproduce every sample within the
+ * tolerance.
+ *
+ * Test Sequence:
+ *    1. Generate a sampled trajectory.
+ *    2. Enable the spline output and generate the trajectory again.
+ *    3. Interpolate the spline at the times of the samples.
+ *
+ * Expected Results:
+ *    1. Generation succeeds.
+ *    2. Generation succeeds, the spline has less waypoints than the samples with the same duration and the same last
+ *       waypoint.
+ *    3. The quintic interpolation of the knots is within the tolerance of the samples in every joint.
+ */
+TEST_P(TrajectoryGeneratorCIRCTest, testSplineOutput)
+{
+  const double tolerance {1e-4};
+  const planning_interface::MotionPlanRequest req {tdp_->getCircCartCenterCart("circ1_center_2").toRequest()};
+
+  planning_interface::MotionPlanResponse res_samples;
+  ASSERT_TRUE(circ_->generate(req, res_samples));
+  const robot_trajectory::RobotTrajectory& samples {*res_samples.trajectory_};
+
+  circ_->setSplineTolerance(tolerance);
+  planning_interface::MotionPlanResponse res_spline;
+  const bool generated {circ_->generate(req, res_spline)};
+  circ_->setSplineTolerance(0.);
+  ASSERT_TRUE(generated);
+  const robot_trajectory::RobotTrajectory& spline {*res_spline.trajectory_};
+
+  ASSERT_LT(spline.getWayPointCount(), samples.getWayPointCount());
+  EXPECT_NEAR(samples.getWayPointDurationFromStart(samples.getWayPointCount() - 1),
+              spline.getWayPointDurationFromStart(spline.getWayPointCount() - 1), 1e-9);
+  EXPECT_TRUE(pilz::isRobotStateEqual(samples.getLastWayPoint(), spline.getLastWayPoint(), planning_group_, 1e-9));
+
+  // the durations of the waypoints are rounded to nanoseconds
+  EXPECT_TRUE(testutils::isSplineThroughSamples(samples, spline, planning_group_, tolerance + 1e-9));
+}
+
 /**
  * @brief Generate invalid circ with to high vel scaling
  */
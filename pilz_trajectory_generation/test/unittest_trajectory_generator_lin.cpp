@@ -200,6 +200,64 @@ TEST_P(TrajectoryGeneratorLINTest, jointSpaceGoal)
   EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
 }
 
+/**
+ * @brief Checks that the spline output reduces the samples to the knots needed to reproduce every sample within the
+ * tolerance.
+ *
+ * Test Sequence:
+ *    1. Generate a sampled trajectory.
+ *    2. Enable the spline output and generate the trajectory again.
+ *    3. Interpolate the spline at the times of the samples.
+ *
+ * Expected Results:
+ *    1. Generation succeeds.
+ *    2. Generation succeeds, the spline has less waypoints than the samples with the same duration and the same last
+ *       waypoint.
+ *    3. The quintic interpolation of the knots is within the tolerance of the samples in every joint.
+ */
+TEST_P(TrajectoryGeneratorLINTest, testSplineOutput)
+{
+  const double tolerance {1e-4};
+  const planning_interface::MotionPlanRequest req {tdp_->getLinJoint("lin2").toRequest()};
+
+  planning_interface::MotionPlanResponse res_samples;
+  ASSERT_TRUE(lin_->generate(req, res_samples));
+  const robot_trajectory::RobotTrajectory& samples {*res_samples.trajectory_};
+
+  lin_->setSplineTolerance(tolerance);
+  planning_interface::MotionPlanResponse res_spline;
+  const bool generated {lin_->generate(req, res_spline)};
+  lin_->setSplineTolerance(0.);
+  ASSERT_TRUE(generated);
+  const robot_trajectory::RobotTrajectory& spline {*res_spline.trajectory_};
+
+  ASSERT_LT(spline.getWayPointCount(), samples.getWayPointCount());
+  EXPECT_NEAR(samples.getWayPointDurationFromStart(samples.getWayPointCount() - 1),
+              spline.getWayPointDurationFromStart(spline.getWayPointCount() - 1), 1e-9);
+  EXPECT_TRUE(pilz::isRobotStateEqual(samples.getLastWayPoint(), spline.getLastWayPoint(), planning_group_, 1e-9));
+
+  // the durations of the waypoints are rounded to nanoseconds
+  EXPECT_TRUE(testutils::isSplineThroughSamples(samples, spline, planning_group_, tolerance + 1e-9));
+}
+
+/**
+ * @brief test that the cost of the inverse kinematics of the goal and of all samples is reported
+ */
+TEST_P(TrajectoryGeneratorLINTest, ikStatistics)
+{
+  planning_interface::MotionPlanRequest lin_joint_req {tdp_->getLinJoint("lin2").toRequest()};
+
+  planning_interface::MotionPlanResponse res;
+  pilz::IKStatistics ik_statistics;
+  ASSERT_TRUE(lin_->generate(lin_joint_req, res, 0.01, nullptr, &ik_statistics));
+
+  // one call for the goal, one per sample
+  EXPECT_EQ(res.trajectory_->getWayPointCount() + 1, ik_statistics.calls);
+  EXPECT_EQ(ik_statistics.calls, ik_statistics.solver_calls);
+  EXPECT_EQ(0u, ik_statistics.getFailureCount());
+  EXPECT_GT(ik_statistics.ik_seconds, 0.);
+}
+
 /**
  * @brief test the lin planner with joint space goal with start velocity almost zero
  */
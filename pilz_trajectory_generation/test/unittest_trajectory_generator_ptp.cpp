@@ -19,6 +19,8 @@
 
 #include "pilz_trajectory_generation/trajectory_generator_ptp.h"
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/payload_joint_limits_provider.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
 #include "test_utils.h"
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
@@ -61,6 +63,12 @@ protected:
                        const planning_interface::MotionPlanRequest& req,
                        const pilz::JointLimitsContainer& joint_limits);
 
+  /**
+   * @brief create a valid request with a joint goal which differs from the start state
+   * @param req
+   */
+  void createJointGoalRequest(planning_interface::MotionPlanRequest& req);
+
 protected:
   // ros stuff
   ros::NodeHandle ph_ {"~"};
@@ -129,6 +137,18 @@ bool TrajectoryGeneratorPTPTest::checkTrajectory(const trajectory_msgs::JointTra
           testutils::isAccelerationBounded(trajectory,joint_limits));
 }
 
+void TrajectoryGeneratorPTPTest::createJointGoalRequest(planning_interface::MotionPlanRequest& req)
+{
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = robot_model_->getJointModelGroup(planning_group_)->getActiveJointModelNames().front();
+  jc.position = 0.5;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+}
+
 // Instantiate the test cases for robot model with and without gripper
 INSTANTIATE_TEST_CASE_P(InstantiationName, TrajectoryGeneratorPTPTest, ::testing::Values(
                         PARAM_MODEL_NO_GRIPPER_NAME,
@@ -174,7 +194,15 @@ TEST_P(TrajectoryGeneratorPTPTest, emptyRequest)
 
 
 /**
- * @brief Construct a TrajectoryGeneratorPTP with missing velocity limits
+ * @brief Plan with a TrajectoryGeneratorPTP with missing velocity limits
+ *
+ *  - Test Sequence:
+ *    1. Construct the generator with joint limits lacking velocity limits
+ *    2. Plan a joint goal for the planning group
+ *
+ *  - Expected Results:
+ *    1. the constructor throws no exception, limits are checked per group on first use
+ *    2. planning fails with PLANNING_FAILED
  */
 TEST_P(TrajectoryGeneratorPTPTest, missingVelocityLimits)
 {
@@ -194,12 +222,27 @@ TEST_P(TrajectoryGeneratorPTPTest, missingVelocityLimits)
   }
 
   planner_limits.setJointLimits(joint_limits);
-  EXPECT_THROW(TrajectoryGeneratorPTP(this->robot_model_, planner_limits), TrajectoryGeneratorInvalidLimitsException);
+  std::unique_ptr<TrajectoryGeneratorPTP> ptp;
+  ASSERT_NO_THROW(ptp.reset(new TrajectoryGeneratorPTP(this->robot_model_, planner_limits)));
+
+  planning_interface::MotionPlanResponse res;
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+  EXPECT_FALSE(ptp->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, res.error_code_.val);
 }
 
 
 /**
- * @brief Construct a TrajectoryGeneratorPTP missing deceleration limits
+ * @brief Plan with a TrajectoryGeneratorPTP missing deceleration limits
+ *
+ *  - Test Sequence:
+ *    1. Construct the generator with joint limits lacking deceleration limits
+ *    2. Plan a joint goal for the planning group
+ *
+ *  - Expected Results:
+ *    1. the constructor throws no exception, limits are checked per group on first use
+ *    2. planning fails with PLANNING_FAILED
  */
 TEST_P(TrajectoryGeneratorPTPTest, missingDecelerationimits)
 {
@@ -218,18 +261,25 @@ TEST_P(TrajectoryGeneratorPTPTest, missingDecelerationimits)
   }
 
   planner_limits.setJointLimits(joint_limits);
-  EXPECT_THROW(TrajectoryGeneratorPTP(this->robot_model_, planner_limits), TrajectoryGeneratorInvalidLimitsException);
+  std::unique_ptr<TrajectoryGeneratorPTP> ptp;
+  ASSERT_NO_THROW(ptp.reset(new TrajectoryGeneratorPTP(this->robot_model_, planner_limits)));
+
+  planning_interface::MotionPlanResponse res;
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+  EXPECT_FALSE(ptp->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, res.error_code_.val);
 }
 
 /**
- * @brief test the constructor when insufficient limits are given
+ * @brief test planning when insufficient limits are given
  *  - Test Sequence:
  *    1. assign joint limits without acc and dec
  *    2. assign at least one joint limit per group with all required limits
  *
  *  - Expected Results:
- *    1. the constructor throws an exception of type TrajectoryGeneratorInvalidLimitsException
- *    2. the constructor throws no exception
+ *    1. the constructor throws no exception, planning for the group fails
+ *    2. the constructor throws no exception, planning for the group succeeds
  */
 TEST_P(TrajectoryGeneratorPTPTest, testInsufficientLimit)
 {
@@ -257,11 +307,14 @@ TEST_P(TrajectoryGeneratorPTPTest, testInsufficientLimit)
   LimitsContainer insufficient_planner_limits;
   insufficient_planner_limits.setJointLimits(insufficient_joint_limits);
 
-  EXPECT_THROW({
-                 std::unique_ptr<TrajectoryGeneratorPTP> ptp_error(
-                 new TrajectoryGeneratorPTP(robot_model_, insufficient_planner_limits));
-               },
-               TrajectoryGeneratorInvalidLimitsException);
+  std::unique_ptr<TrajectoryGeneratorPTP> ptp_error;
+  ASSERT_NO_THROW(ptp_error.reset(new TrajectoryGeneratorPTP(robot_model_, insufficient_planner_limits)));
+
+  planning_interface::MotionPlanResponse res;
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+  EXPECT_FALSE(ptp_error->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, res.error_code_.val);
 
   /**********/
   /* Step 2 */
@@ -295,10 +348,143 @@ TEST_P(TrajectoryGeneratorPTPTest, testInsufficientLimit)
   LimitsContainer sufficient_planner_limits;
   sufficient_planner_limits.setJointLimits(sufficient_joint_limits);
 
-  EXPECT_NO_THROW({
-                    std::unique_ptr<TrajectoryGeneratorPTP> ptp_no_error(
-                    new TrajectoryGeneratorPTP(robot_model_, sufficient_planner_limits));
-                  });
+  std::unique_ptr<TrajectoryGeneratorPTP> ptp_no_error;
+  ASSERT_NO_THROW(ptp_no_error.reset(new TrajectoryGeneratorPTP(robot_model_, sufficient_planner_limits)));
+
+  EXPECT_TRUE(ptp_no_error->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val);
+}
+
+/**
+ * @brief test the most strict limits shared between generators
+ *  - Test Sequence:
+ *    1. compute the most strict limits of the model with the limits of the fixture
+ *    2. compute the most strict limits with the planning group lacking acceleration limits
+ *    3. plan with generators sharing the limits of step 1 and step 2
+ *
+ *  - Expected Results:
+ *    1. every group has a most strict limit equal to the common limit of the fixture
+ *    2. no exception is thrown, the planning group is left out
+ *    3. planning succeeds with the limits of step 1 and fails with PLANNING_FAILED with the limits of step 2
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testSharedMostStrictLimits)
+{
+  /**********/
+  /* Step 1 */
+  /**********/
+  const MostStrictLimitsConstPtr limits {
+    TrajectoryGeneratorPTP::computeMostStrictLimits(robot_model_, planner_limits_.getJointLimitContainer())};
+  ASSERT_NE(nullptr, limits);
+  EXPECT_EQ(robot_model_->getJointModelGroups().size(), limits->size());
+  ASSERT_EQ(1u, limits->count(planning_group_));
+  EXPECT_DOUBLE_EQ(1., limits->at(planning_group_).max_velocity);
+  EXPECT_DOUBLE_EQ(0.5, limits->at(planning_group_).max_acceleration);
+  EXPECT_DOUBLE_EQ(-1., limits->at(planning_group_).max_deceleration);
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  JointLimitsContainer insufficient_joint_limits;
+  for(const auto& limit : planner_limits_.getJointLimitContainer())
+  {
+    pilz_extensions::JointLimit joint_limit {limit.second};
+    joint_limit.has_acceleration_limits = false;
+    insufficient_joint_limits.addLimit(limit.first, joint_limit);
+  }
+  MostStrictLimitsConstPtr insufficient_limits;
+  ASSERT_NO_THROW(insufficient_limits = TrajectoryGeneratorPTP::computeMostStrictLimits(robot_model_,
+                                                                                        insufficient_joint_limits));
+  ASSERT_NE(nullptr, insufficient_limits);
+  EXPECT_EQ(0u, insufficient_limits->count(planning_group_));
+
+  /**********/
+  /* Step 3 */
+  /**********/
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+
+  TrajectoryGeneratorPTP first_ptp(robot_model_, planner_limits_, limits);
+  TrajectoryGeneratorPTP second_ptp(robot_model_, planner_limits_, limits);
+  planning_interface::MotionPlanResponse first_res, second_res;
+  EXPECT_TRUE(first_ptp.generate(req, first_res));
+  EXPECT_TRUE(second_ptp.generate(req, second_res));
+
+  LimitsContainer insufficient_planner_limits;
+  insufficient_planner_limits.setJointLimits(insufficient_joint_limits);
+  TrajectoryGeneratorPTP insufficient_ptp(robot_model_, insufficient_planner_limits, insufficient_limits);
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(insufficient_ptp.generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, res.error_code_.val);
+}
+
+/**
+ * @brief test that the payload of the start state of the request determines the limits of a reused generator
+ *  - Test Sequence:
+ *    1. plan with a generator with a payload provider whose unloaded limits double the acceleration limits
+ *    2. plan the same request with the box of maximal payload attached to the start state, using the same generator
+ *    3. plan the request of step 2 with a generator without provider
+ *
+ *  - Expected Results:
+ *    1. planning succeeds
+ *    2. planning succeeds, the trajectory takes longer than the one of step 1
+ *    3. the trajectory takes as long as the one of step 2
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testPayloadOfRequestStartState)
+{
+  /**********/
+  /* Step 1 */
+  /**********/
+  std::map<std::string, UnloadedJointLimit> unloaded_limits;
+  for(const auto& limit : planner_limits_.getJointLimitContainer())
+  {
+    UnloadedJointLimit unloaded_limit;
+    unloaded_limit.has_acceleration_limits = true;
+    unloaded_limit.max_acceleration = 2. * limit.second.max_acceleration;
+    unloaded_limit.has_deceleration_limits = true;
+    unloaded_limit.max_deceleration = 2. * limit.second.max_deceleration;
+    unloaded_limits[limit.first] = unloaded_limit;
+  }
+  LimitsContainer payload_limits {planner_limits_};
+  payload_limits.setJointLimitsProvider(std::make_shared<PayloadJointLimitsProvider>(
+                                          6., std::map<std::string, double> {{"box", 6.}}, unloaded_limits));
+  TrajectoryGeneratorPTP payload_ptp(robot_model_, payload_limits);
+
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+  planning_interface::MotionPlanResponse unloaded_res;
+  ASSERT_TRUE(payload_ptp.generate(req, unloaded_res));
+
+  /**********/
+  /* Step 2 */
+  /**********/
+  moveit_msgs::AttachedCollisionObject box;
+  box.link_name = target_link_;
+  box.object.id = "box";
+  box.object.header.frame_id = target_link_;
+  box.object.operation = moveit_msgs::CollisionObject::ADD;
+  shape_msgs::SolidPrimitive primitive;
+  primitive.type = shape_msgs::SolidPrimitive::BOX;
+  primitive.dimensions = {0.1, 0.1, 0.1};
+  box.object.primitives.push_back(primitive);
+  geometry_msgs::Pose pose;
+  pose.orientation.w = 1.;
+  box.object.primitive_poses.push_back(pose);
+  req.start_state.attached_collision_objects.push_back(box);
+
+  planning_interface::MotionPlanResponse loaded_res;
+  ASSERT_TRUE(payload_ptp.generate(req, loaded_res));
+  const double loaded_duration {
+    loaded_res.trajectory_->getWayPointDurationFromStart(loaded_res.trajectory_->getWayPointCount() - 1)};
+  EXPECT_GT(loaded_duration,
+            unloaded_res.trajectory_->getWayPointDurationFromStart(unloaded_res.trajectory_->getWayPointCount() - 1));
+
+  /**********/
+  /* Step 3 */
+  /**********/
+  planning_interface::MotionPlanResponse static_res;
+  ASSERT_TRUE(ptp_->generate(req, static_res));
+  EXPECT_NEAR(static_res.trajectory_->getWayPointDurationFromStart(static_res.trajectory_->getWayPointCount() - 1),
+              loaded_duration, 1e-9);
 }
 
 /**
@@ -458,6 +644,89 @@ TEST_P(TrajectoryGeneratorPTPTest, testJointGoalAlreadyReached)
   EXPECT_EQ(1u,res_msg.trajectory.joint_trajectory.points.size());
 }
 
+/**
+ * @brief Check that a set termination flag stops the generation.
+ *
+ * Test Sequence:
+ *    1. Generate a valid joint goal request.
+ *    2. Set the termination flag and generate the same request again.
+ *    3. Reset the termination flag and generate the same request again.
+ *
+ * Expected Results:
+ *    1. Generation succeeds.
+ *    2. Generation fails with PREEMPTED and returns no trajectory.
+ *    3. Generation succeeds.
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testTerminated)
+{
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+
+  std::atomic_bool terminated {false};
+  ptp_->setTerminationFlag(&terminated);
+
+  planning_interface::MotionPlanResponse res;
+  EXPECT_TRUE(ptp_->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val);
+
+  terminated = true;
+  planning_interface::MotionPlanResponse res_terminated;
+  EXPECT_FALSE(ptp_->generate(req, res_terminated));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PREEMPTED, res_terminated.error_code_.val);
+  EXPECT_EQ(nullptr, res_terminated.trajectory_);
+
+  terminated = false;
+  planning_interface::MotionPlanResponse res_reset;
+  EXPECT_TRUE(ptp_->generate(req, res_reset));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res_reset.error_code_.val);
+
+  ptp_->setTerminationFlag(nullptr);
+}
+
+/**
+ * @brief Checks that the spline output contains only the knots of the phases and reproduces the samples.
+ *
+ * Test Sequence:
+ *    1. Generate a sampled trajectory.
+ *    2. Enable the spline output and generate the trajectory again.
+ *    3. Interpolate the spline at the times of the samples.
+ *
+ * Expected Results:
+ *    1. Generation succeeds, the trajectory is uniformly sampled.
+ *    2. Generation succeeds, the spline is not uniformly sampled and has at most 7 knots with the same
+ *       duration and goal as the samples.
+ *    3. The quintic interpolation of the knots matches the samples in every joint.
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testSplineOutput)
+{
+  planning_interface::MotionPlanRequest req;
+  createJointGoalRequest(req);
+
+  planning_interface::MotionPlanResponse res_samples;
+  ASSERT_TRUE(ptp_->generate(req, res_samples));
+  const robot_trajectory::RobotTrajectory& samples {*res_samples.trajectory_};
+
+  ptp_->setSplineTolerance(1e-6);
+  planning_interface::MotionPlanResponse res_spline;
+  ASSERT_TRUE(ptp_->generate(req, res_spline));
+  ptp_->setSplineTolerance(0.);
+  const robot_trajectory::RobotTrajectory& spline {*res_spline.trajectory_};
+
+  double sampling_time {0.};
+  EXPECT_TRUE(pilz::determineSamplingTime(samples, 1e-9, sampling_time));
+  EXPECT_FALSE(pilz::determineSamplingTime(spline, 1e-9, sampling_time));
+  ASSERT_LE(spline.getWayPointCount(), 7u);
+  ASSERT_LT(spline.getWayPointCount(), samples.getWayPointCount());
+  EXPECT_NEAR(samples.getWayPointDurationFromStart(samples.getWayPointCount() - 1),
+              spline.getWayPointDurationFromStart(spline.getWayPointCount() - 1), 1e-9);
+  moveit_msgs::MotionPlanResponse res_msg;
+  res_spline.getMessage(res_msg);
+  EXPECT_TRUE(testutils::isGoalReached(res_msg.trajectory.joint_trajectory, req.goal_constraints.front().joint_constraints,
+                                       joint_position_tolerance_, joint_velocity_tolerance_));
+
+  EXPECT_TRUE(testutils::isSplineThroughSamples(samples, spline, planning_group_, 1e-6));
+}
+
 /**
  * @brief test scaling factor
  * with zero start velocity